@@ -0,0 +1,325 @@
+/*
+  ==============================================================================
+	Main.cpp
+	Headless benchmark for Audio::audioDeviceIOCallback. Loads every slot with
+	generated samples, plays generated songs and drives the callback by hand
+	at several sample rates and buffer sizes, timing every block. Any MOD or
+	XM modules named on the command line are imported and played after them,
+	with their own samples and tempo. With --parallel, the voices are rendered
+	on a RenderWorkerPool.
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include "../../Source/audio/Audio.h"
+#include "../../Source/project/ModuleImporter.h"
+
+/** Stands in for an audio device, so Audio can be prepared for any sample rate and buffer size without one. */
+
+class BenchmarkDevice		:	public AudioIODevice
+{
+public:
+	/** Constructor.
+		@param	double sample rate to report
+		@param	int buffer size to report */
+	BenchmarkDevice(double rate, int size)		:	AudioIODevice("Benchmark", "Benchmark"),
+													sampleRate(rate),
+													bufferSize(size)
+	{
+
+	}
+
+	StringArray getOutputChannelNames() override					{ return { "Left", "Right" }; }
+	StringArray getInputChannelNames() override						{ return {}; }
+	Array<double> getAvailableSampleRates() override				{ return { sampleRate }; }
+	Array<int> getAvailableBufferSizes() override					{ return { bufferSize }; }
+	int getDefaultBufferSize() override								{ return bufferSize; }
+	String open(const BigInteger&, const BigInteger&, double, int) override	{ return {}; }
+	void close() override											{}
+	bool isOpen() override											{ return true; }
+	void start(AudioIODeviceCallback*) override						{}
+	void stop() override											{}
+	bool isPlaying() override										{ return true; }
+	String getLastError() override									{ return {}; }
+	int getCurrentBufferSizeSamples() override						{ return bufferSize; }
+	double getCurrentSampleRate() override							{ return sampleRate; }
+	int getCurrentBitDepth() override								{ return 32; }
+	BigInteger getActiveOutputChannels() const override				{ return 3; }
+	BigInteger getActiveInputChannels() const override				{ return 0; }
+	int getOutputLatencyInSamples() override						{ return 0; }
+	int getInputLatencyInSamples() override							{ return 0; }
+
+private:
+	double sampleRate;
+	int bufferSize;
+};
+
+/** Holds the sizes of the benchmark. */
+enum
+{
+	NumberOfStreamedSlots = 2,
+	NumberOfPatterns = 16,
+	WarmUpSeconds = 1,
+	MeasuredSeconds = 20,
+	BenchmarkBpm = 240
+};
+
+/** Writes a decaying sine to a WAV file in the given directory.
+	@param	File directory to write to
+	@param	int index of the sample, used for its name and pitch
+	@param	double length of the sample in seconds
+	@return	File written */
+static File writeTestSample(const File& directory, int index, double lengthInSeconds)
+{
+	const double sampleRate = 44100.0;
+	const int length = (int) (sampleRate * lengthInSeconds);
+	const double frequency = 110.0 * std::pow(2.0, index / 12.0);
+
+	AudioBuffer<float> buffer(2, length);
+	for (int i = 0; i < length; i++)
+	{
+		const float envelope = (float) std::exp(-3.0 * i / length);
+		const float value = envelope * (float) std::sin(MathConstants<double>::twoPi * frequency * i / sampleRate);
+		buffer.setSample(0, i, value);
+		buffer.setSample(1, i, value);
+	}
+
+	File file = directory.getChildFile("Sample" + String(index) + ".wav");
+	file.deleteFile();
+
+	WavAudioFormat wavFormat;
+	std::unique_ptr<AudioFormatWriter> writer(wavFormat.createWriterFor(new FileOutputStream(file), sampleRate, 2, 16, {}, 0));
+	if (writer != nullptr)
+	{
+		writer->writeFromAudioSampleBuffer(buffer, 0, length);
+	}
+	return file;
+}
+
+/** Creates a song of generated patterns, in which each cell holds a random event with the given probability,
+	played through an order list twice as long as the number of patterns.
+	@param	Random to draw from - seeded, so every run plays the same songs
+	@param	int number of channels in the song
+	@param	float probability of a cell holding an event, in the range 0 to 1
+	@return	Song::Ptr to the new song */
+static Song::Ptr createSong(Random& random, int numChannels, float density)
+{
+	Song::Ptr song = new Song();
+	song->setNumChannels(numChannels);
+	while (song->getNumPatterns() < NumberOfPatterns)
+	{
+		song->addPattern();
+	}
+
+	for (int pattern = 0; pattern < song->getNumPatterns(); pattern++)
+	{
+		for (int row = 0; row < song->getNumRows(); row++)
+		{
+			for (int channel = 0; channel < song->getNumChannels(); channel++)
+			{
+				if (random.nextFloat() >= density)
+				{
+					continue;
+				}
+
+				TrackerEvent event;
+				event.note = 48 + random.nextInt(25);
+				event.sample = random.nextInt(Audio::NumberOfFilePlayers);
+				event.gain = 0.5f + 0.5f * random.nextFloat();
+				event.pitchRatio = std::pow(2.0, (event.note - 60) / 12.0);
+				song->setEvent(pattern, row, channel, event);
+			}
+		}
+	}
+
+	Array<int> order;
+	for (int position = 0; position < NumberOfPatterns * 2; position++)
+	{
+		order.add(random.nextInt(NumberOfPatterns));
+	}
+	song->setOrderList(order);
+	return song;
+}
+
+/** Returns the value at the given percentile of a sorted list of timings.
+	@param	reference to the sorted timings
+	@param	double percentile in the range 0 to 100 */
+static double getPercentile(const std::vector<double>& sortedTimings, double percentile)
+{
+	const size_t index = (size_t) std::round((percentile / 100.0) * (double) (sortedTimings.size() - 1));
+	return sortedTimings[index];
+}
+
+/** Runs the callback for the given sample rate and buffer size and prints the timings of every block.
+	@param	reference to the Audio object to run
+	@param	String name of the song being played
+	@param	double sample rate to run at
+	@param	int buffer size to run at */
+static void runBenchmark(Audio& audio, const String& songName, double sampleRate, int bufferSize)
+{
+	BenchmarkDevice device(sampleRate, bufferSize);
+	AudioBuffer<float> outputBuffer(2, bufferSize);
+
+	audio.audioDeviceAboutToStart(&device);
+	audio.setRunState(true);
+
+	const int warmUpBlocks = (int) (sampleRate * WarmUpSeconds) / bufferSize;
+	const int measuredBlocks = (int) (sampleRate * MeasuredSeconds) / bufferSize;
+	std::vector<double> timings;
+	timings.reserve((size_t) measuredBlocks);
+
+	for (int block = 0; block < warmUpBlocks + measuredBlocks; block++)
+	{
+		const int64 start = Time::getHighResolutionTicks();
+		audio.audioDeviceIOCallback(nullptr, 0, outputBuffer.getArrayOfWritePointers(), 2, bufferSize);
+		const int64 end = Time::getHighResolutionTicks();
+
+		if (block >= warmUpBlocks)
+		{
+			timings.push_back(Time::highResolutionTicksToSeconds(end - start) * 1.0e6);
+		}
+	}
+
+	//stops playback and every voice, so the next run starts from silence
+	audio.setRunState(false);
+	audio.audioDeviceIOCallback(nullptr, 0, outputBuffer.getArrayOfWritePointers(), 2, bufferSize);
+	audio.audioDeviceStopped();
+
+	double totalMicroseconds = 0.0;
+	for (double timing : timings)
+	{
+		totalMicroseconds += timing;
+	}
+	std::sort(timings.begin(), timings.end());
+
+	//the realtime factor is how many times faster than realtime the callback ran
+	const double blockMicroseconds = 1.0e6 * bufferSize / sampleRate;
+	const double realtimeFactor = (blockMicroseconds * (double) timings.size()) / jmax(1.0, totalMicroseconds);
+
+	std::cout << songName.paddedRight(' ', 8)
+			<< String(sampleRate, 0).paddedLeft(' ', 8)
+			<< String(bufferSize).paddedLeft(' ', 8)
+			<< String(getPercentile(timings, 50.0), 2).paddedLeft(' ', 12)
+			<< String(getPercentile(timings, 99.0), 2).paddedLeft(' ', 12)
+			<< String(timings.back(), 2).paddedLeft(' ', 12)
+			<< String(100.0 * timings.back() / blockMicroseconds, 1).paddedLeft(' ', 10)
+			<< String(realtimeFactor, 1).paddedLeft(' ', 10)
+			<< std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	//Audio uses a Timer, which needs a MessageManager
+	ScopedJuceInitialiser_GUI juceInitialiser;
+
+	File directory = File::getSpecialLocation(File::tempDirectory).getChildFile("JuceTrackerBenchmark");
+	directory.createDirectory();
+
+	//Audio is destroyed before the samples are deleted, so no file is still open for streaming
+	{
+		Audio audio(false);
+
+		//every slot is loaded - short samples are preloaded, and the last slots are long enough to be streamed
+		for (int slot = 0; slot < Audio::NumberOfFilePlayers; slot++)
+		{
+			const bool streamed = slot >= Audio::NumberOfFilePlayers - NumberOfStreamedSlots;
+			const double lengthInSeconds = streamed ? SamplePool::MaximumPreloadLengthInSeconds + 5.0 : 0.25 + 0.05 * slot;
+			audio.getFilePlayer(slot)->loadFile(writeTestSample(directory, slot, lengthInSeconds));
+		}
+		audio.setBpm(BenchmarkBpm);
+
+		//options are read before any module is played
+		StringArray moduleNames;
+		for (int arg = 1; arg < argc; arg++)
+		{
+			if (String(argv[arg]) == "--parallel")
+			{
+				audio.setParallelRendering(true);
+			}
+			else
+			{
+				moduleNames.add(String(argv[arg]));
+			}
+		}
+
+		Random random(0x7ac4e2);
+		//the wide song holds as many events per row as the dense one on average, spread over every channel a song can have
+		const std::vector<std::pair<String, Song::Ptr>> songs = { { "sparse", createSong(random, 4, 0.25f) },
+																{ "dense", createSong(random, 4, 1.f) },
+																{ "wide", createSong(random, Pattern::MaximumNumberOfChannels, 4.f / Pattern::MaximumNumberOfChannels) } };
+		const std::vector<double> sampleRates = { 44100.0, 48000.0, 96000.0 };
+		const std::vector<int> bufferSizes = { 32, 64, 128, 256, 512, 1024 };
+
+		std::cout << "Timings are per block in microseconds. Streamed slots are read by the DiskStreamer as usual, "
+				<< "so at faster than realtime they may play silence." << std::endl;
+		if (audio.isParallelRendering())
+		{
+			std::cout << "Voices are rendered on " << RenderWorkerPool::getDefaultNumberOfWorkers() << " workers and the audio thread." << std::endl;
+		}
+		std::cout << std::endl;
+		std::cout << String("song").paddedRight(' ', 8)
+				<< String("rate").paddedLeft(' ', 8)
+				<< String("block").paddedLeft(' ', 8)
+				<< String("p50").paddedLeft(' ', 12)
+				<< String("p99").paddedLeft(' ', 12)
+				<< String("max").paddedLeft(' ', 12)
+				<< String("max %").paddedLeft(' ', 10)
+				<< String("realtime").paddedLeft(' ', 10)
+				<< std::endl;
+
+		auto runSong = [&] (const String& songName, Song::Ptr song)
+		{
+			//the audio thread picks the new song up on its next callback
+			audio.setSong(song);
+			for (double sampleRate : sampleRates)
+			{
+				for (int bufferSize : bufferSizes)
+				{
+					runBenchmark(audio, songName, sampleRate, bufferSize);
+				}
+			}
+		};
+
+		for (const auto& song : songs)
+		{
+			runSong(song.first, song.second);
+		}
+
+		//each module replaces every slot with its own samples, and plays at its own tempo
+		for (auto& moduleName : moduleNames)
+		{
+			const File moduleFile = File::getCurrentWorkingDirectory().getChildFile(moduleName);
+			ProjectFile::Contents contents;
+			auto result = ModuleImporter::importFile(moduleFile, contents);
+			if (result.failed())
+			{
+				std::cout << result.getErrorMessage() << std::endl;
+				continue;
+			}
+
+			for (int slot = 0; slot < Audio::NumberOfFilePlayers; slot++)
+			{
+				const auto& moduleSlot = contents.slots[(size_t) slot];
+				FilePlayer* filePlayer = audio.getFilePlayer(slot);
+				filePlayer->setLooping(moduleSlot.looping);
+				if (moduleSlot.sample != nullptr)
+				{
+					filePlayer->loadSample(moduleSlot.sample, File());
+				}
+				else
+				{
+					filePlayer->loadFile(File());
+				}
+			}
+			audio.setBpm(contents.bpm);
+			audio.setTicksPerRow(contents.ticksPerRow);
+			runSong(moduleFile.getFileNameWithoutExtension().substring(0, 7), contents.song);
+		}
+	}
+
+	directory.deleteRecursively();
+	return 0;
+}
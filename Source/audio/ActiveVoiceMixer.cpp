@@ -0,0 +1,178 @@
+/*
+  ==============================================================================
+	ActiveVoiceMixer.cpp
+  ==============================================================================
+*/
+
+#include "ActiveVoiceMixer.h"
+
+ActiveVoiceMixer::ActiveVoiceMixer()		:	numFilePlayers(0),
+												numGroupVoices(0),
+												numGroups(1)
+{
+
+}
+
+ActiveVoiceMixer::~ActiveVoiceMixer()
+{
+
+}
+
+void ActiveVoiceMixer::setSources(FilePlayer* players, int numPlayers, VoicePool* pool)
+{
+	filePlayers = players;
+	numFilePlayers = numPlayers;
+	voicePool = pool;
+}
+
+void ActiveVoiceMixer::setWorkerPool(RenderWorkerPool* pool)
+{
+	workerPool = pool;
+}
+
+//AudioSource
+void ActiveVoiceMixer::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+	//streamed files are stereo at most
+	streamBuffer.setSize(2, jmax(1, samplesPerBlockExpected));
+	//every group of voices but the first, which renders straight into the output, has a buffer of its own
+	for (auto& groupBuffer : groupBuffers)
+	{
+		groupBuffer.setSize(2, jmax(1, samplesPerBlockExpected));
+	}
+
+	for (int i = 0; i < numFilePlayers; i++)
+	{
+		filePlayers[i].prepareToPlay(samplesPerBlockExpected, sampleRate);
+	}
+	if (voicePool != nullptr)
+	{
+		voicePool->prepareToPlay(samplesPerBlockExpected, sampleRate);
+	}
+}
+
+void ActiveVoiceMixer::releaseResources()
+{
+	for (int i = 0; i < numFilePlayers; i++)
+	{
+		filePlayers[i].releaseResources();
+	}
+	if (voicePool != nullptr)
+	{
+		voicePool->releaseResources();
+	}
+	streamBuffer.setSize(2, 0);
+	for (auto& groupBuffer : groupBuffers)
+	{
+		groupBuffer.setSize(2, 0);
+	}
+}
+
+void ActiveVoiceMixer::getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill)
+{
+	//commands are passed on first, so notes started by a FilePlayer are heard in this block
+	for (int i = 0; i < numFilePlayers; i++)
+	{
+		filePlayers[i].processPendingCommand();
+	}
+
+	//the active voices replace the region - or silence if there are none
+	renderVoices(bufferToFill);
+
+	const int numChannels = jmin(bufferToFill.buffer->getNumChannels(), streamBuffer.getNumChannels());
+	for (int i = 0; i < numFilePlayers; i++)
+	{
+		FilePlayer& player = filePlayers[i];
+		if (!player.isStreamActive())
+		{
+			continue;
+		}
+
+		//the stream is rendered in sections no longer than the buffer allocated in prepareToPlay, then added to the output
+		int position = 0;
+		while (position < bufferToFill.numSamples)
+		{
+			const int numSamples = jmin(bufferToFill.numSamples - position, streamBuffer.getNumSamples());
+			player.renderStream(AudioSourceChannelInfo(&streamBuffer, 0, numSamples));
+
+			for (int channel = 0; channel < numChannels; channel++)
+			{
+				FloatVectorOperations::add(bufferToFill.buffer->getWritePointer(channel, bufferToFill.startSample + position),
+											streamBuffer.getReadPointer(channel),
+											numSamples);
+			}
+			position += numSamples;
+		}
+	}
+}
+
+void ActiveVoiceMixer::renderVoices(const AudioSourceChannelInfo& bufferToFill)
+{
+	if (voicePool == nullptr)
+	{
+		bufferToFill.clearActiveBufferRegion();
+		return;
+	}
+
+	//the voices are readied on this thread, as that is where the SamplePool is read
+	const int numVoices = voicePool->beginBlock();
+	numGroups = 1;
+	if (workerPool != nullptr
+		&& numVoices >= MinimumVoicesForWorkers
+		&& bufferToFill.buffer->getNumChannels() == groupBuffers[0].getNumChannels()
+		&& bufferToFill.numSamples <= groupBuffers[0].getNumSamples())
+	{
+		numGroups = jlimit(1, jmin(workerPool->getNumTasks(), (int) groupBuffers.size() + 1), numVoices / MinimumVoicesPerGroup);
+	}
+
+	if (numGroups == 1)
+	{
+		bufferToFill.clearActiveBufferRegion();
+		voicePool->renderVoices(0, numVoices, *bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
+	}
+	else
+	{
+		groupOutput = &bufferToFill;
+		numGroupVoices = numVoices;
+		workerPool->run(&ActiveVoiceMixer::renderVoiceGroup, this);
+
+		//the groups are added in the same order every time, so the sum does not depend on which thread finished first
+		for (int group = 1; group < numGroups; group++)
+		{
+			const AudioBuffer<float>& groupBuffer = groupBuffers[(size_t) group - 1];
+			for (int channel = 0; channel < bufferToFill.buffer->getNumChannels(); channel++)
+			{
+				FloatVectorOperations::add(bufferToFill.buffer->getWritePointer(channel, bufferToFill.startSample),
+											groupBuffer.getReadPointer(channel),
+											bufferToFill.numSamples);
+			}
+		}
+	}
+	voicePool->endBlock();
+}
+
+void ActiveVoiceMixer::renderVoiceGroup(void* context, int group)
+{
+	auto& mixer = *static_cast<ActiveVoiceMixer*>(context);
+	if (group >= mixer.numGroups)
+	{
+		return;
+	}
+
+	//each group is a contiguous run of the active voices, the same size to within one voice
+	const int firstVoice = group * mixer.numGroupVoices / mixer.numGroups;
+	const int endVoice = (group + 1) * mixer.numGroupVoices / mixer.numGroups;
+	const AudioSourceChannelInfo& output = *mixer.groupOutput;
+
+	if (group == 0)
+	{
+		output.clearActiveBufferRegion();
+		mixer.voicePool->renderVoices(firstVoice, endVoice, *output.buffer, output.startSample, output.numSamples);
+	}
+	else
+	{
+		AudioBuffer<float>& groupBuffer = mixer.groupBuffers[(size_t) group - 1];
+		groupBuffer.clear(0, output.numSamples);
+		mixer.voicePool->renderVoices(firstVoice, endVoice, groupBuffer, 0, output.numSamples);
+	}
+}
@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+	ActiveVoiceMixer.h
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include "fileaudio/FilePlayer.h"
+#include "fileaudio/VoicePool.h"
+#include "RenderWorkerPool.h"
+
+/** Mixes the FilePlayers and the VoicePool into the output, visiting only what is sounding. Every FilePlayer passes
+	on its pending command, then the VoicePool renders its active voices straight into the output, and only the
+	FilePlayers whose streamed file is playing are rendered and added - so with a few notes playing the cost follows
+	the number of notes rather than the number of slots. Given a RenderWorkerPool, the active voices are split into
+	contiguous groups rendered on every thread of the pool at once, and the groups are added into the output in order -
+	so the same voices split the same way always mix to the same result. */
+
+class ActiveVoiceMixer		:	public AudioSource
+{
+public:
+	/** Constructor. */
+	ActiveVoiceMixer();
+
+	/** Destructor. */
+	~ActiveVoiceMixer();
+
+	/** Passes this object the sources to mix. Should be called before the mixer is prepared.
+		@param	pointer to the first of the FilePlayers, expected to outlive this object
+		@param	int number of FilePlayers
+		@param	pointer to the VoicePool the FilePlayers start preloaded files on, expected to outlive this object */
+	void setSources(FilePlayer* players, int numPlayers, VoicePool* pool);
+
+	/** Passes this object a pool of threads to render the voices on, or nullptr to render them on the audio thread alone.
+		Should not be called while the audio thread is in getNextAudioBlock().
+		@param	pointer to a RenderWorkerPool, expected to outlive its use here, or nullptr */
+	void setWorkerPool(RenderWorkerPool* pool);
+
+	/** Holds the fewest voices worth giving a thread of their own - below this, waking the workers costs more than they
+		save - and the fewest active voices the workers are used for at all. Below that the audio thread renders every
+		voice alone, and workers left without a run for a while go to sleep. */
+	enum
+	{
+		MinimumVoicesPerGroup = 4,
+		MinimumVoicesForWorkers = 16
+	};
+
+	//AudioSource
+	/** Overridden function inherited from AudioSource. Prepares every source, and allocates the buffers streamed
+		files and groups of voices are rendered into before being added to the output.
+		@param	int number of samples expected in each call to getNextAudioBlock()
+		@param	double output sample rate */
+	void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+	/** Overridden function inherited from AudioSource. Releases every source. */
+	void releaseResources() override;
+	/** Overridden function inherited from AudioSource. Replaces the region with the mix of every sounding source.
+		@param	reference to the next block of audio data */
+	void getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill) override;
+
+private:
+	/** Replaces the region with the mix of the active voices, rendered in groups on the RenderWorkerPool when there
+		are enough of them and the region fits the group buffers, otherwise on this thread alone. */
+	void renderVoices(const AudioSourceChannelInfo& bufferToFill);
+
+	/** Renders one group of voices - the RenderWorkerPool::Task run on every thread of the pool.
+		@param	pointer to the ActiveVoiceMixer rendering
+		@param	int index of the group */
+	static void renderVoiceGroup(void* context, int group);
+
+	FilePlayer* filePlayers	{	nullptr	};
+	int numFilePlayers;
+	VoicePool* voicePool	{	nullptr	};
+	AudioBuffer<float> streamBuffer;
+
+	RenderWorkerPool* workerPool	{	nullptr	};
+	std::array<AudioBuffer<float>, RenderWorkerPool::MaximumNumberOfWorkers> groupBuffers;
+	const AudioSourceChannelInfo* groupOutput	{	nullptr	};
+	int numGroupVoices;
+	int numGroups;
+};
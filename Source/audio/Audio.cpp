@@ -6,39 +6,58 @@
 
 #include "Audio.h"
 
-Audio::Audio()		:	tempo(130),
-						sampleCounter(0),
-						rowCounter(0),
-						runState(false)
+Audio::Audio(bool shouldOpenDevice)		:	sampleRate(44100.0),
+						bpm(130.0),
+						grooveLength(1),
+						ticksPerRow(Sequencer::DefaultTicksPerRow),
+						runState(false),
+						playhead(-1),
+						playbackPosition(0),
+						deviceXRunsAtReset(0),
+						isDeviceRunning(false),
+						sampleLoader(filePlayer)
 {
-	//adds each FilePlayer as an input to the MixerAudioSource
+	setGroove(Sequencer::Groove());
+
+	//gives each FilePlayer its slot in the SamplePool, the shared DiskStreamer to stream long files on
+	//and the shared VoicePool to play preloaded files on
+	voicePool.setSamplePool(&samplePool);
 	for (int i = 0; i < Audio::NumberOfFilePlayers; i++)
 	{
-		mixerAudioSource.addInputSource(&filePlayer[i], false);
+		filePlayer[i].setSamplePool(&samplePool, i);
+		filePlayer[i].setDiskStreamer(&diskStreamer);
+		filePlayer[i].setVoicePool(&voicePool);
 	}
-
-	//adds the MixerAudioSource as an input to the AudioSourcePlayer that will be used for output
-	audioSourcePlayer.setSource(&mixerAudioSource);
+	//the mixer only renders the voices and streams that are sounding
+	mixer.setSources(filePlayer.data(), (int) filePlayer.size(), &voicePool);
+	//the effect engine starts and changes the notes of every channel on the same voices and FilePlayers
+	effectEngine.setVoicePool(&voicePool);
+	effectEngine.setFilePlayers(filePlayer.data(), (int) filePlayer.size());
 
 	//sets the audio output device to the default device, printing an errorMessage to console if no audio devices are available
-	auto errorMessage = audioDeviceManager.initialiseWithDefaultDevices(1, 2);
-	if (!errorMessage.isEmpty())
+	if (shouldOpenDevice)
 	{
-		DBG(errorMessage);
+		auto errorMessage = audioDeviceManager.initialiseWithDefaultDevices(1, 2);
+		if (!errorMessage.isEmpty())
+		{
+			DBG(errorMessage);
+		}
+		audioDeviceManager.addAudioCallback(this);
+		//notes from every MIDI input enabled in the audio settings are played live
+		audioDeviceManager.addMidiInputDeviceCallback({}, &liveInput);
 	}
-	audioDeviceManager.addAudioCallback(this);
+
+	//periodically frees the songs and samples replaced on the audio thread
+	startTimer(250);
 }
 
 Audio::~Audio()
 {
 	//following lines perform cleanup for when Audio goes out of scope (i.e. when application closed)
+	stopTimer();
 	//removes audio and midi callbacks
+	audioDeviceManager.removeMidiInputDeviceCallback({}, &liveInput);
 	audioDeviceManager.removeAudioCallback(this);
-
-	//remove the MixerAudioSource from the AudioSourcePlayer used for output, ending audio
-	audioSourcePlayer.setSource(nullptr);
-	//removes all inputs from the MixerAudioSource
-	mixerAudioSource.removeAllInputs();
 }
 
 FilePlayer* Audio::getFilePlayer(int index)
@@ -60,10 +79,109 @@ std::array<FilePlayer, Audio::NumberOfFilePlayers>& Audio::getFilePlayerArray()
 	return filePlayer;
 }
 
-void Audio::setBpm(int bpm)
+void Audio::setVoiceStealingPolicy(VoicePool::StealingPolicy policy)
+{
+	voicePool.setStealingPolicy(policy);
+}
+
+VoicePool::StealingPolicy Audio::getVoiceStealingPolicy() const
+{
+	return voicePool.getStealingPolicy();
+}
+
+void Audio::setInterpolationMode(SampleInterpolator::Mode mode)
+{
+	voicePool.setInterpolationMode(mode);
+}
+
+SampleInterpolator::Mode Audio::getInterpolationMode() const
 {
-	//bpm divided by 60,000 = time in milliseconds for each sixteenth note
-	tempo = (60000 / bpm) / 4;
+	return voicePool.getInterpolationMode();
+}
+
+void Audio::setParallelRendering(bool shouldRenderInParallel)
+{
+	if (shouldRenderInParallel == isParallelRendering())
+	{
+		return;
+	}
+
+	//the workers are started and stopped outside the lock, so the audio thread is never held up waiting for them
+	std::unique_ptr<RenderWorkerPool> newPool;
+	if (shouldRenderInParallel)
+	{
+		newPool = std::make_unique<RenderWorkerPool>(RenderWorkerPool::getDefaultNumberOfWorkers());
+	}
+	{
+		const ScopedLock sl(audioDeviceManager.getAudioCallbackLock());
+		std::swap(workerPool, newPool);
+		if (workerPool != nullptr)
+		{
+			workerPool->setActive(isDeviceRunning);
+		}
+		mixer.setWorkerPool(workerPool.get());
+	}
+}
+
+bool Audio::isParallelRendering() const
+{
+	return workerPool != nullptr;
+}
+
+void Audio::setMidiClockOutput(std::unique_ptr<MidiOutput> newOutput)
+{
+	//the output replaced is closed outside the lock, so the audio thread is never held up waiting for its thread to stop
+	std::unique_ptr<MidiOutput> oldOutput;
+	{
+		const ScopedLock sl(audioDeviceManager.getAudioCallbackLock());
+		oldOutput = midiClock.setOutput(std::move(newOutput));
+	}
+}
+
+String Audio::getMidiClockOutputIdentifier() const
+{
+	return midiClock.getOutputIdentifier();
+}
+
+void Audio::setBpm(double newBpm)
+{
+	bpm = jmax(1.0, newBpm);
+}
+
+double Audio::getBpm() const
+{
+	return bpm;
+}
+
+void Audio::setGroove(const Sequencer::Groove& newGroove)
+{
+	//the lengths are stored before the length is, so the audio thread never reads a length that has not been set
+	for (size_t row = 0; row < grooveRowLengths.size(); row++)
+	{
+		grooveRowLengths[row].store(newGroove.rowLengths[row], std::memory_order_relaxed);
+	}
+	grooveLength.store(jlimit(1, (int) Sequencer::MaximumGrooveLength, newGroove.length), std::memory_order_release);
+}
+
+Sequencer::Groove Audio::getGroove() const
+{
+	Sequencer::Groove groove;
+	groove.length = grooveLength.load(std::memory_order_acquire);
+	for (size_t row = 0; row < grooveRowLengths.size(); row++)
+	{
+		groove.rowLengths[row] = grooveRowLengths[row].load(std::memory_order_relaxed);
+	}
+	return groove;
+}
+
+void Audio::setTicksPerRow(int newTicksPerRow)
+{
+	ticksPerRow = jlimit(1, (int) Sequencer::MaximumTicksPerRow, newTicksPerRow);
+}
+
+int Audio::getTicksPerRow() const
+{
+	return ticksPerRow;
 }
 
 void Audio::setRunState(bool rs)
@@ -71,11 +189,108 @@ void Audio::setRunState(bool rs)
 	runState = rs;
 }
 
-void Audio::setTrackerCellGuiArray(std::array<std::array<TrackerCellGui, 4>, 64>& tcga)
+bool Audio::getRunState() const
+{
+	return runState;
+}
+
+Audio::Playhead Audio::getPlayhead() const
+{
+	//the pattern and row are packed into a single int by the audio thread, so they are always read as a pair
+	const int packedPlayhead = playhead.load(std::memory_order_relaxed);
+	Playhead result;
+	if (packedPlayhead >= 0)
+	{
+		result.pattern = packedPlayhead / Pattern::MaximumNumberOfRows;
+		result.row = packedPlayhead % Pattern::MaximumNumberOfRows;
+	}
+	return result;
+}
+
+int64 Audio::getPlaybackPosition() const
+{
+	return playbackPosition.load(std::memory_order_relaxed);
+}
+
+void Audio::setSong(Song::Ptr newSong)
+{
+	//the audio thread swaps the new song in at the start of its next callback
+	song.publish(newSong);
+}
+
+Song::Ptr Audio::getSong() const
+{
+	return song.getLatest();
+}
+
+PooledSample::Ptr Audio::getPreloadedSample(int slot) const
 {
-	//points the pointer (*trackerCellGuiArray) to the address of the first element in the
-	//2D array tcga - this allows standard array access syntax later on in the audioDeviceIOCallback
-	trackerCellGuiArray = &tcga[0];
+	return samplePool.getSample(slot);
+}
+
+void Audio::copySamplesFromMapping(const MemoryMappedFile& mapping)
+{
+	//the copies are made outside the lock - only picking them up and stopping the voices needs the audio thread held off
+	bool anyCopied = false;
+	for (int slot = 0; slot < SamplePool::NumberOfSlots; slot++)
+	{
+		PooledSample::Ptr sample = samplePool.getSample(slot);
+		if (sample->isMappedFrom(mapping))
+		{
+			//copying a buffer that refers to memory it doesn't own would refer to it too - makeCopyOf() allocates
+			AudioBuffer<float> copy;
+			copy.makeCopyOf(sample->getData());
+			samplePool.setSample(slot, new PooledSample(std::move(copy), sample->getSampleRate()));
+			anyCopied = true;
+		}
+	}
+	if (!anyCopied)
+	{
+		return;
+	}
+
+	{
+		const ScopedLock sl(audioDeviceManager.getAudioCallbackLock());
+		voicePool.takeLatestSamples();
+	}
+	samplePool.collectGarbage();
+}
+
+int Audio::getStreamUnderrunCount() const
+{
+	int count = 0;
+	for (auto& player : filePlayer)
+	{
+		count += player.getUnderrunCount();
+	}
+	return count;
+}
+
+int Audio::getDeviceXRunCount() const
+{
+	//the device's count cannot be reset, so the count at the last reset is taken off it
+	return jmax(0, audioDeviceManager.getXRunCount() - deviceXRunsAtReset);
+}
+
+void Audio::resetTelemetry()
+{
+	telemetry.reset();
+	deviceXRunsAtReset = audioDeviceManager.getXRunCount();
+	for (auto& player : filePlayer)
+	{
+		player.resetUnderrunCount();
+	}
+}
+
+void Audio::timerCallback()
+{
+	song.collectGarbage();
+	samplePool.collectGarbage();
+	//the audio thread can't wake sleeping render workers without locking, so it leaves that to here
+	if (workerPool != nullptr)
+	{
+		workerPool->wakeWorkersIfRequested();
+	}
 }
 
 void Audio::audioDeviceIOCallback(const float** inputChannelData,
@@ -84,86 +299,184 @@ void Audio::audioDeviceIOCallback(const float** inputChannelData,
 	int numOutputChannels,
 	int numSamples)
 {
-	//get the audio from our file player - player puts samples in the output buffer
-	audioSourcePlayer.audioDeviceIOCallback(inputChannelData, numInputChannels, outputChannelData, numOutputChannels, numSamples);
-	
-	sampleRate = audioDeviceManager.getAudioDeviceSetup().sampleRate;
+	const int64 callbackStart = Time::getHighResolutionTicks();
 
-	//all audio processing is done here
-	const float* inL = inputChannelData[0];
+	//picks up the latest song published by the message thread - this is the only song read during this callback
+	const Song* currentSong = song.acquire();
+	const int orderLength = currentSong != nullptr ? currentSong->getOrderLength() : 1;
+	const int numRows = currentSong != nullptr ? currentSong->getNumRows() : (int) Pattern::DefaultNumberOfRows;
 
-	float *outL = outputChannelData[0];
-	float *outR = outputChannelData[1];
+	//refers to the device's output channels without copying them, so the mixer can render straight into them
+	AudioBuffer<float> outputBuffer(outputChannelData, numOutputChannels, numSamples);
 
-	while (numSamples--)
+	const double samplesPerRow = Sequencer::getSamplesPerRow(sampleRate, bpm.load(std::memory_order_relaxed));
+	const int currentTicksPerRow = ticksPerRow.load(std::memory_order_relaxed);
+	const Sequencer::Groove groove = getGroove();
+
+	const bool isRunning = runState;
+	int64 position64 = playbackPosition.load(std::memory_order_relaxed);
+
+	midiClock.beginBlock(sampleRate, numSamples);
+
+	//the notes played live since the last block, each placed on the sample it plays on
+	const int numLiveEvents = liveInput.collectEvents(sampleRate, numSamples);
+	int nextLiveEvent = 0;
+
+	//the block is split at every tick boundary: the audio before the boundary is rendered, the row is triggered or its
+	//effects are stepped on, and the rest of the block is rendered afterwards - so each happens at its exact sample.
+	//notes played live split the block in the same way
+	int position = 0;
+	while (position < numSamples)
 	{
-		//if the runState of the tracker has been set to true, begin iterating through the TrackerCellGuis held in each row of the
-		//tracker interface
-		if (runState)
+		while (nextLiveEvent < numLiveEvents && liveInput.getEvent(nextLiveEvent).sampleOffset <= position)
 		{
-			/*	sampleRate / 1000 = number of samples per millisecond
-				number of samples per millisecond * rate at which the events held in TrackerCellGuis will be read in milliseconds
-				= number of samples to count before reading a new TrackerCellGui event */
-			if (sampleCounter >= ((sampleRate / 1000) * tempo))
+			playLiveEvent(currentSong, liveInput.getEvent(nextLiveEvent++), isRunning);
+		}
+
+		int samplesToRender = numSamples - position;
+		if (nextLiveEvent < numLiveEvents)
+		{
+			samplesToRender = liveInput.getEvent(nextLiveEvent).sampleOffset - position;
+		}
+
+		//if the runState of the tracker has been set to true, begin iterating through the rows of the song
+		if (isRunning)
+		{
+			Sequencer::Position startingPosition;
+			samplesToRender = sequencer.advance(samplesToRender, samplesPerRow, currentTicksPerRow, groove,
+														orderLength, numRows, startingPosition);
+			if (startingPosition.tick == 0)
+			{
+				//playback always starts from the first row, which is where anything following the clock starts too
+				midiClock.start(position);
+				triggerRow(currentSong, startingPosition);
+				//publish the row that has just started, and its pattern, for the interface to display
+				const int pattern = currentSong != nullptr ? currentSong->getPatternAtOrder(startingPosition.order) : 0;
+				playhead.store(pattern * Pattern::MaximumNumberOfRows + startingPosition.row, std::memory_order_relaxed);
+			}
+			if (startingPosition.tick >= 0)
+			{
+				effectEngine.processTick(startingPosition.tick);
+			}
+
+			//the clock pulses split each row, so they follow the groove - none are sent before the first row starts
+			std::array<int, Sequencer::ClocksPerRow> clockOffsets;
+			const int numClocks = sequencer.getClockPulses(samplesToRender, clockOffsets.data());
+			for (int i = 0; i < numClocks; i++)
 			{
-				//for each TrackerCellGui in the current row
-				for (int col = 0; col < trackerCellGuiArray[0].size(); col++)
-				{
-					//get the sampleNumber from the current TrackerCellGui being read
-					int sampleNumber = trackerCellGuiArray[rowCounter][col].getEventInfo()[1].getIntValue();
-
-					//sampleNumber -1 is used to represent an invalid / unset sample - ignore this cell if sampleNumber is -1
-					if (sampleNumber != -1)
-					{
-						//get the pitch and gain from the current TrackerCellGui being read
-						double pitch = trackerCellGuiArray[rowCounter][col].getEventInfo()[0].getDoubleValue();
-						float gain = trackerCellGuiArray[rowCounter][col].getEventInfo()[2].getFloatValue();
-
-						//pass these values to the relevant FilePlayer
-						filePlayer[sampleNumber].setPlaybackRate(pitch);
-						filePlayer[sampleNumber].setGain(gain);
-						filePlayer[sampleNumber].setPlaying(true);
-					}
-				}
-
-				//increment the row counter
-				rowCounter++;
-				//if the row counter is equal to the number of rows in the tracker interface
-				if (rowCounter == 63)
-				{
-					//reset the row counter
-					rowCounter = 0;
-				}
-				//reset the sample counter
-				sampleCounter = 0;
+				midiClock.addClock(position + clockOffsets[(size_t) i]);
 			}
-			//increment the sample counter
-			sampleCounter++;
+			position64 += samplesToRender;
 		}
-		//if the run state of the tracker is false, reset the sample and row counters
+		//if the run state of the tracker is false, move back to the first row
 		else
 		{
-			sampleCounter = 0;
-			rowCounter = 0;
+			midiClock.stop(position);
+			sequencer.reset(false);
+			effectEngine.reset();
+			position64 = 0;
+			playhead.store(-1, std::memory_order_relaxed);
 		}
-		float fileOutL = *outL;
-		float fileOutR = *outR;
-
-		*outL = fileOutL;
-		*outR = fileOutR;
 
-		inL++;
-		outL++;
-		outR++;
+		//get the audio from our file players - the mixer renders the sounding ones into this section of the output buffer
+		mixer.getNextAudioBlock(AudioSourceChannelInfo(&outputBuffer, position, samplesToRender));
+		position += samplesToRender;
 	}
+
+	playbackPosition.store(position64, std::memory_order_relaxed);
+	midiClock.endBlock();
+
+	//the callback has used this share of the time it has before the device needs the next block
+	telemetry.recordCallback(Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - callbackStart),
+							numSamples / sampleRate);
 }
 
 void Audio::audioDeviceAboutToStart(AudioIODevice* device)
 {
-	audioSourcePlayer.audioDeviceAboutToStart(device);
+	//reading the sample rate here avoids querying the device setup (which allocates) on every callback
+	sampleRate = device->getCurrentSampleRate();
+	mixer.prepareToPlay(device->getCurrentBufferSizeSamples(), sampleRate);
+	//the audio of each block is heard a block and the device's output latency after the callback starts
+	midiClock.setLatency(device->getCurrentBufferSizeSamples() + device->getOutputLatencyInSamples());
+	//the workers only spin while the device is calling back
+	isDeviceRunning = true;
+	if (workerPool != nullptr)
+	{
+		workerPool->setActive(true);
+	}
+	//samples loaded from now on are converted to the device's rate, so unpitched notes need no interpolation
+	sampleLoader.setTargetSampleRate(sampleRate);
 }
 
 void Audio::audioDeviceStopped()
 {
-	audioSourcePlayer.audioDeviceStopped();
+	isDeviceRunning = false;
+	if (workerPool != nullptr)
+	{
+		workerPool->setActive(false);
+	}
+	mixer.releaseResources();
+	midiClock.reset();
+}
+
+void Audio::triggerRow(const Song* currentSong, const Sequencer::Position& position)
+{
+	effectEngine.beginRow();
+	if (currentSong == nullptr)
+	{
+		return;
+	}
+
+	//for each event in the current row of the pattern the order list has reached - rows only hold the channels
+	//that have an event, so empty channels cost nothing
+	const Pattern currentPattern = currentSong->getPattern(currentSong->getPatternAtOrder(position.order));
+	for (auto& channelEvent : currentPattern.getRow(position.row))
+	{
+		effectEngine.triggerEvent(channelEvent.channel, channelEvent.event);
+	}
+}
+
+void Audio::playLiveEvent(const Song* currentSong, const LiveInput::Event& event, bool isRunning)
+{
+	if (!isPositiveAndBelow(event.channel - 1, (int) liveNotes.size()) || !isPositiveAndBelow(event.note, (int) liveNotes[0].size()))
+	{
+		return;
+	}
+
+	//a key played again before it was released cuts the note it started, as a channel does when it starts a new one
+	LiveNote& liveNote = liveNotes[(size_t) (event.channel - 1)][(size_t) event.note];
+	voicePool.stopVoice(liveNote.voice);
+	if (liveNote.streamedSlot >= 0)
+	{
+		filePlayer[(size_t) liveNote.streamedSlot].stopStream(liveNote.streamedNote);
+	}
+	liveNote = LiveNote();
+
+	if (!event.isNoteOn)
+	{
+		return;
+	}
+
+	const double pitchRatio = std::pow(2.0, (event.note - 60) / 12.0);
+	liveNote.voice = voicePool.startVoice(event.slot, pitchRatio, event.gain);
+	//slots that are not preloaded are streamed on their FilePlayer, which plays one note at a time
+	if (liveNote.voice.index < 0 && isPositiveAndBelow(event.slot, (int) NumberOfFilePlayers))
+	{
+		//the start is queued, and applied when the FilePlayer renders its next block - nothing here locks or waits
+		liveNote.streamedNote = filePlayer[(size_t) event.slot].startStream(pitchRatio, event.gain, 0);
+		liveNote.streamedSlot = event.slot;
+	}
+
+	//while the song plays, the note is written into the row it was played in
+	if (isRunning && currentSong != nullptr && liveInput.isRecording())
+	{
+		const Sequencer::Position row = sequencer.getCurrentRow();
+		LiveInput::RecordedNote recordedNote;
+		recordedNote.pattern = currentSong->getPatternAtOrder(row.order);
+		recordedNote.row = row.row;
+		recordedNote.slot = event.slot;
+		recordedNote.note = event.note;
+		recordedNote.gain = event.gain;
+		liveInput.recordNote(recordedNote);
+	}
 }
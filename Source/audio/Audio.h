@@ -8,16 +8,29 @@
 
 #include <JuceHeader.h>
 #include <array>
+#include <atomic>
+#include <memory>
 #include "fileaudio/FilePlayer.h"
-#include "../ui/trackerui/TrackerCellGui.h"
+#include "fileaudio/SampleLoader.h"
+#include "ActiveVoiceMixer.h"
+#include "RenderWorkerPool.h"
+#include "LiveInput.h"
+#include "MidiClockOutput.h"
+#include "trackeraudio/Song.h"
+#include "trackeraudio/Sequencer.h"
+#include "trackeraudio/EffectEngine.h"
+#include "SnapshotExchange.h"
+#include "CallbackTelemetry.h"
 
 /** Class containing all audio processes. */
 
-class Audio		:	public AudioIODeviceCallback
+class Audio		:	public AudioIODeviceCallback,
+					private Timer
 {
 public:
-	/** Constructor. */
-	Audio();
+	/** Constructor.
+		@param	bool true to open the default audio device, false to leave the callback to be driven by hand - as the benchmark does */
+	Audio(bool shouldOpenDevice = true);
 
 	/** Destructor. */
 	~Audio();
@@ -25,7 +38,7 @@ public:
 	/** Holds number of samples useable in tracker. */
 	enum
 	{
-		NumberOfFilePlayers = 32
+		NumberOfFilePlayers = SamplePool::NumberOfSlots
 	};
 
 	/** Returns a reference to the FilePlayer specified by index. Be careful to check that
@@ -40,29 +53,154 @@ public:
 		@see	NumberOfFilePlayers */
 	std::array<FilePlayer, NumberOfFilePlayers>& getFilePlayerArray();
 
+	/** Returns the SampleLoader that loads files into the FilePlayers in the background, don't keep a copy of it!
+		@return	reference to the SampleLoader held by this object */
+	SampleLoader& getSampleLoader() { return sampleLoader; }
+
 	/** Returns the audio device manager, don't keep a copy of it!
 		@return reference to the AudioDeviceManager created by this object */
 	AudioDeviceManager& getAudioDeviceManager() { return audioDeviceManager; }
 
-	/** Sets the rate at which the events held in TrackerCellGuis will be read in beats per minute.
-		Internally this method calculates the rate in milliseconds from the given bpm value and 
-		assigns it to tempo.
-		@param	int rate at which events held in TrackerCellGuis will be read in beats per minute */
-	void setBpm(int bpm);
+	/** Returns the LiveInput that queues notes played on MIDI devices and the on-screen keyboard, don't keep a copy of it!
+		@return	reference to the LiveInput held by this object */
+	LiveInput& getLiveInput() { return liveInput; }
+
+	/** Sets how a voice is chosen to be cut off when every voice in the VoicePool is playing.
+		@param	VoicePool::StealingPolicy new policy */
+	void setVoiceStealingPolicy(VoicePool::StealingPolicy policy);
+
+	/** Returns how a voice is chosen to be cut off when every voice in the VoicePool is playing.
+		@return	VoicePool::StealingPolicy current policy */
+	VoicePool::StealingPolicy getVoiceStealingPolicy() const;
+
+	/** Sets how preloaded samples are read between samples when pitched.
+		@param	SampleInterpolator::Mode new interpolation mode */
+	void setInterpolationMode(SampleInterpolator::Mode mode);
+
+	/** Returns how preloaded samples are read between samples when pitched.
+		@return	SampleInterpolator::Mode current interpolation mode */
+	SampleInterpolator::Mode getInterpolationMode() const;
+
+	/** Sets whether the active voices are split into groups rendered on a pool of worker threads, one for every core
+		but the audio thread's, instead of on the audio thread alone. Off by default. Should only be called from the
+		message thread.
+		@param	bool true to render on the worker threads
+		@see	RenderWorkerPool */
+	void setParallelRendering(bool shouldRenderInParallel);
+
+	/** Returns true if the active voices are rendered on a pool of worker threads. Should only be called from the message thread. */
+	bool isParallelRendering() const;
+
+	/** Sends MIDI clock at 24 pulses to the beat, with start, stop and song position messages, to the given output -
+		each at the sample the song reaches it on, following the tempo and groove. Should only be called from the
+		message thread.
+		@param	std::unique_ptr to an open MidiOutput, or nullptr to stop sending
+		@see	MidiClockOutput */
+	void setMidiClockOutput(std::unique_ptr<MidiOutput> newOutput);
+
+	/** Returns the identifier of the output MIDI clock is sent to, or an empty string if it is not being sent.
+		Should only be called from the message thread. */
+	String getMidiClockOutputIdentifier() const;
+
+	/** Sets the rate at which the events held in TrackerCellGuis will be read in beats per minute, each row being a
+		sixteenth note. The tempo need not be a whole number - rows last a fractional number of samples, and the
+		audio thread carries the remainder from row to row. Safe to call from any thread.
+		@param	double rate at which events held in TrackerCellGuis will be read in beats per minute */
+	void setBpm(double newBpm);
+
+	/** Returns the rate at which rows are read in beats per minute, as set by setBpm. Safe to call from any thread. */
+	double getBpm() const;
+
+	/** Sets the swing or groove rows are played with, lengthening and shortening them in a repeating pattern without
+		changing the tempo. Safe to call from any thread - a groove changed during a block takes effect from the next row.
+		@param	Sequencer::Groove to play rows with
+		@see	Sequencer::Groove::fromSwing */
+	void setGroove(const Sequencer::Groove& newGroove);
+
+	/** Returns the swing or groove rows are played with. Safe to call from any thread. */
+	Sequencer::Groove getGroove() const;
+
+	/** Sets the number of ticks each row is split into - the resolution the effects of the song are applied at.
+		Safe to call from any thread.
+		@param	int ticks per row, limited to the range 1 to Sequencer::MaximumTicksPerRow */
+	void setTicksPerRow(int newTicksPerRow);
+
+	/** Returns the number of ticks each row is split into. Safe to call from any thread. */
+	int getTicksPerRow() const;
 
 	/** Sets the running state of the tracker - true will start playback,
 		false will end playback.
 		@param	bool new running state */
 	void setRunState(bool rs);
 
-	/** Passes this class a reference to a two dimensional array of TrackerCellGuis for
-		(*trackerCellGuiArray) to point to.
-		@param	reference to a two dimensional array of TrackerCellGuis of size [4][64] */
-	void setTrackerCellGuiArray(std::array<std::array<TrackerCellGui, 4>, 64>& trackerCellGuiArray);
+	/** Gets the running state of the tracker.
+		@return	bool running state (true is playing, false is stopped)
+		@see	setRunState */
+	bool getRunState() const;
+
+	/** The row most recently triggered by the audio thread, and the pattern it belongs to. */
+	struct Playhead
+	{
+		/** Index of the pattern, -1 if the tracker is stopped or no row has been triggered yet. */
+		int pattern = -1;
+		/** Index of the row, -1 if the tracker is stopped or no row has been triggered yet. */
+		int row = -1;
+	};
+
+	/** Returns the row most recently triggered by the audio thread and the pattern it belongs to. Safe to call from
+		any thread - this is how the interface follows playback, so the highlighted row always matches what is heard.
+		Both are published together, so the row always belongs to the pattern returned with it.
+		@return	Playhead holding the playing pattern and row */
+	Playhead getPlayhead() const;
+
+	/** Returns the number of samples the audio thread has rendered since playback started. Safe to call from any thread.
+		@return	int64 playback position in samples, 0 while stopped */
+	int64 getPlaybackPosition() const;
+
+	/** Publishes a new Song to be read by the audio thread from its next callback onwards. Playback carries on from
+		the same row and entry of the order list. Should only be called from the message thread. The song must not be
+		modified after it is passed here.
+		@param	Song::Ptr song to play
+		@see	Song */
+	void setSong(Song::Ptr newSong);
+
+	/** Returns the Song most recently passed to setSong. Should only be called from the message thread.
+		@return	Song::Ptr to the latest song, or nullptr if none has been published */
+	Song::Ptr getSong() const;
+
+	/** Returns the sample most recently preloaded into the given slot. Should only be called from the message thread.
+		@param	int slot in the range of NumberOfFilePlayers
+		@return	PooledSample::Ptr to the sample, which is empty if the slot's file is streamed or none is loaded */
+	PooledSample::Ptr getPreloadedSample(int slot) const;
+
+	/** Replaces every preloaded sample whose audio lies in the given memory-mapped file with a copy in memory, and makes
+		the audio thread let go of the originals straight away - so once nothing else holds the mapping, the file can be
+		closed and overwritten. Voices playing the originals are cut off. Should only be called from the message thread.
+		@param	reference to the MemoryMappedFile the samples are to stop being played from */
+	void copySamplesFromMapping(const MemoryMappedFile& mapping);
+
+	/** Returns the timings recorded for every audio callback, for the interface to show the load on the audio thread.
+		@return	reference to the CallbackTelemetry held by this object */
+	CallbackTelemetry& getTelemetry() { return telemetry; }
+
+	/** Returns the number of blocks streamed files have played silence in because their read-ahead had not caught up,
+		summed over every FilePlayer. Safe to call from any thread. */
+	int getStreamUnderrunCount() const;
+
+	/** Returns the number of xruns the audio device has reported since the telemetry was last reset, or 0 if it cannot
+		report them. Should only be called from the message thread. */
+	int getDeviceXRunCount() const;
+
+	/** Sets the callback timings and every underrun count back to zero. Should only be called from the message thread. */
+	void resetTelemetry();
 
 	//AudioIODeviceCallback
 	/** Overridden function inherited from AudioIODeviceCallback. Processes a block of audio data.
-		Counts samples and rows to trigger musical events at 16th note divisions of the user-specified BPM.
+		Counts samples and rows to trigger musical events at 16th note divisions of the user-specified BPM, with the groove applied.
+		The block is rendered in sections split at each tick boundary and each note played live, so events start, and
+		their effects change, at their exact sample.
+		MIDI clock and transport messages are sent at the samples they fall on.
+		The time taken is recorded in the CallbackTelemetry against the length of the block.
 		@param	float** pointer to a 2D array of type float containing the incoming audio data for each audio channel
 		@param	int number of channels of incoming audio data
 		@param	float** pointer to a 2D array of type float to fill with the outgoing audio data for each audio channel
@@ -74,20 +212,64 @@ public:
 								int numOutputChannels,
 								int numSamples) override;
 	/** Overridden function inherited from AudioIODeviceCallback. Called when the audio device is about to start calling back.
+		Prepares the ActiveVoiceMixer for the device's sample rate and buffer size, and delays MIDI clock to match the device's latency.
 		@param pointer to an AudioIODevice object to get incoming audio data from and push outgoing audio data to */
 	void audioDeviceAboutToStart(AudioIODevice* device) override;
 	/** Overridden function inherited from AudioIODeviceCallback. Called when the audio device has stopped. */
 	void audioDeviceStopped() override;
 
 private:
+	/** Passes each event in the given row of the song to the EffectEngine, which starts preloaded samples on a new
+		voice from the VoicePool and streamed samples on the relevant FilePlayer. Called from the audio thread at the
+		sample the row starts on.
+		@param	pointer to the Song to read, may be nullptr
+		@param	Sequencer::Position of the row to trigger */
+	void triggerRow(const Song* currentSong, const Sequencer::Position& position);
+
+	/** Starts or stops a note played live, on a voice from the VoicePool if its slot is preloaded and otherwise on
+		the slot's FilePlayer, and queues it to be written into the row being played if recording. Called from the
+		audio thread at the sample the note plays on.
+		@param	pointer to the Song being played, may be nullptr
+		@param	LiveInput::Event to play
+		@param	bool true if the song is playing */
+	void playLiveEvent(const Song* currentSong, const LiveInput::Event& event, bool isRunning);
+
+	//Timer
+	/** Overridden function inherited from Timer. Frees the songs and samples the audio thread has finished with. */
+	void timerCallback() override;
+
+	/** The note a key played live last started, so its note off can stop it. Keys are told apart by MIDI channel as
+		well as note number, as each channel plays a different slot. */
+	struct LiveNote
+	{
+		VoicePool::VoiceHandle voice;
+		int streamedSlot = -1;
+		uint32 streamedNote = 0;
+	};
+
 	double sampleRate;
-	int sampleCounter;
-	int rowCounter;
-	int tempo;
-	bool runState;
+	std::atomic<double> bpm;
+	std::array<std::atomic<float>, Sequencer::MaximumGrooveLength> grooveRowLengths;
+	std::atomic<int> grooveLength;
+	std::atomic<int> ticksPerRow;
+	Sequencer sequencer;
+	EffectEngine effectEngine;
+	std::atomic<bool> runState;
+	std::atomic<int> playhead;
+	std::atomic<int64> playbackPosition;
+	CallbackTelemetry telemetry;
+	int deviceXRunsAtReset;
 	AudioDeviceManager audioDeviceManager;
-	AudioSourcePlayer audioSourcePlayer;
-	MixerAudioSource mixerAudioSource;
-	std::array<TrackerCellGui,4> (*trackerCellGuiArray);
+	ActiveVoiceMixer mixer;
+	std::unique_ptr<RenderWorkerPool> workerPool;
+	bool isDeviceRunning;
+	MidiClockOutput midiClock;
+	SnapshotExchange<Song> song;
+	SamplePool samplePool;
+	DiskStreamer diskStreamer;
+	VoicePool voicePool;
 	std::array<FilePlayer, NumberOfFilePlayers> filePlayer;
+	SampleLoader sampleLoader;
+	LiveInput liveInput;
+	std::array<std::array<LiveNote, 128>, 16> liveNotes;
 };
@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+	CallbackTelemetry.cpp
+  ==============================================================================
+*/
+
+#include "CallbackTelemetry.h"
+
+CallbackTelemetry::CallbackTelemetry()		:	load(0.f),
+												peakLoad(0.f),
+												numCallbacks(0),
+												numOverruns(0)
+{
+	for (auto& count : histogram)
+	{
+		count = 0;
+	}
+}
+
+CallbackTelemetry::~CallbackTelemetry()
+{
+
+}
+
+void CallbackTelemetry::recordCallback(double durationInSeconds, double periodInSeconds) noexcept
+{
+	if (periodInSeconds <= 0.0)
+	{
+		return;
+	}
+
+	const float newLoad = (float) (durationInSeconds / periodInSeconds);
+	load.store(newLoad, std::memory_order_relaxed);
+
+	//only the audio thread raises the peak, so a plain compare and store is enough
+	if (newLoad > peakLoad.load(std::memory_order_relaxed))
+	{
+		peakLoad.store(newLoad, std::memory_order_relaxed);
+	}
+
+	numCallbacks.fetch_add(1, std::memory_order_relaxed);
+	if (newLoad >= 1.f)
+	{
+		numOverruns.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	const int bin = jmin((int) (newLoad * 100.f) / (int) BinWidthInPercent, (int) NumberOfBins - 1);
+	histogram[(size_t) bin].fetch_add(1, std::memory_order_relaxed);
+}
+
+float CallbackTelemetry::getLoad() const noexcept
+{
+	return load.load(std::memory_order_relaxed);
+}
+
+float CallbackTelemetry::takePeakLoad() noexcept
+{
+	return peakLoad.exchange(0.f, std::memory_order_relaxed);
+}
+
+int64 CallbackTelemetry::getNumCallbacks() const noexcept
+{
+	return numCallbacks.load(std::memory_order_relaxed);
+}
+
+int64 CallbackTelemetry::getNumOverruns() const noexcept
+{
+	return numOverruns.load(std::memory_order_relaxed);
+}
+
+int64 CallbackTelemetry::getHistogramCount(int bin) const noexcept
+{
+	jassert(isPositiveAndBelow(bin, (int) NumberOfBins));
+	return histogram[(size_t) bin].load(std::memory_order_relaxed);
+}
+
+void CallbackTelemetry::reset() noexcept
+{
+	load = 0.f;
+	peakLoad = 0.f;
+	numCallbacks = 0;
+	numOverruns = 0;
+	for (auto& count : histogram)
+	{
+		count = 0;
+	}
+}
@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+	CallbackTelemetry.h
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+/** Records how long each audio callback takes against the length of audio it had to produce. Written by the audio
+	thread with relaxed atomics only - it never locks or allocates - and read by the message thread to show how
+	close the callback is getting to its deadline. */
+
+class CallbackTelemetry
+{
+public:
+	/** Constructor. */
+	CallbackTelemetry();
+
+	/** Destructor. */
+	~CallbackTelemetry();
+
+	/** Holds the layout of the load histogram: each bin covers BinWidthInPercent of the buffer period, and the
+		last bin counts every callback that ran past its deadline. */
+	enum
+	{
+		BinWidthInPercent = 10,
+		NumberOfBins = (100 / BinWidthInPercent) + 1
+	};
+
+	/** Records a callback. Should only be called from the audio thread.
+		@param	double time the callback took, in seconds
+		@param	double length of the audio it produced, in seconds */
+	void recordCallback(double durationInSeconds, double periodInSeconds) noexcept;
+
+	/** Returns the load of the most recent callback - the time it took as a proportion of its buffer period.
+		Safe to call from any thread. */
+	float getLoad() const noexcept;
+
+	/** Returns the highest load recorded since this was last called, and starts looking for a new peak.
+		Should only be called from the message thread. */
+	float takePeakLoad() noexcept;
+
+	/** Returns the number of callbacks recorded. Safe to call from any thread. */
+	int64 getNumCallbacks() const noexcept;
+
+	/** Returns the number of callbacks that took longer than their buffer period. Safe to call from any thread. */
+	int64 getNumOverruns() const noexcept;
+
+	/** Returns the number of callbacks recorded in the given bin of the load histogram. Safe to call from any thread.
+		@param	int bin in the range of NumberOfBins */
+	int64 getHistogramCount(int bin) const noexcept;
+
+	/** Clears every count. Should only be called from the message thread - callbacks recorded at the same time may be lost. */
+	void reset() noexcept;
+
+private:
+	std::atomic<float> load;
+	std::atomic<float> peakLoad;
+	std::atomic<int64> numCallbacks;
+	std::atomic<int64> numOverruns;
+	std::array<std::atomic<int64>, NumberOfBins> histogram;
+
+	JUCE_DECLARE_NON_COPYABLE(CallbackTelemetry)
+};
@@ -0,0 +1,146 @@
+/*
+  ==============================================================================
+	LiveInput.cpp
+  ==============================================================================
+*/
+
+#include "LiveInput.h"
+
+LiveInput::LiveInput()		:	slot(0),
+								recording(false),
+								eventFifo(QueueSize),
+								recordedFifo(QueueSize)
+{
+	keyboardState.addListener(this);
+}
+
+LiveInput::~LiveInput()
+{
+	keyboardState.removeListener(this);
+}
+
+void LiveInput::setSlot(int newSlot)
+{
+	slot = jlimit(0, (int) SamplePool::NumberOfSlots - 1, newSlot);
+}
+
+int LiveInput::getSlot() const
+{
+	return slot;
+}
+
+void LiveInput::setRecording(bool shouldRecord)
+{
+	recording = shouldRecord;
+}
+
+bool LiveInput::isRecording() const
+{
+	return recording;
+}
+
+int LiveInput::collectEvents(double sampleRate, int numSamples) noexcept
+{
+	const double now = Time::getMillisecondCounterHiRes() * 0.001;
+
+	int start1, size1, start2, size2;
+	eventFifo.prepareToRead(jmin(eventFifo.getNumReady(), (int) MaximumEventsPerBlock), start1, size1, start2, size2);
+	int numEvents = 0;
+	for (int i = 0; i < size1 + size2; i++)
+	{
+		Event event = queuedEvents[(size_t) (i < size1 ? start1 + i : start2 + i - size1)];
+
+		//a note is played a block after it arrived, at the offset it arrived at - anything older starts the block
+		event.sampleOffset = jlimit(0, numSamples - 1, numSamples - roundToInt((now - event.time) * sampleRate));
+
+		//the device threads and the keyboard queue their notes separately, so a few may arrive out of order
+		int position = numEvents++;
+		while (position > 0 && blockEvents[(size_t) (position - 1)].sampleOffset > event.sampleOffset)
+		{
+			blockEvents[(size_t) position] = blockEvents[(size_t) (position - 1)];
+			position--;
+		}
+		blockEvents[(size_t) position] = event;
+	}
+	eventFifo.finishedRead(size1 + size2);
+	return numEvents;
+}
+
+const LiveInput::Event& LiveInput::getEvent(int index) const noexcept
+{
+	jassert(isPositiveAndBelow(index, (int) MaximumEventsPerBlock));
+	return blockEvents[(size_t) index];
+}
+
+void LiveInput::recordNote(const RecordedNote& note) noexcept
+{
+	int start1, size1, start2, size2;
+	recordedFifo.prepareToWrite(1, start1, size1, start2, size2);
+	if (size1 > 0)
+	{
+		recordedNotes[(size_t) start1] = note;
+		recordedFifo.finishedWrite(1);
+	}
+}
+
+bool LiveInput::takeRecordedNote(RecordedNote& note)
+{
+	int start1, size1, start2, size2;
+	recordedFifo.prepareToRead(1, start1, size1, start2, size2);
+	if (size1 == 0)
+	{
+		return false;
+	}
+	note = recordedNotes[(size_t) start1];
+	recordedFifo.finishedRead(1);
+	return true;
+}
+
+void LiveInput::handleIncomingMidiMessage(MidiInput* source, const MidiMessage& message)
+{
+	ignoreUnused(source);
+
+	//devices stamp their messages on the same clock, but a message passed on without a stamp is taken as arriving now
+	const double time = message.getTimeStamp() > 0.0 ? message.getTimeStamp() : Time::getMillisecondCounterHiRes() * 0.001;
+	if (message.isNoteOn())
+	{
+		queueNote(message.getChannel(), message.getNoteNumber(), message.getFloatVelocity(), true, time);
+	}
+	else if (message.isNoteOff())
+	{
+		queueNote(message.getChannel(), message.getNoteNumber(), 0.f, false, time);
+	}
+}
+
+void LiveInput::handleNoteOn(MidiKeyboardState* source, int midiChannel, int midiNoteNumber, float velocity)
+{
+	ignoreUnused(source);
+	queueNote(midiChannel, midiNoteNumber, velocity, true, Time::getMillisecondCounterHiRes() * 0.001);
+}
+
+void LiveInput::handleNoteOff(MidiKeyboardState* source, int midiChannel, int midiNoteNumber, float velocity)
+{
+	ignoreUnused(source, velocity);
+	queueNote(midiChannel, midiNoteNumber, 0.f, false, Time::getMillisecondCounterHiRes() * 0.001);
+}
+
+void LiveInput::queueNote(int midiChannel, int note, float velocity, bool isNoteOn, double time)
+{
+	Event event;
+	event.time = time;
+	event.channel = jlimit(1, 16, midiChannel);
+	event.slot = (slot.load(std::memory_order_relaxed) + jmax(0, midiChannel - 1)) % (int) SamplePool::NumberOfSlots;
+	event.note = note;
+	event.gain = velocity;
+	event.isNoteOn = isNoteOn;
+
+	//only the threads adding notes take the lock - the audio thread reads the queue without it
+	const SpinLock::ScopedLockType sl(queueLock);
+	int start1, size1, start2, size2;
+	eventFifo.prepareToWrite(1, start1, size1, start2, size2);
+	if (size1 > 0)
+	{
+		queuedEvents[(size_t) start1] = event;
+		eventFifo.finishedWrite(1);
+	}
+}
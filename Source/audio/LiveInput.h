@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+	LiveInput.h
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include "fileaudio/SamplePool.h"
+
+/** Collects the notes played live - from any enabled MIDI input device, or from the on-screen keyboard through its
+	MidiKeyboardState - and hands them to the audio thread through a lock-free queue. Each note is stamped with the
+	time it arrived, and the audio thread plays it one block later at the same offset it arrived at within the block
+	before, so the latency is fixed and notes keep their spacing to the sample rather than bunching at the start of a
+	block. The devices and the keyboard share a spin lock to add notes; the audio thread never waits on it.
+	Notes the audio thread records into the song are handed back to the message thread through a second queue. */
+
+class LiveInput		:	public MidiInputCallback,
+						public MidiKeyboardStateListener
+{
+public:
+	/** Constructor. */
+	LiveInput();
+
+	/** Destructor. */
+	~LiveInput();
+
+	/** Holds the number of notes each queue can hold, and the most the audio thread takes in one block - any left
+		over are played at the start of the next. */
+	enum
+	{
+		QueueSize = 512,
+		MaximumEventsPerBlock = 128
+	};
+
+	/** A note starting or ending, as taken by the audio thread. */
+	struct Event
+	{
+		/** Time the note arrived, in seconds on the Time::getMillisecondCounterHiRes() clock. */
+		double time = 0.0;
+		/** Sample of the block the note plays on, set when the audio thread takes it. */
+		int sampleOffset = 0;
+		/** MIDI channel of the note, from 1 to 16. */
+		int channel = 1;
+		/** Sample slot the note plays. */
+		int slot = 0;
+		/** MIDI note number. */
+		int note = 60;
+		/** Gain from the note's velocity, in the range 0 to 1. */
+		float gain = 1.f;
+		/** True for a note on, false for a note off. */
+		bool isNoteOn = true;
+	};
+
+	/** A note played while recording, and the row of the song it falls in. */
+	struct RecordedNote
+	{
+		int pattern = 0;
+		int row = 0;
+		int slot = 0;
+		int note = 60;
+		float gain = 1.f;
+	};
+
+	/** Sets the sample slot notes on MIDI channel 1 play - each channel above it plays the slot after. Safe to call
+		from any thread.
+		@param	int slot in the range of SamplePool::NumberOfSlots */
+	void setSlot(int newSlot);
+
+	/** Returns the sample slot notes on MIDI channel 1 play. Safe to call from any thread. */
+	int getSlot() const;
+
+	/** Sets whether the notes played are written into the song while it plays. Safe to call from any thread.
+		@param	bool true to record */
+	void setRecording(bool shouldRecord);
+
+	/** Returns true if the notes played are written into the song while it plays. Safe to call from any thread. */
+	bool isRecording() const;
+
+	/** Returns the state an on-screen MidiKeyboardComponent should show - notes played on it are queued like any other.
+		@return	reference to the MidiKeyboardState held by this object */
+	MidiKeyboardState& getKeyboardState() { return keyboardState; }
+
+	/** Takes the notes that have arrived since the last block, and works out the sample of this block each plays on.
+		Should only be called from the audio thread, once at the start of each block.
+		@param	double output sample rate
+		@param	int number of samples in the block
+		@return	int number of notes taken, in the order they play - read them with getEvent() */
+	int collectEvents(double sampleRate, int numSamples) noexcept;
+
+	/** Returns one of the notes taken by the last call to collectEvents(). Should only be called from the audio thread.
+		@param	int index in the range of the number of notes taken */
+	const Event& getEvent(int index) const noexcept;
+
+	/** Queues a note played while recording, for the message thread to write into the song. Should only be called
+		from the audio thread. The note is dropped if the queue is full.
+		@param	RecordedNote to queue */
+	void recordNote(const RecordedNote& note) noexcept;
+
+	/** Takes the next note recorded by the audio thread. Should only be called from the message thread.
+		@param	reference to a RecordedNote to fill
+		@return	bool false if no note is waiting */
+	bool takeRecordedNote(RecordedNote& note);
+
+	//MidiInputCallback
+	/** Overridden function inherited from MidiInputCallback. Queues the note ons and offs that arrive from a device. */
+	void handleIncomingMidiMessage(MidiInput* source, const MidiMessage& message) override;
+
+	//MidiKeyboardStateListener
+	/** Overridden function inherited from MidiKeyboardStateListener. Queues a note pressed on the on-screen keyboard. */
+	void handleNoteOn(MidiKeyboardState* source, int midiChannel, int midiNoteNumber, float velocity) override;
+	/** Overridden function inherited from MidiKeyboardStateListener. Queues a note released on the on-screen keyboard. */
+	void handleNoteOff(MidiKeyboardState* source, int midiChannel, int midiNoteNumber, float velocity) override;
+
+private:
+	/** Adds a note to the queue for the audio thread, dropping it if the queue is full.
+		@param	int MIDI channel of the note, from 1 to 16
+		@param	int MIDI note number
+		@param	float velocity, 0 for a note off
+		@param	bool true for a note on
+		@param	double time the note arrived, in seconds on the Time::getMillisecondCounterHiRes() clock */
+	void queueNote(int midiChannel, int note, float velocity, bool isNoteOn, double time);
+
+	std::atomic<int> slot;
+	std::atomic<bool> recording;
+	MidiKeyboardState keyboardState;
+
+	SpinLock queueLock;
+	AbstractFifo eventFifo;
+	std::array<Event, QueueSize> queuedEvents;
+	std::array<Event, MaximumEventsPerBlock> blockEvents;
+
+	AbstractFifo recordedFifo;
+	std::array<RecordedNote, QueueSize> recordedNotes;
+
+	JUCE_DECLARE_NON_COPYABLE(LiveInput)
+};
@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+	MidiClockOutput.cpp
+  ==============================================================================
+*/
+
+#include "MidiClockOutput.h"
+
+/** The share of the difference between the predicted and measured start of a block that each block corrects by -
+	small enough to smooth out the callbacks' jitter, large enough to follow the audio clock as it drifts. */
+static const double blockTimeCorrection = 1.0 / 64.0;
+
+MidiClockOutput::MidiClockOutput()		:	latencySamples(0),
+											blockSampleRate(44100.0),
+											blockStartTime(0.0),
+											nextBlockStartTime(0.0),
+											started(false)
+{
+	messages.ensureSize(ReservedBytesPerBlock);
+}
+
+MidiClockOutput::~MidiClockOutput()
+{
+
+}
+
+std::unique_ptr<MidiOutput> MidiClockOutput::setOutput(std::unique_ptr<MidiOutput> newOutput)
+{
+	//the output sends each block from a thread of its own, at the times the messages fall on
+	if (newOutput != nullptr)
+	{
+		newOutput->startBackgroundThread();
+	}
+	std::swap(output, newOutput);
+	return newOutput;
+}
+
+String MidiClockOutput::getOutputIdentifier() const
+{
+	return output != nullptr ? output->getIdentifier() : String();
+}
+
+void MidiClockOutput::setLatency(int samples)
+{
+	latencySamples = jmax(0, samples);
+}
+
+void MidiClockOutput::beginBlock(double sampleRate, int numSamples) noexcept
+{
+	messages.clear();
+	blockSampleRate = sampleRate;
+
+	//a block arriving far from where it was predicted follows a gap in the audio - the prediction starts again from it
+	const double now = Time::getMillisecondCounterHiRes();
+	const double blockLength = numSamples * 1000.0 / sampleRate;
+	const double error = now - nextBlockStartTime;
+	if (nextBlockStartTime > 0.0 && std::abs(error) < blockLength)
+	{
+		blockStartTime = nextBlockStartTime + error * blockTimeCorrection;
+	}
+	else
+	{
+		blockStartTime = now;
+	}
+	nextBlockStartTime = blockStartTime + blockLength;
+}
+
+void MidiClockOutput::start(int sampleOffset) noexcept
+{
+	if (!started)
+	{
+		//playback always starts from the top of the song
+		messages.addEvent(MidiMessage::songPositionPointer(0), sampleOffset);
+		messages.addEvent(MidiMessage::midiStart(), sampleOffset);
+		started = true;
+	}
+}
+
+void MidiClockOutput::stop(int sampleOffset) noexcept
+{
+	if (started)
+	{
+		messages.addEvent(MidiMessage::midiStop(), sampleOffset);
+		started = false;
+	}
+}
+
+void MidiClockOutput::addClock(int sampleOffset) noexcept
+{
+	messages.addEvent(MidiMessage::midiClock(), sampleOffset);
+}
+
+void MidiClockOutput::endBlock() noexcept
+{
+	if (output != nullptr && !messages.isEmpty())
+	{
+		output->sendBlockOfMessages(messages, blockStartTime + latencySamples * 1000.0 / blockSampleRate, blockSampleRate);
+	}
+}
+
+void MidiClockOutput::reset()
+{
+	if (started && output != nullptr)
+	{
+		output->sendMessageNow(MidiMessage::midiStop());
+	}
+	started = false;
+	nextBlockStartTime = 0.0;
+}
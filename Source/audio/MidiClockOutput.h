@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+	MidiClockOutput.h
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <memory>
+
+/** Sends MIDI clock, start, stop and song position messages to a MIDI output, so other gear and software can follow
+	the song. The audio thread adds each message at the sample of the block it falls on, and the block is handed to
+	the output to be sent at those times, a fixed latency after the block started - the audio the block holds is
+	heard at about the same time. The start of each block is predicted from the one before and only nudged towards
+	the time the callback actually ran, so the messages keep the spacing of the samples they fall on rather than
+	picking up the scheduling jitter of the callbacks. */
+
+class MidiClockOutput
+{
+public:
+	/** Constructor. */
+	MidiClockOutput();
+
+	/** Destructor. */
+	~MidiClockOutput();
+
+	/** Holds the room kept for the messages of one block, in bytes - enough for every clock of a long block at a fast tempo. */
+	enum
+	{
+		ReservedBytesPerBlock = 4096
+	};
+
+	/** Replaces the output the messages are sent to. Must not be called while the audio thread is using this object -
+		hold the audio callback lock.
+		@param	std::unique_ptr to the MidiOutput to send to, or nullptr to send nothing
+		@return	std::unique_ptr to the output replaced, to be closed once the lock is released */
+	std::unique_ptr<MidiOutput> setOutput(std::unique_ptr<MidiOutput> newOutput);
+
+	/** Returns the identifier of the output the messages are sent to, or an empty string if there is none.
+		Should only be called from the message thread. */
+	String getOutputIdentifier() const;
+
+	/** Sets how long after the start of a block its messages are sent. Should be called before the audio device starts.
+		@param	int latency in samples - the block size plus the device's output latency keeps the messages with the audio */
+	void setLatency(int samples);
+
+	/** Starts a new block of messages. Should only be called from the audio thread, at the start of each callback.
+		@param	double output sample rate
+		@param	int number of samples in the block */
+	void beginBlock(double sampleRate, int numSamples) noexcept;
+
+	/** Adds a song position of the start of the song, followed by a start message. Does nothing if already started.
+		Should only be called from the audio thread.
+		@param	int sample of the block the song starts on */
+	void start(int sampleOffset) noexcept;
+
+	/** Adds a stop message. Does nothing if not started. Should only be called from the audio thread.
+		@param	int sample of the block the song stops on */
+	void stop(int sampleOffset) noexcept;
+
+	/** Returns true if a start message has been sent without a stop message after it. */
+	bool isStarted() const noexcept { return started; }
+
+	/** Adds a clock pulse. Should only be called from the audio thread.
+		@param	int sample of the block the pulse falls on */
+	void addClock(int sampleOffset) noexcept;
+
+	/** Hands the messages of the block to the output, to be sent at the samples they were added at. Should only be
+		called from the audio thread, at the end of each callback. */
+	void endBlock() noexcept;
+
+	/** Sends a stop message straight away if started, and forgets the timing of the last block. Called when the audio
+		device stops. */
+	void reset();
+
+private:
+	std::unique_ptr<MidiOutput> output;
+	MidiBuffer messages;
+	int latencySamples;
+	double blockSampleRate;
+	double blockStartTime;
+	double nextBlockStartTime;
+	bool started;
+
+	JUCE_DECLARE_NON_COPYABLE(MidiClockOutput)
+};
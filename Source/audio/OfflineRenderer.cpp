@@ -0,0 +1,359 @@
+/*
+  ==============================================================================
+	OfflineRenderer.cpp
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+
+/** Renders a set of channels of the song into a buffer of its own, on a thread of the OfflineRenderer's ThreadPool. */
+
+class OfflineRenderer::ChannelJob		:	public ThreadPoolJob
+{
+public:
+	/** Constructor.
+		@param	reference to the OfflineRenderer holding the song and samples to render
+		@param	int index of this job, used for its name
+		@param	Settings to render with
+		@param	int number of samples the passes of the song last for
+		@param	int number of samples to allocate, including room for notes to ring on after the song */
+	ChannelJob(OfflineRenderer& r, int index, const Settings& s, int songLength, int bufferLength)
+																:	ThreadPoolJob("Render Job " + String(index + 1)),
+																	renderer(r),
+																	settings(s),
+																	songLengthInSamples(songLength),
+																	renderedLength(0),
+																	buffer(2, bufferLength)
+	{
+		buffer.clear();
+		rendersChannel.fill(false);
+	}
+
+	/** Adds a channel of the song to the ones this job renders. Only call this before the job is started.
+		@param	int channel in the range of the song's channels */
+	void addChannel(int channel) noexcept
+	{
+		rendersChannel[(size_t) channel] = true;
+	}
+
+	/** Returns the rendered audio. */
+	const AudioBuffer<float>& getBuffer() const noexcept { return buffer; }
+
+	/** Returns the number of samples rendered, including any notes left ringing after the song. */
+	int getRenderedLength() const noexcept { return renderedLength; }
+
+	//ThreadPoolJob
+	/** Overridden function inherited from ThreadPoolJob. Steps a Sequencer through the passes of the song in blocks,
+		starting the events of this job's channels on a VoicePool at their exact sample and applying their effects on
+		every tick, then lets the voices ring out. */
+	JobStatus runJob() override
+	{
+		//the VoicePool plays from the renderer's copy of the samples, so the live SamplePool is never touched
+		voicePool.setSamples(renderer.samples);
+		voicePool.setInterpolationMode(renderer.interpolationMode);
+		for (int slot = 0; slot < SamplePool::NumberOfSlots; slot++)
+		{
+			voicePool.setSlotLooping(slot, renderer.slotLooping[(size_t) slot]);
+			//streamed files play on a single transport when live, so each trigger cuts off the last
+			voicePool.setSlotMonophonic(slot, renderer.streamedFiles[(size_t) slot] != File());
+		}
+		voicePool.prepareToPlay(BlockSize, settings.sampleRate);
+		effectEngine.setVoicePool(&voicePool);
+
+		const double samplesPerRow = Sequencer::getSamplesPerRow(settings.sampleRate, renderer.bpm);
+		const int orderLength = renderer.song->getOrderLength();
+		const int numRows = renderer.song->getNumRows();
+		Sequencer sequencer;
+		sequencer.reset(true);
+
+		//the blocks are split at every tick boundary exactly as Audio::audioDeviceIOCallback splits them
+		int position = 0;
+		while (position < songLengthInSamples)
+		{
+			if (shouldExit() || renderer.cancelled)
+			{
+				return jobHasFinished;
+			}
+
+			const int blockEnd = jmin(position + (int) BlockSize, songLengthInSamples);
+			const int blockStart = position;
+			while (position < blockEnd)
+			{
+				Sequencer::Position startingPosition;
+				const int samplesToRender = sequencer.advance(blockEnd - position, samplesPerRow, renderer.ticksPerRow, renderer.groove,
+																orderLength, numRows, startingPosition);
+				if (startingPosition.tick == 0)
+				{
+					triggerRow(startingPosition);
+				}
+				if (startingPosition.tick >= 0)
+				{
+					effectEngine.processTick(startingPosition.tick);
+				}
+
+				voicePool.getNextAudioBlock(AudioSourceChannelInfo(&buffer, position, samplesToRender));
+				position += samplesToRender;
+			}
+			renderer.samplesRendered += position - blockStart;
+		}
+
+		//lets the last notes ring out, up to the end of the buffer
+		while (position < buffer.getNumSamples() && isAnySlotPlaying())
+		{
+			if (shouldExit() || renderer.cancelled)
+			{
+				return jobHasFinished;
+			}
+
+			const int samplesToRender = jmin((int) BlockSize, buffer.getNumSamples() - position);
+			voicePool.getNextAudioBlock(AudioSourceChannelInfo(&buffer, position, samplesToRender));
+			position += samplesToRender;
+		}
+
+		renderedLength = position;
+		voicePool.releaseResources();
+		return jobHasFinished;
+	}
+
+private:
+	/** Passes the events of this job's channels in the given row of the song to its EffectEngine.
+		@param	Sequencer::Position of the row to trigger */
+	void triggerRow(const Sequencer::Position& position)
+	{
+		effectEngine.beginRow();
+		const Song& song = *renderer.song;
+		for (auto& channelEvent : song.getPattern(song.getPatternAtOrder(position.order)).getRow(position.row))
+		{
+			if (rendersChannel[(size_t) channelEvent.channel])
+			{
+				effectEngine.triggerEvent(channelEvent.channel, channelEvent.event);
+			}
+		}
+	}
+
+	/** Returns true if any voice was still playing at the end of the last rendered block. */
+	bool isAnySlotPlaying() const
+	{
+		for (int slot = 0; slot < SamplePool::NumberOfSlots; slot++)
+		{
+			if (voicePool.isSlotPlaying(slot))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	OfflineRenderer& renderer;
+	std::array<bool, Pattern::MaximumNumberOfChannels> rendersChannel;
+	const Settings settings;
+	const int songLengthInSamples;
+	int renderedLength;
+	AudioBuffer<float> buffer;
+	VoicePool voicePool;
+	EffectEngine effectEngine;
+};
+
+OfflineRenderer::OfflineRenderer(Audio& audio)		:	song(audio.getSong()),
+														bpm(audio.getBpm()),
+														groove(audio.getGroove()),
+														ticksPerRow(audio.getTicksPerRow()),
+														interpolationMode(audio.getInterpolationMode()),
+														samplesRendered(0),
+														samplesToRender(0),
+														cancelled(false)
+{
+	//copies what every slot holds - streamed files are only noted here, and decoded when the render starts
+	for (int slot = 0; slot < SamplePool::NumberOfSlots; slot++)
+	{
+		FilePlayer* filePlayer = audio.getFilePlayer(slot);
+		samples[(size_t) slot] = audio.getPreloadedSample(slot);
+		slotLooping[(size_t) slot] = filePlayer->isLooping();
+		if (filePlayer->isStreaming())
+		{
+			streamedFiles[(size_t) slot] = filePlayer->getFile();
+		}
+	}
+}
+
+OfflineRenderer::~OfflineRenderer()
+{
+
+}
+
+Result OfflineRenderer::render(const File& masterFile, const Settings& settings, std::function<void(double)> progressCallback)
+{
+	cancelled = false;
+	samplesRendered = 0;
+
+	if (song == nullptr)
+	{
+		return Result::fail("There is no song to render");
+	}
+
+	auto result = decodeStreamedFiles();
+	if (result.failed())
+	{
+		return result;
+	}
+
+	const double samplesPerRow = Sequencer::getSamplesPerRow(settings.sampleRate, bpm);
+	const int numChannels = song->getNumChannels();
+	const int64 songLength = Sequencer::getLengthInSamples(samplesPerRow, groove, song->getNumRows(),
+															song->getOrderLength() * jmax(1, settings.numberOfPasses));
+	const int64 bufferLength = songLength + (int64) (settings.sampleRate * MaximumTailInSeconds);
+
+	//buffers are indexed with ints, so a render longer than that - many passes of a long, slow song - is refused
+	if (bufferLength > (int64) std::numeric_limits<int>::max())
+	{
+		return Result::fail("The song is too long to render - try fewer passes or a lower sample rate");
+	}
+
+	//stems need a buffer for every channel - otherwise the channels are shared between one job per core,
+	//so a wide song is not held in memory once per channel
+	const int numThreads = jmin(SystemStats::getNumCpus(), numChannels);
+	const int numJobs = settings.renderStems ? numChannels : numThreads;
+	samplesToRender = songLength * numJobs;
+
+	OwnedArray<ChannelJob> jobs;
+	try
+	{
+		for (int index = 0; index < numJobs; index++)
+		{
+			jobs.add(new ChannelJob(*this, index, settings, (int) songLength, (int) bufferLength));
+		}
+	}
+	catch (const std::bad_alloc&)
+	{
+		return Result::fail("There is not enough memory to render the song");
+	}
+	for (int channel = 0; channel < numChannels; channel++)
+	{
+		jobs[channel % numJobs]->addChannel(channel);
+	}
+
+	{
+		ThreadPool threadPool(numThreads);
+		for (auto* job : jobs)
+		{
+			threadPool.addJob(job, false);
+		}
+		for (auto* job : jobs)
+		{
+			//reports progress while waiting, so the caller can follow the render and cancel it
+			while (!threadPool.waitForJobToFinish(job, 50))
+			{
+				if (progressCallback != nullptr)
+				{
+					progressCallback(getProgress());
+				}
+			}
+		}
+	}
+
+	if (cancelled)
+	{
+		return Result::fail("The render was cancelled");
+	}
+
+	//the master mix is the sum of the jobs, as it is in the live ActiveVoiceMixer
+	int length = 0;
+	for (auto* job : jobs)
+	{
+		length = jmax(length, job->getRenderedLength());
+	}
+
+	AudioBuffer<float> master;
+	try
+	{
+		master.setSize(2, jmax(1, length));
+	}
+	catch (const std::bad_alloc&)
+	{
+		return Result::fail("There is not enough memory to render the song");
+	}
+	master.clear();
+	for (auto* job : jobs)
+	{
+		for (int channel = 0; channel < master.getNumChannels(); channel++)
+		{
+			master.addFrom(channel, 0, job->getBuffer(), channel, 0, length);
+		}
+	}
+
+	result = writeFile(master, length, masterFile, settings);
+	for (int channel = 0; result.wasOk() && settings.renderStems && channel < numChannels; channel++)
+	{
+		//each job renders one channel when rendering stems - every stem is as long as the master mix,
+		//so they line up when imported together
+		result = writeFile(jobs[channel]->getBuffer(), length, getStemFile(masterFile, channel), settings);
+	}
+	return result;
+}
+
+double OfflineRenderer::getProgress() const
+{
+	const int64 total = samplesToRender.load();
+	return total > 0 ? jlimit(0.0, 1.0, (double) samplesRendered.load() / (double) total) : 0.0;
+}
+
+void OfflineRenderer::cancel()
+{
+	cancelled = true;
+}
+
+File OfflineRenderer::getStemFile(const File& masterFile, int channel)
+{
+	return masterFile.getSiblingFile(masterFile.getFileNameWithoutExtension() + " - Channel " + String(channel + 1) + ".wav");
+}
+
+Result OfflineRenderer::decodeStreamedFiles()
+{
+	SharedResourcePointer<SampleFormatManager> formatManager;
+	for (int slot = 0; slot < SamplePool::NumberOfSlots; slot++)
+	{
+		const File& file = streamedFiles[(size_t) slot];
+		if (file == File())
+		{
+			continue;
+		}
+
+		std::unique_ptr<AudioFormatReader> reader(formatManager.createReaderFor(file));
+		if (reader == nullptr)
+		{
+			return Result::fail("Could not read " + file.getFullPathName());
+		}
+		samples[(size_t) slot] = new PooledSample(*reader);
+	}
+	return Result::ok();
+}
+
+Result OfflineRenderer::writeFile(const AudioBuffer<float>& buffer, int numSamples, const File& file, const Settings& settings)
+{
+	file.deleteFile();
+	auto stream = std::make_unique<FileOutputStream>(file);
+	if (!stream->openedOk())
+	{
+		return Result::fail("Could not open " + file.getFullPathName() + " for writing");
+	}
+
+	WavAudioFormat wavFormat;
+	std::unique_ptr<AudioFormatWriter> writer(wavFormat.createWriterFor(stream.get(),
+																		settings.sampleRate,
+																		(unsigned int) buffer.getNumChannels(),
+																		settings.bitDepth,
+																		{},
+																		0));
+	if (writer == nullptr)
+	{
+		return Result::fail("Could not create a WAV file at " + String(settings.bitDepth) + " bits");
+	}
+	//the writer now owns the stream
+	stream.release();
+
+	if (!writer->writeFromAudioSampleBuffer(buffer, 0, numSamples))
+	{
+		return Result::fail("Could not write to " + file.getFullPathName());
+	}
+	return Result::ok();
+}
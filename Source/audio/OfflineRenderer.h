@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+	OfflineRenderer.h
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include "Audio.h"
+
+/** Renders the current song to WAV files as fast as the CPU allows, without an audio device. The channels of the
+	song are shared between jobs on a ThreadPool, each with its own Sequencer and VoicePool, so channels are spread
+	across cores - when rendering stems each channel gets a job of its own. The master mix is the sum of the jobs -
+	the same triggering and voice code the live engine uses, so a bounce matches what is heard. Streamed files are decoded fully into memory for the render. */
+
+class OfflineRenderer
+{
+public:
+	/** Options for a render. */
+	struct Settings
+	{
+		/** Sample rate of the rendered files. */
+		double sampleRate = 44100.0;
+		/** Bit depth of the rendered files - 16, 24 or 32. */
+		int bitDepth = 24;
+		/** Number of times the order list of the song is played through. */
+		int numberOfPasses = 1;
+		/** True to write one file per channel alongside the master mix. */
+		bool renderStems = false;
+	};
+
+	/** Constructor. Takes a copy of the song, samples, tempo and playback settings the Audio object currently
+		holds, so the render is unaffected by edits made while it runs. Should only be called from the message thread.
+		@param	reference to the Audio object to render */
+	OfflineRenderer(Audio& audio);
+
+	/** Destructor. */
+	~OfflineRenderer();
+
+	/** Holds the size of each block rendered, and the longest a note may ring on after the last pass of the song. */
+	enum
+	{
+		BlockSize = 512,
+		MaximumTailInSeconds = 10
+	};
+
+	/** Renders the master mix to the given file, and each channel to a sibling file if stems are enabled, replacing
+		any files already there. Blocks until the render is finished - call from a background thread.
+		@param	File to write the master mix to
+		@param	Settings to render with
+		@param	function called regularly from the calling thread with the progress so far, in the range 0 to 1 - may be nullptr
+		@return	Result describing why the render failed, if it did */
+	Result render(const File& masterFile, const Settings& settings, std::function<void(double)> progressCallback);
+
+	/** Returns how far through the current render is, in the range 0 to 1. Safe to call from any thread. */
+	double getProgress() const;
+
+	/** Stops the current render as soon as possible. Files are only written once every channel has been rendered,
+		so a cancelled render leaves nothing behind unless it was already writing. Safe to call from any thread. */
+	void cancel();
+
+	/** Returns the file a channel's stem is written to for the given master file.
+		@param	File the master mix is written to
+		@param	int channel in the range of the song's channels */
+	static File getStemFile(const File& masterFile, int channel);
+
+private:
+	class ChannelJob;
+
+	/** Decodes every streamed file into memory, so every slot can be played by a VoicePool.
+		@return	Result describing why a file could not be decoded, if one could not */
+	Result decodeStreamedFiles();
+
+	/** Writes the given buffer to a WAV file, replacing any file already there.
+		@param	reference to the AudioBuffer to write
+		@param	int number of samples of the buffer to write
+		@param	File to write to
+		@param	Settings to write with
+		@return	Result describing why the file could not be written, if it could not */
+	static Result writeFile(const AudioBuffer<float>& buffer, int numSamples, const File& file, const Settings& settings);
+
+	Song::Ptr song;
+	double bpm;
+	Sequencer::Groove groove;
+	int ticksPerRow;
+	SampleInterpolator::Mode interpolationMode;
+	std::array<PooledSample::Ptr, SamplePool::NumberOfSlots> samples;
+	std::array<File, SamplePool::NumberOfSlots> streamedFiles;
+	std::array<bool, SamplePool::NumberOfSlots> slotLooping;
+
+	std::atomic<int64> samplesRendered;
+	std::atomic<int64> samplesToRender;
+	std::atomic<bool> cancelled;
+
+	JUCE_DECLARE_NON_COPYABLE(OfflineRenderer)
+};
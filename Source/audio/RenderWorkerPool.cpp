@@ -0,0 +1,214 @@
+/*
+  ==============================================================================
+	RenderWorkerPool.cpp
+  ==============================================================================
+*/
+
+#include "RenderWorkerPool.h"
+#include <thread>
+
+/** One thread of the pool, running the same task index every time it is woken. */
+
+class RenderWorkerPool::Worker		:	public Thread
+{
+public:
+	/** Constructor.
+		@param	reference to the RenderWorkerPool to take tasks from
+		@param	int index of the task this worker runs
+		@param	uint32 generation of the pool when the worker is made - only the generations after it have tasks to run */
+	Worker(RenderWorkerPool& p, int index, uint32 startGeneration)		:	Thread("Render Worker " + String(index)),
+																			pool(p),
+																			taskIndex(index),
+																			lastGeneration(startGeneration),
+																			claimedGeneration(startGeneration)
+	{
+
+	}
+
+	/** Returns the index of the task this worker runs. */
+	int getTaskIndex() const noexcept { return taskIndex; }
+
+	/** Claims this worker's task of the given generation, for whichever thread calls this first.
+		@param	uint32 generation of the run
+		@return	bool true if the caller should run the task */
+	bool claimTask(uint32 runGeneration) noexcept
+	{
+		uint32 claimed = claimedGeneration.load(std::memory_order_acquire);
+		return claimed != runGeneration && claimedGeneration.compare_exchange_strong(claimed, runGeneration, std::memory_order_acq_rel);
+	}
+
+	/** Wakes the worker if it is asleep, so it spins ready for the next run. Takes a lock, so should not be called
+		from the audio thread. */
+	void wake()
+	{
+		wakeUp.signal();
+	}
+
+	//Thread
+	/** Overridden function inherited from Thread. Waits for each new generation of the pool, claims and runs this
+		worker's task and counts itself off - spinning for a while after each run, then sleeping until woken. */
+	void run() override
+	{
+		while (!threadShouldExit())
+		{
+			//spins for a short while before yielding, so a block arriving straight after the last is picked up at once
+			int idleChecks = 0;
+			uint32 idleSince = Time::getMillisecondCounter();
+			uint32 currentGeneration = pool.generation.load(std::memory_order_acquire);
+			while (currentGeneration == lastGeneration && !threadShouldExit())
+			{
+				if (!pool.active.load(std::memory_order_relaxed)
+					|| (idleChecks > SpinsBeforeYielding && Time::getMillisecondCounter() - idleSince >= MillisecondsBeforeSleeping))
+				{
+					//the count is raised before the generation is checked again, so a run() starting now either sees it
+					//and runs every task itself, or is seen here. A run that slips in between is taken over once it waits too long
+					pool.workersParked.fetch_add(1);
+					const bool woken = pool.generation.load() == lastGeneration && wakeUp.wait(100);
+					pool.workersParked.fetch_sub(1);
+					if (woken)
+					{
+						idleChecks = 0;
+						idleSince = Time::getMillisecondCounter();
+					}
+				}
+				else if (++idleChecks > SpinsBeforeYielding)
+				{
+					std::this_thread::yield();
+				}
+				currentGeneration = pool.generation.load(std::memory_order_acquire);
+			}
+			if (currentGeneration == lastGeneration)
+			{
+				break;
+			}
+			lastGeneration = currentGeneration;
+
+			//the calling thread may already have taken the task over
+			if (claimTask(currentGeneration))
+			{
+				pool.currentTask(pool.currentContext, taskIndex);
+				pool.workersBusy.fetch_sub(1, std::memory_order_acq_rel);
+			}
+		}
+	}
+
+private:
+	/** Holds the number of checks made before the worker starts yielding between them, and how long it goes
+		without a run before it sleeps - longer than the gap between blocks, so it only sleeps once they stop. */
+	enum
+	{
+		SpinsBeforeYielding = 1000,
+		MillisecondsBeforeSleeping = 500
+	};
+
+	RenderWorkerPool& pool;
+	const int taskIndex;
+	uint32 lastGeneration;
+	std::atomic<uint32> claimedGeneration;
+	WaitableEvent wakeUp;
+};
+
+RenderWorkerPool::RenderWorkerPool(int numberOfWorkers)		:	generation(0),
+																workersBusy(0),
+																workersParked(0),
+																wakeRequested(false),
+																active(false)
+{
+	//each worker is given the generation now, rather than reading it once it first runs - a run() made before it is
+	//scheduled must still count as new to it
+	for (int i = 0; i < numberOfWorkers; i++)
+	{
+		workers.push_back(std::make_unique<Worker>(*this, i + 1, generation.load()));
+		workers.back()->startThread(10);
+	}
+}
+
+RenderWorkerPool::~RenderWorkerPool()
+{
+	for (auto& worker : workers)
+	{
+		worker->signalThreadShouldExit();
+		worker->wake();
+	}
+	for (auto& worker : workers)
+	{
+		worker->stopThread(1000);
+	}
+}
+
+int RenderWorkerPool::getDefaultNumberOfWorkers()
+{
+	return jlimit(0, (int) MaximumNumberOfWorkers, SystemStats::getNumCpus() - 1);
+}
+
+int RenderWorkerPool::getNumTasks() const noexcept
+{
+	return (int) workers.size() + 1;
+}
+
+void RenderWorkerPool::setActive(bool shouldBeActive)
+{
+	active = shouldBeActive;
+	//sleeping workers are woken to spin ready for the first block - inactive ones go back to sleep on their own
+	if (shouldBeActive)
+	{
+		for (auto& worker : workers)
+		{
+			worker->wake();
+		}
+	}
+}
+
+void RenderWorkerPool::wakeWorkersIfRequested()
+{
+	if (active.load() && wakeRequested.exchange(false))
+	{
+		for (auto& worker : workers)
+		{
+			worker->wake();
+		}
+	}
+}
+
+void RenderWorkerPool::run(Task task, void* context) noexcept
+{
+	//waking a sleeping worker takes a lock, so while any is asleep every task runs on this thread, and the message
+	//thread is asked to wake them for the blocks after this one. Running the tasks here alone is always correct
+	if (workers.empty() || !active.load(std::memory_order_relaxed) || workersParked.load() > 0)
+	{
+		if (!workers.empty())
+		{
+			wakeRequested.store(true, std::memory_order_relaxed);
+		}
+		for (int index = 0; index < getNumTasks(); index++)
+		{
+			task(context, index);
+		}
+		return;
+	}
+
+	//the task is published before the generation moves on, so a worker that sees the new generation sees the task
+	currentTask = task;
+	currentContext = context;
+	workersBusy.store((int) workers.size(), std::memory_order_relaxed);
+	const uint32 runGeneration = generation.fetch_add(1) + 1;
+
+	task(context, 0);
+
+	//the barrier - every worker counts itself off once its task is done. Tasks still unclaimed after a while belong to
+	//workers that are asleep or not scheduled, so they are run here instead, and the wait is bounded by the tasks themselves
+	for (int checks = 0; workersBusy.load(std::memory_order_acquire) > 0; checks++)
+	{
+		if (checks == ChecksBeforeTakingOver)
+		{
+			for (auto& worker : workers)
+			{
+				if (worker->claimTask(runGeneration))
+				{
+					task(context, worker->getTaskIndex());
+					workersBusy.fetch_sub(1, std::memory_order_acq_rel);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+	RenderWorkerPool.h
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/** A fixed set of threads, started up front, that the audio thread can hand part of each block to. The audio thread
+	wakes every worker by bumping a generation counter, runs the first task itself, then waits on a count of the
+	workers still busy - a barrier made only of atomics, so the callback never locks or allocates. Each worker claims
+	its task before running it, and any task not claimed by the time the wait runs long is claimed and run by the
+	audio thread instead, so the wait is bounded by the tasks however the workers are scheduled.
+	While active the workers spin between runs, yielding between checks, so they answer within microseconds; once no
+	run has come for a while, or while the pool is inactive, they sleep. Waking a worker takes a lock, so the audio
+	thread never does it - while any worker sleeps, run() does every task itself and leaves a request that the message
+	thread answers through wakeWorkersIfRequested(). Task i normally runs on the same thread, so work split the same
+	way lands the same way. */
+
+class RenderWorkerPool
+{
+public:
+	/** A task run on every thread of the pool at once.
+		@param	pointer to the context passed to run()
+		@param	int index of the task, 0 for the thread that called run() */
+	typedef void (*Task)(void* context, int taskIndex);
+
+	/** Constructor. Starts the workers, inactive. Should only be called from the message thread.
+		@param	int number of worker threads, not counting the thread that calls run() */
+	RenderWorkerPool(int numberOfWorkers);
+
+	/** Destructor. Stops every worker. Must not be called while run() is running. */
+	~RenderWorkerPool();
+
+	/** Returns the number of workers to use by default - one for every core but the audio thread's, at most MaximumNumberOfWorkers. */
+	static int getDefaultNumberOfWorkers();
+
+	/** Holds the most workers a pool is given by default. */
+	enum
+	{
+		MaximumNumberOfWorkers = 7
+	};
+
+	/** Returns the number of tasks each call to run() can split work into - the workers, plus the calling thread. */
+	int getNumTasks() const noexcept;
+
+	/** Wakes the workers so they spin, ready for run(), or lets them sleep straight away. Call with true before the audio device
+		starts calling back, and with false once it has stopped. Should not be called from the audio thread.
+		@param	bool true to keep the workers ready */
+	void setActive(bool shouldBeActive);
+
+	/** Wakes the sleeping workers if a run since the last call had to do every task itself because some were asleep.
+		Should be called regularly from the message thread while the pool is active, never from the audio thread. */
+	void wakeWorkersIfRequested();
+
+	/** Runs a task with every index from 0 to getNumTasks() - 1 at once, index 0 on the calling thread and each other
+		index on its own worker, and returns once they have all finished - or runs them all on the calling thread while
+		the pool is inactive or a worker is asleep. Never locks or allocates. Should only be
+		called from one thread at a time, while the pool is active.
+		@param	Task to run
+		@param	pointer to the context passed to the task */
+	void run(Task task, void* context) noexcept;
+
+private:
+	class Worker;
+
+	/** Holds the number of checks of the barrier the calling thread makes before it runs the tasks no worker has claimed. */
+	enum
+	{
+		ChecksBeforeTakingOver = 10000
+	};
+
+	Task currentTask	{	nullptr	};
+	void* currentContext	{	nullptr	};
+	std::atomic<uint32> generation;
+	std::atomic<int> workersBusy;
+	std::atomic<int> workersParked;
+	std::atomic<bool> wakeRequested;
+	std::atomic<bool> active;
+	std::vector<std::unique_ptr<Worker>> workers;
+
+	JUCE_DECLARE_NON_COPYABLE(RenderWorkerPool)
+};
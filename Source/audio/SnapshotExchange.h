@@ -0,0 +1,142 @@
+/*
+  ==============================================================================
+	SnapshotExchange.h
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+/** Hands immutable, reference counted snapshots from the message thread to the audio thread without locks.
+	The message thread builds a new object and publishes it; the audio thread picks it up with a single atomic
+	exchange at the start of its next callback. Snapshots replaced on the audio thread are passed back through
+	a FIFO and released by the message thread in collectGarbage(), so the audio thread never frees memory.
+	ObjectType must inherit from ReferenceCountedObject. */
+
+template <typename ObjectType>
+class SnapshotExchange
+{
+public:
+	typedef ReferenceCountedObjectPtr<ObjectType> ObjectPtr;
+
+	/** Constructor. */
+	SnapshotExchange()		:	retiredFifo(RetiredCapacity)
+	{
+		retired.fill(nullptr);
+	}
+
+	/** Destructor. Releases every snapshot still held - the audio thread must no longer be calling acquire(). */
+	~SnapshotExchange()
+	{
+		collectGarbage();
+
+		if (auto* unclaimed = pending.exchange(nullptr))
+		{
+			unclaimed->decReferenceCount();
+		}
+		if (live != nullptr)
+		{
+			live->decReferenceCount();
+		}
+	}
+
+	/** Holds the number of replaced snapshots that can wait for collectGarbage() before the audio thread
+		stops picking up new ones. */
+	enum
+	{
+		RetiredCapacity = 32
+	};
+
+	/** Publishes a new snapshot for the audio thread to pick up. Should only be called from the message thread.
+		If the previous snapshot was never picked up it is released straight away, as the audio thread has not seen it.
+		@param	ObjectPtr new snapshot, must not be nullptr
+		@see	acquire */
+	void publish(ObjectPtr newObject)
+	{
+		jassert(newObject != nullptr);
+
+		//the reference added here belongs to the audio side and is only dropped in collectGarbage()
+		newObject->incReferenceCount();
+		if (auto* unclaimed = pending.exchange(newObject.get()))
+		{
+			unclaimed->decReferenceCount();
+		}
+		latest = newObject;
+
+		collectGarbage();
+	}
+
+	/** Returns the most recently published snapshot. Should only be called from the message thread.
+		@return	ObjectPtr to the latest snapshot, or nullptr if nothing has been published */
+	ObjectPtr getLatest() const
+	{
+		return latest;
+	}
+
+	/** Swaps in the most recently published snapshot if there is one, and returns the snapshot the audio thread
+		should use for this callback. Never blocks or allocates. Should only be called from the audio thread.
+		@return	pointer to the current snapshot, or nullptr if nothing has been published */
+	ObjectType* acquire() noexcept
+	{
+		//only take a new snapshot if the old one can be handed back, otherwise keep the old one for another block
+		if (retiredFifo.getFreeSpace() > 0)
+		{
+			if (auto* incoming = pending.exchange(nullptr))
+			{
+				if (live != nullptr)
+				{
+					int start1, size1, start2, size2;
+					retiredFifo.prepareToWrite(1, start1, size1, start2, size2);
+					retired[(size_t) (size1 > 0 ? start1 : start2)] = live;
+					retiredFifo.finishedWrite(1);
+				}
+				live = incoming;
+			}
+		}
+		return live;
+	}
+
+	/** Returns the snapshot picked up by the last call to acquire(). Should only be called from the audio thread.
+		@return	pointer to the current snapshot, or nullptr if nothing has been acquired */
+	ObjectType* getLive() const noexcept
+	{
+		return live;
+	}
+
+	/** Releases the snapshots the audio thread has finished with. Should only be called from the message thread. */
+	void collectGarbage()
+	{
+		int start1, size1, start2, size2;
+		retiredFifo.prepareToRead(retiredFifo.getNumReady(), start1, size1, start2, size2);
+
+		for (int i = 0; i < size1; i++)
+		{
+			release(start1 + i);
+		}
+		for (int i = 0; i < size2; i++)
+		{
+			release(start2 + i);
+		}
+		retiredFifo.finishedRead(size1 + size2);
+	}
+
+private:
+	void release(int retiredIndex)
+	{
+		auto*& object = retired[(size_t) retiredIndex];
+		object->decReferenceCount();
+		object = nullptr;
+	}
+
+	std::atomic<ObjectType*> pending	{	nullptr	};
+	ObjectType* live					{	nullptr	};
+	ObjectPtr latest;
+
+	AbstractFifo retiredFifo;
+	std::array<ObjectType*, RetiredCapacity> retired;
+
+	JUCE_DECLARE_NON_COPYABLE(SnapshotExchange)
+};
@@ -0,0 +1,43 @@
+/*
+  ==============================================================================
+	DiskStreamer.cpp
+  ==============================================================================
+*/
+
+#include "DiskStreamer.h"
+
+DiskStreamer::DiskStreamer()
+{
+	for (int i = 0; i < NumberOfThreads; i++)
+	{
+		threads[(size_t) i] = std::make_unique<TimeSliceThread>("DiskStreamThread" + String(i));
+	}
+}
+
+DiskStreamer::~DiskStreamer()
+{
+	for (auto& thread : threads)
+	{
+		thread->stopThread(100);
+	}
+}
+
+TimeSliceThread& DiskStreamer::getThreadForNewStream()
+{
+	//finds the thread with the fewest streams registered with it
+	TimeSliceThread* leastBusy = threads[0].get();
+	for (auto& thread : threads)
+	{
+		if (thread->getNumClients() < leastBusy->getNumClients())
+		{
+			leastBusy = thread.get();
+		}
+	}
+
+	//threads are only started once a stream needs them, so nothing runs if every file is preloaded
+	if (!leastBusy->isThreadRunning())
+	{
+		leastBusy->startThread();
+	}
+	return *leastBusy;
+}
@@ -0,0 +1,44 @@
+/*
+  ==============================================================================
+	DiskStreamer.h
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+/** Shared disk-streaming service for every FilePlayer that streams its file rather than preloading it.
+	Owns a small fixed pool of TimeSliceThreads, started only once the first stream needs one, and hands
+	each new stream the thread with the fewest streams already registered.
+
+	Within a thread, streams are serviced in order of how soon they need more audio: a stream that has just
+	been started or retriggered has an empty read-ahead buffer and moves itself to the front of its thread's
+	queue, while streams with full buffers back off until they have room to read into. */
+
+class DiskStreamer
+{
+public:
+	/** Constructor. No threads are started until a stream asks for one. */
+	DiskStreamer();
+
+	/** Destructor. Every stream must have been removed from its thread before this is called. */
+	~DiskStreamer();
+
+	/** Holds the number of threads shared between all streams. */
+	enum
+	{
+		NumberOfThreads = 2
+	};
+
+	/** Returns the thread a new stream should register with - the one with the fewest streams -
+		starting it if it is not already running. Should only be called from the message thread.
+		@return	reference to the TimeSliceThread to pass to the stream */
+	TimeSliceThread& getThreadForNewStream();
+
+private:
+	std::array<std::unique_ptr<TimeSliceThread>, NumberOfThreads> threads;
+
+	JUCE_DECLARE_NON_COPYABLE(DiskStreamer)
+};
@@ -6,84 +6,260 @@
 
 #include "FilePlayer.h"
 
-FilePlayer::FilePlayer() : thread("FilePlayThread")
+/** Buffers a streamed file ahead on a DiskStreamer thread, and counts every block it has to play as silence
+	because the buffer has not caught up. Sits between the file and the AudioTransportSource, so it is only
+	called with the transport's lock held and can never be deleted mid-block. */
+
+class FilePlayer::ReadAheadMonitor		:	public PositionableAudioSource
+{
+public:
+	/** Constructor.
+		@param	pointer to the source to read ahead from, expected to outlive this object
+		@param	reference to the TimeSliceThread to read ahead on
+		@param	reference to the count to increment on every underrun */
+	ReadAheadMonitor(PositionableAudioSource* source, TimeSliceThread& thread, std::atomic<int>& underruns)
+																		:	bufferingAudioSource(source, thread, false, 32768, 2),
+																			underrunCount(underruns)
+	{
+
+	}
+
+	//PositionableAudioSource
+	void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override	{ bufferingAudioSource.prepareToPlay(samplesPerBlockExpected, sampleRate); }
+	void releaseResources() override											{ bufferingAudioSource.releaseResources(); }
+	void setNextReadPosition(int64 newPosition) override						{ bufferingAudioSource.setNextReadPosition(newPosition); }
+	int64 getNextReadPosition() const override									{ return bufferingAudioSource.getNextReadPosition(); }
+	int64 getTotalLength() const override										{ return bufferingAudioSource.getTotalLength(); }
+	bool isLooping() const override												{ return bufferingAudioSource.isLooping(); }
+	void setLooping(bool shouldLoop) override									{ bufferingAudioSource.setLooping(shouldLoop); }
+
+	void getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill) override
+	{
+		//a zero timeout only checks the buffer - it never waits on the disk thread
+		if (!bufferingAudioSource.waitForNextAudioBlockReady(bufferToFill, 0))
+		{
+			underrunCount.fetch_add(1, std::memory_order_relaxed);
+		}
+		bufferingAudioSource.getNextAudioBlock(bufferToFill);
+	}
+
+private:
+	BufferingAudioSource bufferingAudioSource;
+	std::atomic<int>& underrunCount;
+};
+
+FilePlayer::FilePlayer()		:	slotIndex(0),
+									pendingCommand(NoCommand),
+									latestStreamNote(0),
+									streamHalted(false),
+									haltStreamDue(false),
+									streamStartOffset(0),
+									streamSampleRate(44100.0),
+									appliedPlaybackRate(1.0),
+									underrunCount(0),
+									looping(false),
+									gain(1.f),
+									playbackRate(1.0)
 {
-	thread.startThread();
 	//plugs the AudioTransportSource into the ResamplingAudioSource - this will allow pitch control
 	resamplingAudioSource = std::make_unique<ResamplingAudioSource>(&audioTransportSource, false);
+	audioTransportSource.addChangeListener(this);
 }
 
 FilePlayer::~FilePlayer()
 {
 	//unloads the current file
+	audioTransportSource.removeChangeListener(this);
 	audioTransportSource.setSource(nullptr);
-	thread.stopThread(100);
+}
+
+void FilePlayer::setSamplePool(SamplePool* pool, int slot)
+{
+	samplePool = pool;
+	slotIndex = slot;
+}
+
+void FilePlayer::setDiskStreamer(DiskStreamer* streamer)
+{
+	diskStreamer = streamer;
+}
+
+void FilePlayer::setVoicePool(VoicePool* pool)
+{
+	voicePool = pool;
 }
 
 bool FilePlayer::isPlaying() const
 {
-	return audioTransportSource.isPlaying();
+	return (voicePool != nullptr && voicePool->isSlotPlaying(slotIndex)) || (audioTransportSource.isPlaying() && !streamHalted);
 }
 
 bool FilePlayer::isLooping()
 {
-	return currentAudioFileSource->isLooping();
+	return looping;
 }
 
 void FilePlayer::setPlaying(bool newState)
 {
-	if (newState == true)
+	//the voices and the transport belong to the audio thread - the latest command is passed on when this object renders its next block
+	pendingCommand = newState ? StartCommand : StopCommand;
+	if (newState)
 	{
-		audioTransportSource.setPosition(0.0);
-		audioTransportSource.start();
+		latestStreamNote.fetch_add(1);
 	}
-	else
+}
+
+uint32 FilePlayer::startStream(double rate, float newGain, int startOffset) noexcept
+{
+	playbackRate = rate;
+	gain = newGain;
+	streamStartOffset = jmax(0, startOffset);
+	pendingCommand = StartStreamCommand;
+	return latestStreamNote.fetch_add(1) + 1;
+}
+
+void FilePlayer::stopStream(uint32 note) noexcept
+{
+	//a note started since - by the song, another key or the interface - is left playing
+	if (note == latestStreamNote.load())
 	{
-		audioTransportSource.stop();
+		pendingCommand = StopStreamCommand;
 	}
 }
 
 void FilePlayer::setLooping(bool shouldLoop)
 {
-	currentAudioFileSource->setLooping(shouldLoop);
+	looping = shouldLoop;
+	if (voicePool != nullptr)
+	{
+		voicePool->setSlotLooping(slotIndex, shouldLoop);
+	}
+	if (currentAudioFileSource != nullptr)
+	{
+		currentAudioFileSource->setLooping(shouldLoop);
+	}
 }
 
 void FilePlayer::setGain(float g)
 {
-	audioTransportSource.setGain(g);
+	gain = g;
 }
 
 void FilePlayer::setPlaybackRate(double newRate)
 {
-	resamplingAudioSource->setResamplingRatio(newRate);
+	playbackRate = newRate;
 }
 
 void FilePlayer::loadFile(const File& newFile)
 {
-	//stops playback
-	setPlaying(false);
-	//unloads the previous file source and deletes it
-	audioTransportSource.setSource(nullptr);
+	//if the file can be read, a reader is created and either decoded into the SamplePool or streamed
+	std::unique_ptr<AudioFormatReader> reader(formatManager->createReaderFor(newFile));
+	if (reader != nullptr)
+	{
+		//short files are decoded into memory so they can be retriggered instantly
+		if (samplePool != nullptr && SamplePool::shouldPreload(*reader))
+		{
+			unloadStream();
+			loadedFile = newFile;
+			samplePool->loadSample(slotIndex, *reader);
+			return;
+		}
 
-	//creates a format manager and sets it up with the basic types (wav, ogg and aiff).
-	AudioFormatManager formatManager;
-	formatManager.registerBasicFormats();
+		loadStream(std::move(reader), newFile);
+	}
+	//a file that can't be read leaves the slot empty, rather than still playing the previous file
+	else
+	{
+		unloadStream();
+		loadedFile = newFile;
+		if (samplePool != nullptr)
+		{
+			samplePool->clearSample(slotIndex);
+		}
+	}
+}
 
-	//if the file can be read, a reader is created and passed to the AudioFormatReaderSource
-	if (auto reader = formatManager.createReaderFor(newFile))
+void FilePlayer::loadStream(std::unique_ptr<AudioFormatReader> reader, const File& newFile)
+{
+	jassert(reader != nullptr);
+	unloadStream();
+	loadedFile = newFile;
+
+	//long files are streamed - empty this object's slot in the pool so the previous file stops playing from it
+	if (samplePool != nullptr)
 	{
-		//reader is passed to the AudioFormatReaderSource currentAudioFileSource
-		//currentAudioFileSource is set to delete the reader when it goes out of scope - otherwise
-		//the reader will not be deleted
-		currentAudioFileSource = std::make_unique<AudioFormatReaderSource>(reader, true);
+		samplePool->clearSample(slotIndex);
+	}
 
-		//currentAudioFileSource is plugged into audioTransportSource
-		//it will buffer 32768 samples ahead
-		audioTransportSource.setSource(currentAudioFileSource.get(),
-										32768,
-										&thread,
-										reader->sampleRate);
+	//streaming needs a thread to read ahead on
+	if (diskStreamer == nullptr)
+	{
+		DBG("FilePlayer has no DiskStreamer to stream from");
+		return;
 	}
+
+	const double fileSampleRate = reader->sampleRate;
+
+	//reader is passed to the AudioFormatReaderSource currentAudioFileSource
+	//currentAudioFileSource is set to delete the reader when it goes out of scope - otherwise
+	//the reader will not be deleted
+	currentAudioFileSource = std::make_unique<AudioFormatReaderSource>(reader.release(), true);
+	currentAudioFileSource->setLooping(looping);
+
+	//currentAudioFileSource is plugged into audioTransportSource through a ReadAheadMonitor
+	//it will buffer 32768 samples ahead on the least busy of the DiskStreamer's threads
+	readAheadMonitor = std::make_unique<ReadAheadMonitor>(currentAudioFileSource.get(),
+														diskStreamer->getThreadForNewStream(),
+														underrunCount);
+	audioTransportSource.setSource(readAheadMonitor.get(),
+									0,
+									nullptr,
+									fileSampleRate);
+
+	//the transport runs for as long as the file is loaded, halted until a note starts it
+	streamSampleRate = fileSampleRate;
+	streamHalted = true;
+	audioTransportSource.start();
+}
+
+void FilePlayer::loadSample(PooledSample::Ptr sample, const File& originalFile)
+{
+	unloadStream();
+	loadedFile = originalFile;
+	if (samplePool != nullptr)
+	{
+		samplePool->setSample(slotIndex, sample);
+	}
+}
+
+void FilePlayer::unloadStream()
+{
+	//stops any voices playing the slot
+	setPlaying(false);
+	//unloads the previous file source and deletes it - setSource() stops the transport under its lock
+	audioTransportSource.setSource(nullptr);
+	readAheadMonitor = nullptr;
+	currentAudioFileSource = nullptr;
+}
+
+File FilePlayer::getFile() const
+{
+	return loadedFile;
+}
+
+bool FilePlayer::isStreaming() const
+{
+	return currentAudioFileSource != nullptr;
+}
+
+int FilePlayer::getUnderrunCount() const
+{
+	return underrunCount.load(std::memory_order_relaxed);
+}
+
+void FilePlayer::resetUnderrunCount()
+{
+	underrunCount = 0;
 }
 
 //AudioSource
@@ -99,5 +275,95 @@ void FilePlayer::releaseResources()
 
 void FilePlayer::getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill)
 {
+	processPendingCommand();
+
+	if (isStreamActive())
+	{
+		renderStream(bufferToFill);
+	}
+	else
+	{
+		bufferToFill.clearActiveBufferRegion();
+	}
+}
+
+void FilePlayer::processPendingCommand() noexcept
+{
+	const int command = pendingCommand.exchange(NoCommand);
+
+	//streamed files - the transport is already running, so a start only moves its read position and a stop is faded
+	//out by renderStream(). Neither starts or stops the transport, which would post a message or wait for a block
+	const bool streamLoaded = audioTransportSource.isPlaying();
+	if (command == StopCommand || command == StopStreamCommand)
+	{
+		haltStreamDue = streamLoaded && !streamHalted.load(std::memory_order_relaxed);
+	}
+	else if ((command == StartCommand || command == StartStreamCommand) && streamLoaded)
+	{
+		//drops any audio still held by the resampler, so the retriggered file starts on the next sample rendered
+		const int startOffset = command == StartStreamCommand ? streamStartOffset.load(std::memory_order_relaxed) : 0;
+		resamplingAudioSource->flushBuffers();
+		audioTransportSource.setPosition(startOffset / streamSampleRate.load(std::memory_order_relaxed));
+		haltStreamDue = false;
+		streamHalted.store(false, std::memory_order_relaxed);
+	}
+
+	//the rate and gain only reach the resampler and transport here, so their locks are only ever taken on this thread
+	const double rate = playbackRate.load(std::memory_order_relaxed);
+	if (rate != appliedPlaybackRate)
+	{
+		resamplingAudioSource->setResamplingRatio(rate);
+		appliedPlaybackRate = rate;
+	}
+	audioTransportSource.setGain(gain.load(std::memory_order_relaxed));
+
+	//preloaded files - the VoicePool renders after every FilePlayer's command, so a note started here is heard from this block
+	if (voicePool != nullptr)
+	{
+		if (command == StartCommand)
+		{
+			voicePool->startVoice(slotIndex, playbackRate, gain);
+		}
+		else if (command == StopCommand)
+		{
+			voicePool->stopSlot(slotIndex);
+		}
+	}
+}
+
+bool FilePlayer::isStreamActive() const noexcept
+{
+	return audioTransportSource.isPlaying() && !streamHalted.load(std::memory_order_relaxed);
+}
+
+void FilePlayer::renderStream(const AudioSourceChannelInfo& bufferToFill)
+{
+	//streamed files - this fills the whole region
 	resamplingAudioSource->getNextAudioBlock(bufferToFill);
-}
\ No newline at end of file
+
+	//a stop fades out over this block - the transport is never stopped here, as stop() waits for a block that only
+	//this thread can render. It is left halted, and not rendered again until a note starts it
+	if (haltStreamDue)
+	{
+		for (int channel = 0; channel < bufferToFill.buffer->getNumChannels(); channel++)
+		{
+			bufferToFill.buffer->applyGainRamp(channel, bufferToFill.startSample, bufferToFill.numSamples, 1.f, 0.f);
+		}
+		haltStreamDue = false;
+		streamHalted.store(true, std::memory_order_relaxed);
+	}
+}
+
+//ChangeListener
+void FilePlayer::changeListenerCallback(ChangeBroadcaster* source)
+{
+	ignoreUnused(source);
+
+	//the transport stops itself when a file that does not loop reaches its end - it is readied again straight away,
+	//halted, as starting it from the audio thread would post a message from there
+	if (readAheadMonitor != nullptr && !audioTransportSource.isPlaying())
+	{
+		streamHalted = true;
+		audioTransportSource.start();
+	}
+}
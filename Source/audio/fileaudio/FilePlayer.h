@@ -7,12 +7,23 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <atomic>
+#include "SamplePool.h"
+#include "VoicePool.h"
+#include "DiskStreamer.h"
+#include "SampleFormatManager.h"
 
-/** Streams audio from a file. Streams audio using an AudioFormatReaderSource into an AudioTransportSource,
-	into a ResamplingAudioSource to allow pitch control through changes in sampling rate. Files are
-	streamed on their own thread. */
+/** Plays audio from a file. Files short enough to be preloaded are decoded into this object's slot of the
+	SamplePool and played from memory by the shared VoicePool, so retriggering them never touches the disk
+	and never cuts off the previous note.
+	Longer files are streamed using an AudioFormatReaderSource into an AudioTransportSource, into a
+	ResamplingAudioSource to allow pitch control through changes in sampling rate. Files are
+	streamed on a thread shared with other FilePlayers, provided by a DiskStreamer. The transport is started as soon
+	as a file is loaded and left running - notes are started and stopped by commands this object applies in its own
+	render call, so the audio thread never waits on the transport or has it post a message. */
 
-class FilePlayer		:	public AudioSource
+class FilePlayer		:	public AudioSource,
+						private ChangeListener
 {
 public:
 	/** Constructor. */
@@ -21,38 +32,98 @@ public:
 	/** Destructor. */
 	~FilePlayer();
 
-	/** Gets the current playback state of the AudioTransportSource.
-		@return	bool of the current playback state of the AudioTransportSource
+	/** Passes this object the SamplePool files are preloaded into, and the slot of the pool that belongs to it.
+		@param	pointer to a SamplePool, expected to outlive this object
+		@param	int index of this object's slot in the SamplePool */
+	void setSamplePool(SamplePool* pool, int slot);
+
+	/** Passes this object the DiskStreamer that provides the thread long files are streamed on.
+		@param	pointer to a DiskStreamer, expected to outlive this object */
+	void setDiskStreamer(DiskStreamer* streamer);
+
+	/** Passes this object the VoicePool that plays preloaded files.
+		@param	pointer to a VoicePool, expected to outlive this object and to be rendered after this object in each block */
+	void setVoicePool(VoicePool* pool);
+
+	/** Gets the current playback state of the preloaded or streamed file.
+		@return	bool of the current playback state
 		@see	setPlaying */
 	bool isPlaying() const;
 
-	/** Gets the current looping state of the AudioFormatReaderSource.
-		@return	bool of the current looping state of the AudioFormatReaderSource
+	/** Gets the current looping state of the file.
+		@return	bool of the current looping state
 		@see	setLooping */
 	bool isLooping();
 
-	/** Starts or stops playback of the loaded file.
+	/** Starts or stops playback of the loaded file at the beginning of the next block this object renders - a preloaded
+		file is started on a new voice (or every voice playing it is stopped), and a streamed file is started from its
+		beginning (or faded out). Safe to call from any thread, and never waits.
 		@param	bool of the new playback state - true is play, false is stop
 		@see	isPlaying */
 	void setPlaying(bool newState);
 
-	/** Sets the looping state of the AudioFormatReaderSource - default is do not loop.
+	/** Starts the streamed file from the given sample, at the given rate and gain, at the beginning of the next block
+		this object renders - the way to play it from the audio thread. Does nothing to preloaded files, or to a file
+		that has just played to its end and not yet been readied again by the message thread.
+		@param	double playback rate relative to the file's original pitch
+		@param	float gain to play the file at
+		@param	int sample of the file to start from
+		@return	uint32 identifying the note started, to pass to stopStream() */
+	uint32 startStream(double rate, float newGain, int startOffset) noexcept;
+
+	/** Fades out the streamed file over the next block this object renders, without waiting for it - the way to stop
+		it from the audio thread. The transport is left where it is, unrendered, until the file is next started.
+		Does nothing to preloaded files, or if the file has been started again since the given note.
+		@param	uint32 note to stop, as returned by startStream() */
+	void stopStream(uint32 note) noexcept;
+
+	/** Sets the looping state of the file - default is do not loop.
 		@param	bool of the new looping state - true is loop, false is do not loop
 		@see	isLooping */
 	void setLooping(bool shouldLoop);
 
-	/** Sets the gain of the AudioTransportSource.
+	/** Sets the gain the file is played at. Safe to call from any thread - a streamed file picks it up in the next block
+		this object renders, and a preloaded file when it next starts.
 		@param	float new gain value */
 	void setGain(float g);
 
-	/** Sets the resampling rate of the ResamplingAudioSource.
+	/** Sets the playback rate of the file relative to its original pitch. Safe to call from any thread - a streamed file
+		picks it up in the next block this object renders, and a preloaded file when it next starts.
 		@param	double new resampling rate */
 	void setPlaybackRate(double newRate);
 
-	/** Loads the specified file into the AudioTransportSource via AudioFormatReaderSource.
-		@param File to be streamed */
+	/** Loads the specified file, decoding it into the SamplePool if it is short enough to be preloaded and
+		otherwise streaming it into the AudioTransportSource via AudioFormatReaderSource. Decodes on the calling
+		thread - the interface loads files through a SampleLoader instead, so it never waits for one.
+		@param File to be played */
 	void loadFile(const File& newFile);
 
+	/** Streams the file behind an already opened reader into the AudioTransportSource, whatever its length - used
+		once a SampleLoader has found a file too long to preload.
+		@param	unique_ptr to the AudioFormatReader for the file, which this object takes over
+		@param	File the reader was opened from, returned by getFile() */
+	void loadStream(std::unique_ptr<AudioFormatReader> reader, const File& newFile);
+
+	/** Places an already decoded sample in this object's slot of the SamplePool, as if its file had been loaded
+		and preloaded - used for samples embedded in a project.
+		@param	PooledSample::Ptr to the decoded sample
+		@param	File the sample was originally loaded from, returned by getFile() */
+	void loadSample(PooledSample::Ptr sample, const File& originalFile);
+
+	/** Returns the file most recently loaded, whether it was preloaded or is being streamed.
+		@return	File loaded, or File() if none has been loaded */
+	File getFile() const;
+
+	/** Returns true if the loaded file is streamed from disk rather than preloaded into the SamplePool. */
+	bool isStreaming() const;
+
+	/** Returns the number of blocks the streamed file has played silence in because its read-ahead had not caught up.
+		Safe to call from any thread. */
+	int getUnderrunCount() const;
+
+	/** Sets the count returned by getUnderrunCount back to zero. */
+	void resetUnderrunCount();
+
 	//AudioSource
 	/** Overridden function inherited from AudioSource. Calls prepareToPlay() on the ResamplingAudioSource, passing
 		the same variables as passed to this method.
@@ -63,14 +134,67 @@ public:
 	/** Overridden function inherited from AudioSource. Calls releaseResources() on the ResamplingAudioSource, passing
 		the same variables as passed to this method. */
 	void releaseResources() override;
-	/** Overridden function inherited from AudioSource. Calls getNextAudioBlock() on the ResamplingAudioSource, passing
-		the same variables as passed to this method.
+	/** Overridden function inherited from AudioSource. Passes any pending start or stop of a preloaded file to the VoicePool,
+		then renders the streamed file if it is sounding, or clears the region if it is not.
 		@param	reference to the next block of audio data */
 	void getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill) override;
 
+	/** Passes any pending start or stop of a preloaded file to the VoicePool, and applies any pending start or stop,
+		rate and gain to the streamed file. Should only be called from the audio thread, before the VoicePool renders the
+		block the command should be heard in. */
+	void processPendingCommand() noexcept;
+
+	/** Returns true if the streamed file is playing, or is fading out over the next block after being stopped.
+		While this is false renderStream() would only produce silence and need not be called. Should only be called from the audio thread. */
+	bool isStreamActive() const noexcept;
+
+	/** Replaces the given region with the next block of the streamed file, calling getNextAudioBlock() on the
+		ResamplingAudioSource. Should only be called from the audio thread.
+		@param	reference to the next block of audio data */
+	void renderStream(const AudioSourceChannelInfo& bufferToFill);
+
 private:
-	AudioTransportSource audioTransportSource;						
-	TimeSliceThread thread;
+	class ReadAheadMonitor;
+
+	/** Stops playback and releases the streamed file, if there is one. */
+	void unloadStream();
+
+	//ChangeListener
+	/** Overridden function inherited from ChangeListener. Starts the transport again, halted, once a file that does not
+		loop has played to its end and stopped it, so the next note can be started from the audio thread. */
+	void changeListenerCallback(ChangeBroadcaster* source) override;
+
+	SharedResourcePointer<SampleFormatManager> formatManager;
+	AudioTransportSource audioTransportSource;
 	std::unique_ptr<ResamplingAudioSource> resamplingAudioSource;
 	std::unique_ptr<AudioFormatReaderSource> currentAudioFileSource;
+	std::unique_ptr<ReadAheadMonitor> readAheadMonitor;
+
+	/** Commands passed from setPlaying to the audio thread. */
+	enum VoiceCommand
+	{
+		NoCommand = 0,
+		StartCommand,
+		StopCommand,
+		StartStreamCommand,
+		StopStreamCommand
+	};
+
+	SamplePool* samplePool	{	nullptr	};
+	DiskStreamer* diskStreamer	{	nullptr	};
+	VoicePool* voicePool	{	nullptr	};
+	int slotIndex;
+	File loadedFile;
+
+	std::atomic<int> pendingCommand;
+	std::atomic<uint32> latestStreamNote;
+	std::atomic<bool> streamHalted;
+	bool haltStreamDue;
+	std::atomic<int> streamStartOffset;
+	std::atomic<double> streamSampleRate;
+	double appliedPlaybackRate;
+	std::atomic<int> underrunCount;
+	std::atomic<bool> looping;
+	std::atomic<float> gain;
+	std::atomic<double> playbackRate;
 };
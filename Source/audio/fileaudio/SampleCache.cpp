@@ -0,0 +1,197 @@
+/*
+  ==============================================================================
+	SampleCache.cpp
+  ==============================================================================
+*/
+
+#include "SampleCache.h"
+#include "SampleInterpolator.h"
+#include <algorithm>
+
+#if JUCE_BIG_ENDIAN
+ #error "Sample cache entries are written and mapped in little-endian order"
+#endif
+
+/** The first bytes of every entry. */
+struct SampleCache::Header
+{
+	char magic[4];
+	uint32 version;
+	int32 numChannels;
+	int32 lengthInSamples;
+	double sampleRate;
+	int64 dataOffset;
+};
+
+/** Returns the given offset rounded up to the next section boundary. */
+static int64 alignSection(int64 offset)
+{
+	return (offset + SampleCache::SectionAlignment - 1) & ~(int64) (SampleCache::SectionAlignment - 1);
+}
+
+/** Converts decoded audio to another sample rate with the same windowed sinc the voices pitch with, so a cached
+	sample sounds as it would have done converted live. */
+static AudioBuffer<float> convertSampleRate(const AudioBuffer<float>& source, double sourceRate, double targetRate)
+{
+	const double increment = sourceRate / targetRate;
+	const int length = (int) std::ceil(source.getNumSamples() / increment);
+	AudioBuffer<float> converted(source.getNumChannels(), length);
+	converted.clear();
+
+	double position = 0.0;
+	SampleInterpolator::render(SampleInterpolator::WindowedSinc, source, false, position, increment, increment, 1.f, 1.f, converted, 0, length);
+	return converted;
+}
+
+SampleCache::SampleCache(const File& cacheDirectory)		:	directory(cacheDirectory)
+{
+	directory.createDirectory();
+}
+
+SampleCache::~SampleCache()
+{
+
+}
+
+File SampleCache::getDefaultDirectory()
+{
+	return File::getSpecialLocation(File::userApplicationDataDirectory).getChildFile("JuceTracker").getChildFile("SampleCache");
+}
+
+PooledSample::Ptr SampleCache::getSample(const File& file, AudioFormatReader& reader, double targetSampleRate)
+{
+	const double sampleRate = targetSampleRate > 0.0 ? targetSampleRate : reader.sampleRate;
+	const File entry = getEntryFile(file, sampleRate);
+	if (auto cached = mapEntry(entry))
+	{
+		//marks the entry as recently used, so it is the last to be trimmed
+		entry.setLastModificationTime(Time::getCurrentTime());
+		return cached;
+	}
+
+	//decodes the whole file in one go - stereo files keep both channels, anything wider is cut down to two
+	const int numChannels = jlimit(1, 2, (int) reader.numChannels);
+	const int length = (int) reader.lengthInSamples;
+	AudioBuffer<float> data(numChannels, length);
+	reader.read(&data, 0, length, 0, true, numChannels > 1);
+	if (length > 0 && reader.sampleRate > 0.0 && reader.sampleRate != sampleRate)
+	{
+		data = convertSampleRate(data, reader.sampleRate, sampleRate);
+	}
+
+	if (length > 0 && writeEntry(entry, data, sampleRate))
+	{
+		trim();
+		if (auto cached = mapEntry(entry))
+		{
+			return cached;
+		}
+	}
+	return new PooledSample(std::move(data), sampleRate);
+}
+
+File SampleCache::getEntryFile(const File& file, double sampleRate) const
+{
+	return directory.getChildFile(MD5(file).toHexString() + "-" + String(roundToInt(sampleRate)) + ".jtcache");
+}
+
+PooledSample::Ptr SampleCache::mapEntry(const File& entry)
+{
+	if (!entry.existsAsFile())
+	{
+		return nullptr;
+	}
+
+	auto mapping = std::make_shared<MemoryMappedFile>(entry, MemoryMappedFile::readOnly);
+	const auto* data = static_cast<const char*>(mapping->getData());
+	const size_t size = mapping->getSize();
+	if (data == nullptr || size < sizeof(Header))
+	{
+		return nullptr;
+	}
+
+	//an entry cut short or written by another version is ignored, and replaced when the file is decoded again
+	Header header;
+	memcpy(&header, data, sizeof(Header));
+	if (memcmp(header.magic, "JTSC", 4) != 0 || header.version != FormatVersion
+		|| !isPositiveAndNotGreaterThan(header.numChannels, 2) || header.numChannels == 0 || header.lengthInSamples <= 0
+		|| header.sampleRate <= 0.0 || header.dataOffset < (int64) sizeof(Header) || header.dataOffset % alignof(float) != 0
+		|| (int64) size - header.dataOffset < (int64) sizeof(float) * header.numChannels * header.lengthInSamples)
+	{
+		return nullptr;
+	}
+
+	//reads one byte of every page now, on the loading thread, so the audio thread never faults them in mid-callback
+	const auto* bytes = reinterpret_cast<const uint8*>(data);
+	const size_t pageSize = 4096;
+	volatile uint8 touched = 0;
+	for (size_t position = 0; position < size; position += pageSize)
+	{
+		touched = bytes[position];
+	}
+
+	const auto* firstChannel = reinterpret_cast<const float*>(data + header.dataOffset);
+	const float* channels[2] = { firstChannel, firstChannel + header.lengthInSamples };
+	return new PooledSample(mapping, channels, header.numChannels, header.lengthInSamples, header.sampleRate);
+}
+
+bool SampleCache::writeEntry(const File& entry, const AudioBuffer<float>& data, double sampleRate)
+{
+	static_assert(sizeof(Header) == 32, "Header layout has changed");
+
+	Header header = {};
+	memcpy(header.magic, "JTSC", 4);
+	header.version = FormatVersion;
+	header.numChannels = data.getNumChannels();
+	header.lengthInSamples = data.getNumSamples();
+	header.sampleRate = sampleRate;
+	header.dataOffset = alignSection(sizeof(Header));
+
+	//writes to a temporary file first, so another thread never maps an entry that is half written
+	TemporaryFile temporaryFile(entry);
+	{
+		FileOutputStream stream(temporaryFile.getFile());
+		if (!stream.openedOk())
+		{
+			return false;
+		}
+
+		bool ok = stream.write(&header, sizeof(Header))
+				&& stream.writeRepeatedByte(0, (size_t) (header.dataOffset - (int64) sizeof(Header)));
+		for (int channel = 0; ok && channel < data.getNumChannels(); channel++)
+		{
+			ok = stream.write(data.getReadPointer(channel), sizeof(float) * (size_t) data.getNumSamples());
+		}
+
+		stream.flush();
+		if (!ok || stream.getStatus().failed())
+		{
+			return false;
+		}
+	}
+	return temporaryFile.overwriteTargetFileWithTemporary();
+}
+
+void SampleCache::trim()
+{
+	const ScopedLock lock(trimLock);
+
+	Array<File> entries = directory.findChildFiles(File::findFiles, false, "*.jtcache");
+	int64 totalSize = 0;
+	for (auto& entry : entries)
+	{
+		totalSize += entry.getSize();
+	}
+
+	std::sort(entries.begin(), entries.end(), [] (const File& a, const File& b) { return a.getLastModificationTime() < b.getLastModificationTime(); });
+	const int64 maximumSize = (int64) MaximumSizeInMegabytes * 1024 * 1024;
+	for (int i = 0; i < entries.size() && totalSize > maximumSize; i++)
+	{
+		//an entry still mapped by a loaded sample may refuse to be deleted, and is left until the next trim
+		const int64 entrySize = entries.getReference(i).getSize();
+		if (entries.getReference(i).deleteFile())
+		{
+			totalSize -= entrySize;
+		}
+	}
+}
@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+	SampleCache.h
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SamplePool.h"
+
+/** Keeps a copy of every preloaded sample on disk, decoded to floats and already converted to the rate of the audio
+	device, so loading the same file again is a memory-mapping rather than a decode and a rate conversion - and a sample
+	played at C-4 steps through it one sample at a time, with nothing to interpolate. Entries are named after a hash
+	of the file's contents and the rate they were converted to, so a file that is moved is still found and one that is
+	edited never is. Each entry is a short header followed by the planar float audio, aligned to be mapped in place.
+	Once the cache grows past MaximumSizeInMegabytes the entries least recently used are deleted.
+	Safe to use from several threads at once. */
+
+class SampleCache
+{
+public:
+	/** Constructor.
+		@param	File directory to keep the cache in, created if it does not exist */
+	SampleCache(const File& cacheDirectory);
+
+	/** Destructor. */
+	~SampleCache();
+
+	/** Holds the version of the entries written, the alignment of their audio and the size the cache is trimmed to. */
+	enum
+	{
+		FormatVersion = 1,
+		SectionAlignment = 16,
+		MaximumSizeInMegabytes = 2048
+	};
+
+	/** Returns the directory the application keeps its cache in. */
+	static File getDefaultDirectory();
+
+	/** Returns the file decoded at the given rate - mapped from the cache if it holds it, otherwise decoded from the
+		reader, converted to the rate with the windowed sinc the voices use, written to the cache and mapped from there.
+		Falls back to the decoded audio in memory if the cache can't be written. Pages of a mapped entry are read
+		before this returns, so the audio thread never waits on the disk for them. Call from a background thread.
+		@param	File the reader was opened from, whose contents name the entry
+		@param	reference to an AudioFormatReader for the file
+		@param	double sample rate to convert to, or 0 to keep the file's own rate
+		@return	PooledSample::Ptr to the sample, never nullptr */
+	PooledSample::Ptr getSample(const File& file, AudioFormatReader& reader, double targetSampleRate);
+
+private:
+	struct Header;
+
+	/** Returns the entry the given file would be cached in at the given rate. */
+	File getEntryFile(const File& file, double sampleRate) const;
+
+	/** Maps an entry and checks it is complete.
+		@return	PooledSample::Ptr referring to the mapping, or nullptr if the entry is missing or damaged */
+	static PooledSample::Ptr mapEntry(const File& entry);
+
+	/** Writes an entry, replacing it only once it has been written in full.
+		@return	bool true if the entry was written */
+	static bool writeEntry(const File& entry, const AudioBuffer<float>& data, double sampleRate);
+
+	/** Deletes the entries least recently used until the cache is no larger than MaximumSizeInMegabytes. */
+	void trim();
+
+	File directory;
+	CriticalSection trimLock;
+
+	JUCE_DECLARE_NON_COPYABLE(SampleCache)
+};
@@ -0,0 +1,17 @@
+/*
+  ==============================================================================
+	SampleFormatManager.cpp
+  ==============================================================================
+*/
+
+#include "SampleFormatManager.h"
+
+SampleFormatManager::SampleFormatManager()
+{
+	registerBasicFormats();
+}
+
+SampleFormatManager::~SampleFormatManager()
+{
+
+}
@@ -0,0 +1,26 @@
+/*
+  ==============================================================================
+	SampleFormatManager.h
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/** The audio formats samples can be loaded from, registered once and shared by everything that reads files or
+	lists the files that can be read. Hold one through a SharedResourcePointer, so there is only ever one registry.
+	Registering only happens in the constructor, so createReaderFor() can be called from several threads at once. */
+
+class SampleFormatManager		:	public AudioFormatManager
+{
+public:
+	/** Constructor. Registers the basic formats - wav and aiff, and ogg and flac where they are enabled. */
+	SampleFormatManager();
+
+	/** Destructor. */
+	~SampleFormatManager();
+
+private:
+	JUCE_DECLARE_NON_COPYABLE(SampleFormatManager)
+};
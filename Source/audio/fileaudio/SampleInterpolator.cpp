@@ -0,0 +1,410 @@
+/*
+  ==============================================================================
+	SampleInterpolator.cpp
+  ==============================================================================
+*/
+
+#include "SampleInterpolator.h"
+
+#if JUCE_INTEL
+ #include <emmintrin.h>
+ #define JUCETRACKER_INTERPOLATOR_SIMD 1
+#elif JUCE_ARM && (defined (__ARM_NEON__) || defined (__ARM_NEON))
+ #include <arm_neon.h>
+ #define JUCETRACKER_INTERPOLATOR_SIMD 1
+#else
+ #define JUCETRACKER_INTERPOLATOR_SIMD 0
+#endif
+
+namespace
+{
+	enum
+	{
+		SincHalfWidth = 8,
+		SincTaps = SincHalfWidth * 2,
+		SincPhases = 256
+	};
+
+	//the first and last samples each mode reads, relative to the sample before the read position
+	const int firstTaps[SampleInterpolator::NumModes] = { 0, 0, -1, 1 - SincHalfWidth };
+	const int lastTaps[SampleInterpolator::NumModes] = { 0, 1, 2, SincHalfWidth };
+
+	/** Windowed sinc coefficients for each phase between two samples, plus one extra phase so the coefficients
+		can be interpolated up to the next sample. Built once at startup, never on the audio thread. */
+	struct SincTable
+	{
+		SincTable()
+		{
+			//slightly below Nyquist, so the transition band of the window sits under it
+			const double cutoff = 0.95;
+
+			for (int phase = 0; phase <= SincPhases; phase++)
+			{
+				const double fraction = phase / (double) SincPhases;
+				double sum = 0.0;
+
+				for (int tap = 0; tap < SincTaps; tap++)
+				{
+					//distance of the tap from the read position
+					const double x = tap - (SincHalfWidth - 1) - fraction;
+					const double angle = MathConstants<double>::pi * cutoff * x;
+					const double sinc = x == 0.0 ? 1.0 : std::sin(angle) / angle;
+					const double window = 0.42 + 0.5 * std::cos(MathConstants<double>::pi * x / SincHalfWidth)
+						+ 0.08 * std::cos(MathConstants<double>::twoPi * x / SincHalfWidth);
+
+					coefficients[phase][tap] = (float) (sinc * window);
+					sum += sinc * window;
+				}
+
+				//normalises each phase to unity gain, so there is no ripple in level as the fraction moves
+				for (int tap = 0; tap < SincTaps; tap++)
+				{
+					coefficients[phase][tap] = (float) (coefficients[phase][tap] / sum);
+				}
+			}
+		}
+
+		alignas (16) float coefficients[SincPhases + 1][SincTaps];
+	};
+
+	const SincTable sincTable;
+
+	/** Returns the source sample at the given index, wrapping around if looping, otherwise silence outside the source. */
+	inline float fetch(const float* data, int length, bool looping, int index) noexcept
+	{
+		if (isPositiveAndBelow(index, length))
+		{
+			return data[index];
+		}
+		if (!looping)
+		{
+			return 0.f;
+		}
+		index %= length;
+		return data[index < 0 ? index + length : index];
+	}
+
+	/** Returns the source interpolated at the given position, with every tap range checked. */
+	float interpolate(int mode, const float* data, int length, bool looping, int index, float fraction) noexcept
+	{
+		switch (mode)
+		{
+		case SampleInterpolator::None:
+			return fetch(data, length, looping, index);
+
+		case SampleInterpolator::Linear:
+		{
+			const float x0 = fetch(data, length, looping, index);
+			const float x1 = fetch(data, length, looping, index + 1);
+			return x0 + fraction * (x1 - x0);
+		}
+
+		case SampleInterpolator::Cubic:
+		{
+			const float xm1 = fetch(data, length, looping, index - 1);
+			const float x0 = fetch(data, length, looping, index);
+			const float x1 = fetch(data, length, looping, index + 1);
+			const float x2 = fetch(data, length, looping, index + 2);
+			const float c1 = 0.5f * (x1 - xm1);
+			const float c2 = xm1 - 2.5f * x0 + 2.f * x1 - 0.5f * x2;
+			const float c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+			return ((c3 * fraction + c2) * fraction + c1) * fraction + x0;
+		}
+
+		default:
+		{
+			const float phasePosition = fraction * SincPhases;
+			const int phase = jmin((int) phasePosition, SincPhases - 1);
+			const float blend = phasePosition - phase;
+			const float* a = sincTable.coefficients[phase];
+			const float* b = sincTable.coefficients[phase + 1];
+
+			float sum = 0.f;
+			for (int tap = 0; tap < SincTaps; tap++)
+			{
+				const float coefficient = a[tap] + blend * (b[tap] - a[tap]);
+				sum += coefficient * fetch(data, length, looping, index + 1 - SincHalfWidth + tap);
+			}
+			return sum;
+		}
+		}
+	}
+
+#if JUCETRACKER_INTERPOLATOR_SIMD
+ #if JUCE_INTEL
+	typedef __m128 Vec;
+	inline Vec loadVec(const float* p) noexcept				{ return _mm_loadu_ps(p); }
+	inline void storeVec(float* p, Vec v) noexcept			{ _mm_storeu_ps(p, v); }
+	inline Vec setVec(float a, float b, float c, float d) noexcept	{ return _mm_setr_ps(a, b, c, d); }
+	inline Vec splatVec(float a) noexcept					{ return _mm_set1_ps(a); }
+	inline Vec addVec(Vec a, Vec b) noexcept				{ return _mm_add_ps(a, b); }
+	inline Vec subVec(Vec a, Vec b) noexcept				{ return _mm_sub_ps(a, b); }
+	inline Vec mulVec(Vec a, Vec b) noexcept				{ return _mm_mul_ps(a, b); }
+	inline float sumVec(Vec v) noexcept
+	{
+		const Vec pairs = _mm_add_ps(v, _mm_movehl_ps(v, v));
+		return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+	}
+ #else
+	typedef float32x4_t Vec;
+	inline Vec loadVec(const float* p) noexcept				{ return vld1q_f32(p); }
+	inline void storeVec(float* p, Vec v) noexcept			{ vst1q_f32(p, v); }
+	inline Vec setVec(float a, float b, float c, float d) noexcept	{ const float v[4] = { a, b, c, d }; return vld1q_f32(v); }
+	inline Vec splatVec(float a) noexcept					{ return vdupq_n_f32(a); }
+	inline Vec addVec(Vec a, Vec b) noexcept				{ return vaddq_f32(a, b); }
+	inline Vec subVec(Vec a, Vec b) noexcept				{ return vsubq_f32(a, b); }
+	inline Vec mulVec(Vec a, Vec b) noexcept				{ return vmulq_f32(a, b); }
+	inline float sumVec(Vec v) noexcept
+	{
+		const float32x2_t pairs = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+		return vget_lane_f32(vpadd_f32(pairs, pairs), 0);
+	}
+ #endif
+
+	/** Returns four output samples of the source, one per read position, for the modes that read few taps.
+		Every tap must lie inside the source. */
+	inline Vec interpolateFour(int mode, const float* data, const int* index, Vec fraction) noexcept
+	{
+		const Vec x0 = setVec(data[index[0]], data[index[1]], data[index[2]], data[index[3]]);
+		if (mode == SampleInterpolator::None)
+		{
+			return x0;
+		}
+
+		const Vec x1 = setVec(data[index[0] + 1], data[index[1] + 1], data[index[2] + 1], data[index[3] + 1]);
+		if (mode == SampleInterpolator::Linear)
+		{
+			return addVec(x0, mulVec(fraction, subVec(x1, x0)));
+		}
+
+		const Vec xm1 = setVec(data[index[0] - 1], data[index[1] - 1], data[index[2] - 1], data[index[3] - 1]);
+		const Vec x2 = setVec(data[index[0] + 2], data[index[1] + 2], data[index[2] + 2], data[index[3] + 2]);
+		const Vec half = splatVec(0.5f);
+		const Vec c1 = mulVec(half, subVec(x1, xm1));
+		const Vec c2 = subVec(addVec(xm1, mulVec(splatVec(2.f), x1)), addVec(mulVec(splatVec(2.5f), x0), mulVec(half, x2)));
+		const Vec c3 = addVec(mulVec(half, subVec(x2, xm1)), mulVec(splatVec(1.5f), subVec(x0, x1)));
+		return addVec(mulVec(addVec(mulVec(addVec(mulVec(c3, fraction), c2), fraction), c1), fraction), x0);
+	}
+
+	/** Blends the sinc coefficients for the given fraction into four vectors of four taps. */
+	inline void getSincCoefficients(float fraction, Vec* coefficients) noexcept
+	{
+		const float phasePosition = fraction * SincPhases;
+		const int phase = jmin((int) phasePosition, SincPhases - 1);
+		const Vec blend = splatVec(phasePosition - phase);
+		const float* a = sincTable.coefficients[phase];
+		const float* b = sincTable.coefficients[phase + 1];
+
+		for (int i = 0; i < SincTaps / 4; i++)
+		{
+			const Vec va = loadVec(a + i * 4);
+			coefficients[i] = addVec(va, mulVec(blend, subVec(loadVec(b + i * 4), va)));
+		}
+	}
+
+	/** Adds the source into the output with a gain that moves by gainStep on every sample. */
+	inline void addWithRamp(float* output, const float* source, float gain, float gainStep, int numSamples) noexcept
+	{
+		const Vec steps = mulVec(splatVec(gainStep), setVec(0.f, 1.f, 2.f, 3.f));
+		int i = 0;
+		for (; i + 4 <= numSamples; i += 4)
+		{
+			const Vec gains = addVec(splatVec(gain + gainStep * i), steps);
+			storeVec(output + i, addVec(loadVec(output + i), mulVec(gains, loadVec(source + i))));
+		}
+		for (; i < numSamples; i++)
+		{
+			output[i] += (gain + gainStep * i) * source[i];
+		}
+	}
+
+	/** Returns the dot product of the sinc coefficients with the taps starting at the given sample. */
+	inline float sincDot(const float* firstTap, const Vec* coefficients) noexcept
+	{
+		Vec sum = mulVec(loadVec(firstTap), coefficients[0]);
+		for (int i = 1; i < SincTaps / 4; i++)
+		{
+			sum = addVec(sum, mulVec(loadVec(firstTap + i * 4), coefficients[i]));
+		}
+		return sumVec(sum);
+	}
+#else
+	/** Adds the source into the output with a gain that moves by gainStep on every sample. */
+	inline void addWithRamp(float* output, const float* source, float gain, float gainStep, int numSamples) noexcept
+	{
+		for (int i = 0; i < numSamples; i++)
+		{
+			output[i] += (gain + gainStep * i) * source[i];
+		}
+	}
+#endif
+}
+
+String SampleInterpolator::getModeName(Mode mode)
+{
+	switch (mode)
+	{
+	case None:			return "None";
+	case Linear:		return "Linear";
+	case Cubic:			return "Cubic";
+	case WindowedSinc:	return "Windowed Sinc";
+	default:			return {};
+	}
+}
+
+bool SampleInterpolator::render(Mode mode, const AudioBuffer<float>& source, bool looping, double& position,
+	double startIncrement, double endIncrement, float startGain, float endGain,
+	AudioBuffer<float>& output, int startSample, int numSamples) noexcept
+{
+	jassert(isPositiveAndBelow((int) mode, (int) NumModes));
+	jassert(startIncrement > 0.0 && endIncrement > 0.0);
+
+	const int length = source.getNumSamples();
+	const int numInputs = jmin(2, source.getNumChannels());
+	const int numOutputs = jmin(2, output.getNumChannels());
+	if (length == 0 || numInputs == 0 || numOutputs == 0)
+	{
+		return false;
+	}
+	if (numSamples <= 0)
+	{
+		return true;
+	}
+
+	//the gain and step of output sample i are worked out from i, rather than summed, so a ramp never drifts
+	const float gainStep = (endGain - startGain) / numSamples;
+	const double incrementStep = (endIncrement - startIncrement) / numSamples;
+
+	const float* inL = source.getReadPointer(0);
+	const float* inR = source.getReadPointer(numInputs - 1);
+	float* outL = output.getWritePointer(0, startSample);
+	float* outR = numOutputs > 1 ? output.getWritePointer(1, startSample) : nullptr;
+
+	const int firstTap = firstTaps[mode];
+	const int lastTap = lastTaps[mode];
+
+	int i = 0;
+	while (i < numSamples)
+	{
+		//wraps back to the start of the source if looping, otherwise ends playback
+		if (position >= length)
+		{
+			if (!looping)
+			{
+				return false;
+			}
+			position = std::fmod(position, (double) length);
+		}
+
+		//renders up to the end of the source in one span, so the loops below never need to wrap the position - at the
+		//fastest step the span could reach, if the step is ramping up
+		const double fastestIncrement = jmax(startIncrement + incrementStep * i, endIncrement);
+		const int samplesToEnd = jmax(1, (int) std::ceil((length - position) / fastestIncrement));
+		const int spanEnd = jmin(numSamples, i + samplesToEnd);
+
+		//stepping one whole sample at a time - a sample at the output rate played unpitched - every read lands on
+		//a sample, so there is nothing to interpolate and the span is a plain gain and add
+		if (incrementStep == 0.0 && startIncrement == 1.0 && position == (double) (int) position)
+		{
+			const int index = (int) position;
+			const int count = spanEnd - i;
+			if (gainStep == 0.f)
+			{
+				FloatVectorOperations::addWithMultiply(outL + i, inL + index, startGain, count);
+				if (outR != nullptr)
+				{
+					FloatVectorOperations::addWithMultiply(outR + i, inR + index, startGain, count);
+				}
+			}
+			else
+			{
+				addWithRamp(outL + i, inL + index, startGain + gainStep * i, gainStep, count);
+				if (outR != nullptr)
+				{
+					addWithRamp(outR + i, inR + index, startGain + gainStep * i, gainStep, count);
+				}
+			}
+			i += count;
+			position += count;
+			continue;
+		}
+
+#if JUCETRACKER_INTERPOLATOR_SIMD
+		//four output samples at a time - the taps are gathered, then interpolated together
+		if (mode != WindowedSinc)
+		{
+			const Vec gainSteps = mulVec(splatVec(gainStep), setVec(0.f, 1.f, 2.f, 3.f));
+			for (; i + 4 <= spanEnd; i += 4)
+			{
+				const Vec gains = addVec(splatVec(startGain + gainStep * i), gainSteps);
+				int index[4];
+				float fraction[4];
+				for (int k = 0; k < 4; k++)
+				{
+					index[k] = (int) position;
+					fraction[k] = (float) (position - index[k]);
+					position += startIncrement + incrementStep * (i + k);
+				}
+
+				//positions only move forward, so if the first and last are clear of the ends, every tap is
+				if (index[0] + firstTap >= 0 && index[3] + lastTap < length)
+				{
+					const Vec fractions = loadVec(fraction);
+					const Vec left = interpolateFour(mode, inL, index, fractions);
+					storeVec(outL + i, addVec(loadVec(outL + i), mulVec(gains, left)));
+					if (outR != nullptr)
+					{
+						const Vec right = inR != inL ? interpolateFour(mode, inR, index, fractions) : left;
+						storeVec(outR + i, addVec(loadVec(outR + i), mulVec(gains, right)));
+					}
+				}
+				else
+				{
+					for (int k = 0; k < 4; k++)
+					{
+						const float gain = startGain + gainStep * (i + k);
+						const float left = interpolate(mode, inL, length, looping, index[k], fraction[k]);
+						outL[i + k] += gain * left;
+						if (outR != nullptr)
+						{
+							outR[i + k] += gain * (inR != inL ? interpolate(mode, inR, length, looping, index[k], fraction[k]) : left);
+						}
+					}
+				}
+			}
+		}
+#endif
+
+		//one output sample at a time - the remainder of the span, or every sample for the sinc, whose taps are vectorised instead
+		for (; i < spanEnd; i++)
+		{
+			const int index = (int) position;
+			const float fraction = (float) (position - index);
+			float left, right;
+
+#if JUCETRACKER_INTERPOLATOR_SIMD
+			if (mode == WindowedSinc && index + firstTap >= 0 && index + lastTap < length)
+			{
+				Vec coefficients[SincTaps / 4];
+				getSincCoefficients(fraction, coefficients);
+				left = sincDot(inL + index + firstTap, coefficients);
+				right = inR != inL ? sincDot(inR + index + firstTap, coefficients) : left;
+			}
+			else
+#endif
+			{
+				left = interpolate(mode, inL, length, looping, index, fraction);
+				right = inR != inL ? interpolate(mode, inR, length, looping, index, fraction) : left;
+			}
+
+			const float gain = startGain + gainStep * i;
+			outL[i] += gain * left;
+			if (outR != nullptr)
+			{
+				outR[i] += gain * right;
+			}
+			position += startIncrement + incrementStep * i;
+		}
+	}
+	return true;
+}
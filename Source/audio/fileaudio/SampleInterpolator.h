@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+	SampleInterpolator.h
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/** Reads a sample held in memory at a fractional position, stepping through it at any rate, and adds the result
+	into an output buffer. Every channel is read at the same positions in one pass, straight from the source
+	buffer, so there is no intermediate buffer or filter state to keep. Where every tap of the interpolator lies
+	inside the sample, the work is done four output samples (or four taps) at a time with SSE or NEON; near the
+	ends of the sample a scalar path wraps or zero-pads the taps instead. A source read one whole sample per output
+	sample is copied straight across, in every mode. The gain and step can each move in a straight line across the
+	section, so changes are ramped inside the same vector loops rather than with a branch per sample. Safe to use
+	from the audio thread. */
+
+class SampleInterpolator
+{
+public:
+	/** Ways of reading between samples, from cheapest to highest quality. */
+	enum Mode
+	{
+		None = 0,		/**< uses the sample before the read position */
+		Linear,			/**< blends the two samples either side of the read position */
+		Cubic,			/**< fits a Catmull-Rom curve through the four nearest samples */
+		WindowedSinc,	/**< 16 tap Blackman windowed sinc, interpolated between 256 phases */
+
+		NumModes
+	};
+
+	/** Returns the name of the given mode, for display.
+		@param	Mode interpolation mode */
+	static String getModeName(Mode mode);
+
+	/** Adds the next section of the source into the given buffer. Mono sources are added to every output channel;
+		at most two channels are read and written. The step and gain move in a straight line from their start values,
+		used for the first output sample, towards their end values, which would be used for the sample after the last -
+		so consecutive sections ramp without a seam.
+		@param	Mode interpolation mode to read with
+		@param	reference to the AudioBuffer holding the source
+		@param	bool true if the read position wraps back to the start at the end of the source
+		@param	reference to the read position in the source - updated to the position after the last sample written
+		@param	double step through the source per output sample at the start of the section - must be greater than zero
+		@param	double step through the source per output sample at the end of the section - must be greater than zero
+		@param	float gain at the start of the section
+		@param	float gain at the end of the section
+		@param	reference to the AudioBuffer to add to
+		@param	int first sample of the output buffer to add to
+		@param	int number of samples to add
+		@return	bool false if the read position reached the end of a source that does not wrap */
+	static bool render(Mode mode, const AudioBuffer<float>& source, bool looping, double& position,
+		double startIncrement, double endIncrement, float startGain, float endGain,
+		AudioBuffer<float>& output, int startSample, int numSamples) noexcept;
+
+private:
+	SampleInterpolator() = delete;
+};
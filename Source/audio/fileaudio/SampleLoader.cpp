@@ -0,0 +1,186 @@
+/*
+  ==============================================================================
+	SampleLoader.cpp
+  ==============================================================================
+*/
+
+#include "SampleLoader.h"
+
+/** Opens one file on a thread of the SampleLoader's ThreadPool, and decodes it if it is short enough to be preloaded. */
+
+class SampleLoader::LoadJob		:	public ThreadPoolJob
+{
+public:
+	/** Constructor.
+		@param	reference to the SampleLoader to pass the result to
+		@param	int slot the file is loading into
+		@param	int request number, to tell whether a newer file has been queued for the slot since
+		@param	File to load */
+	LoadJob(SampleLoader& l, int slot, int request, const File& file)		:	ThreadPoolJob("Sample Load " + String(slot)),
+																				loader(l)
+	{
+		loaded.slot = slot;
+		loaded.request = request;
+		loaded.file = file;
+	}
+
+	//ThreadPoolJob
+	/** Overridden function inherited from ThreadPoolJob. Opens and decodes the file, unless a newer one has been
+		queued for the slot while this job waited, then passes the result back to the SampleLoader. */
+	JobStatus runJob() override
+	{
+		if (loader.isNewestRequest(loaded.slot, loaded.request) && !shouldExit())
+		{
+			loaded.reader.reset(loader.formatManager->createReaderFor(loaded.file));
+			if (loaded.reader == nullptr)
+			{
+				loaded.result = Result::fail("Couldn't open " + loaded.file.getFullPathName());
+			}
+			//short files are decoded here, or mapped from the cache at the device's rate - long ones keep their
+			//reader, to be streamed once back on the message thread
+			else if (SamplePool::shouldPreload(*loaded.reader))
+			{
+				loaded.sample = loader.sampleCache.getSample(loaded.file, *loaded.reader, loader.targetSampleRate.load());
+				loaded.reader = nullptr;
+			}
+		}
+
+		//every job reports back, even when it has been superseded, so the progress always reaches the end
+		loader.loadFinished(std::move(loaded));
+		return jobHasFinished;
+	}
+
+private:
+	SampleLoader& loader;
+	LoadedFile loaded;
+};
+
+SampleLoader::SampleLoader(std::array<FilePlayer, SamplePool::NumberOfSlots>& players)
+																		:	filePlayers(players),
+																			sampleCache(SampleCache::getDefaultDirectory()),
+																			targetSampleRate(0.0),
+																			numQueued(0),
+																			numFinished(0),
+																			threadPool(jmax(1, SystemStats::getNumCpus() - 1))
+{
+	for (auto& request : newestRequest)
+	{
+		request = 0;
+	}
+}
+
+SampleLoader::~SampleLoader()
+{
+	threadPool.removeAllJobs(true, 10000);
+	cancelPendingUpdate();
+}
+
+void SampleLoader::addListener(Listener* listener)
+{
+	listeners.add(listener);
+}
+
+void SampleLoader::removeListener(Listener* listener)
+{
+	listeners.remove(listener);
+}
+
+void SampleLoader::loadFile(int slot, const File& file)
+{
+	jassert(isPositiveAndBelow(slot, (int) SamplePool::NumberOfSlots));
+
+	//there is nothing to decode to empty a slot
+	if (file == File())
+	{
+		cancel(slot);
+		filePlayers[(size_t) slot].loadFile(file);
+		listeners.call([slot] (Listener& listener) { listener.sampleLoadFinished(slot, Result::ok()); });
+		return;
+	}
+
+	const int request = ++newestRequest[(size_t) slot];
+	numQueued++;
+	listeners.call([slot] (Listener& listener) { listener.sampleLoadStarted(slot); });
+	threadPool.addJob(new LoadJob(*this, slot, request, file), true);
+}
+
+void SampleLoader::setTargetSampleRate(double newSampleRate)
+{
+	targetSampleRate = newSampleRate;
+}
+
+void SampleLoader::cancel(int slot)
+{
+	jassert(isPositiveAndBelow(slot, (int) SamplePool::NumberOfSlots));
+	++newestRequest[(size_t) slot];
+}
+
+bool SampleLoader::isLoading() const
+{
+	return numFinished < numQueued;
+}
+
+double SampleLoader::getProgress() const
+{
+	return numQueued > 0 ? (double) numFinished / (double) numQueued : 1.0;
+}
+
+bool SampleLoader::isNewestRequest(int slot, int request) const
+{
+	return newestRequest[(size_t) slot].load() == request;
+}
+
+void SampleLoader::loadFinished(LoadedFile&& loaded)
+{
+	{
+		const ScopedLock lock(finishedLock);
+		finished.push_back(std::move(loaded));
+	}
+	triggerAsyncUpdate();
+}
+
+//AsyncUpdater
+void SampleLoader::handleAsyncUpdate()
+{
+	std::vector<LoadedFile> loadedFiles;
+	{
+		const ScopedLock lock(finishedLock);
+		loadedFiles.swap(finished);
+	}
+
+	for (auto& loaded : loadedFiles)
+	{
+		numFinished++;
+
+		//a slot given a newer file, or a sample of its own, since this one was queued keeps what it has
+		if (!isNewestRequest(loaded.slot, loaded.request))
+		{
+			continue;
+		}
+
+		FilePlayer& filePlayer = filePlayers[(size_t) loaded.slot];
+		if (loaded.sample != nullptr)
+		{
+			filePlayer.loadSample(loaded.sample, loaded.file);
+		}
+		else if (loaded.reader != nullptr)
+		{
+			filePlayer.loadStream(std::move(loaded.reader), loaded.file);
+		}
+		else
+		{
+			filePlayer.loadFile(File());
+		}
+
+		const int slot = loaded.slot;
+		const Result result = loaded.result;
+		listeners.call([slot, &result] (Listener& listener) { listener.sampleLoadFinished(slot, result); });
+	}
+
+	//a new batch starts counting from zero once everything queued has finished
+	if (numFinished >= numQueued)
+	{
+		numQueued = 0;
+		numFinished = 0;
+	}
+}
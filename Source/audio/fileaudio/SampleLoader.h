@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+	SampleLoader.h
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <vector>
+#include "FilePlayer.h"
+#include "SampleFormatManager.h"
+#include "SampleCache.h"
+
+/** Loads files into the FilePlayers in the background, so choosing a sample or opening a kit never freezes the
+	interface. Each file is opened and, if short enough to be preloaded, decoded - or found in the SampleCache - on a
+	ThreadPool with a thread for every core but one, so a whole kit decodes in parallel. Finished slots are handed to their FilePlayer back on the
+	message thread, where publishing to the audio thread already happens, so each slot switches over in one step once
+	it is ready. A slot given a new file while its last one is still loading only ever ends up with the newest. */
+
+class SampleLoader		:	private AsyncUpdater
+{
+public:
+	/** Constructor.
+		@param	reference to the FilePlayers to load into, one per slot, expected to outlive this object */
+	SampleLoader(std::array<FilePlayer, SamplePool::NumberOfSlots>& players);
+
+	/** Destructor. Waits for any file being decoded, and drops every load that has not finished. */
+	~SampleLoader();
+
+	/** Receives the progress of every load. Called on the message thread. */
+	class Listener
+	{
+	public:
+		/** Destructor. */
+		virtual ~Listener() {}
+
+		/** Called when a file has been queued to load into a slot.
+			@param	int slot the file is loading into */
+		virtual void sampleLoadStarted(int slot) = 0;
+
+		/** Called once a slot's newest file has been handed to its FilePlayer, or has failed to load - in which case the slot is left empty.
+			@param	int slot the file was loaded into
+			@param	Result describing why the file could not be loaded, if it could not */
+		virtual void sampleLoadFinished(int slot, const Result& result) = 0;
+	};
+
+	/** Adds a listener to be told about every load. Should only be called from the message thread.
+		@param	pointer to the Listener, expected to be removed before it is deleted */
+	void addListener(Listener* listener);
+
+	/** Removes a listener added with addListener. Should only be called from the message thread.
+		@param	pointer to the Listener */
+	void removeListener(Listener* listener);
+
+	/** Queues a file to be loaded into a slot, replacing anything still loading into it. Passing File() empties the
+		slot straight away. Should only be called from the message thread.
+		@param	int slot in the range of SamplePool::NumberOfSlots
+		@param	File to load */
+	void loadFile(int slot, const File& file);
+
+	/** Sets the rate files that are preloaded are converted to, normally that of the audio device. Files loaded
+		before a change keep their rate, and are still played at the right pitch. Safe to call from any thread.
+		@param	double sample rate, or 0 to keep each file's own rate */
+	void setTargetSampleRate(double newSampleRate);
+
+	/** Drops anything still loading into a slot, so its FilePlayer can be given a sample directly. Should only be
+		called from the message thread.
+		@param	int slot in the range of SamplePool::NumberOfSlots */
+	void cancel(int slot);
+
+	/** Returns true if any file queued since the last time every load finished is still loading. */
+	bool isLoading() const;
+
+	/** Returns how many of the files queued since the last time every load finished have finished, in the range 0 to 1. */
+	double getProgress() const;
+
+private:
+	class LoadJob;
+
+	/** What a LoadJob produced - a decoded sample, a reader to stream from or why the file could not be read. */
+	struct LoadedFile
+	{
+		int slot = 0;
+		int request = 0;
+		File file;
+		PooledSample::Ptr sample;
+		std::unique_ptr<AudioFormatReader> reader;
+		Result result { Result::ok() };
+	};
+
+	/** Returns true if the given request is still the newest for its slot. Safe to call from any thread. */
+	bool isNewestRequest(int slot, int request) const;
+
+	/** Passes a finished load to the message thread. Called from the thread the load ran on.
+		@param	LoadedFile holding the result */
+	void loadFinished(LoadedFile&& loaded);
+
+	//AsyncUpdater
+	/** Overridden function inherited from AsyncUpdater. Hands every finished load that is still the newest for its
+		slot to the slot's FilePlayer, and tells the listeners. */
+	void handleAsyncUpdate() override;
+
+	std::array<FilePlayer, SamplePool::NumberOfSlots>& filePlayers;
+	SharedResourcePointer<SampleFormatManager> formatManager;
+	SampleCache sampleCache;
+	std::atomic<double> targetSampleRate;
+	std::array<std::atomic<int>, SamplePool::NumberOfSlots> newestRequest;
+	int numQueued;
+	int numFinished;
+	ListenerList<Listener> listeners;
+
+	CriticalSection finishedLock;
+	std::vector<LoadedFile> finished;
+
+	ThreadPool threadPool;
+
+	JUCE_DECLARE_NON_COPYABLE(SampleLoader)
+};
@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+	SamplePool.cpp
+  ==============================================================================
+*/
+
+#include "SamplePool.h"
+
+PooledSample::PooledSample()		:	sampleRate(44100.0)
+{
+
+}
+
+PooledSample::PooledSample(AudioFormatReader& reader)		:	sampleRate(reader.sampleRate)
+{
+	//decodes the whole file in one go - stereo files keep both channels, anything wider is cut down to two
+	const int numChannels = jlimit(1, 2, (int) reader.numChannels);
+	const int length = (int) reader.lengthInSamples;
+
+	data.setSize(numChannels, length);
+	reader.read(&data, 0, length, 0, true, numChannels > 1);
+}
+
+PooledSample::PooledSample(AudioBuffer<float>&& decodedData, double rate)		:	data(std::move(decodedData)),
+																					sampleRate(rate)
+{
+	jassert(data.getNumChannels() <= 2);
+}
+
+PooledSample::PooledSample(std::shared_ptr<MemoryMappedFile> mapping, const float* const* channels, int numChannels, int length, double rate)
+																			:	data(const_cast<float* const*>(channels), jlimit(1, 2, numChannels), length),
+																				sampleRate(rate),
+																				mappedFile(std::move(mapping))
+{
+	//the buffer refers to the read-only mapping rather than owning a copy - PooledSamples are never written to once created
+}
+
+PooledSample::~PooledSample()
+{
+
+}
+
+bool PooledSample::isEmpty() const noexcept
+{
+	return data.getNumSamples() == 0;
+}
+
+int PooledSample::getLengthInSamples() const noexcept
+{
+	return data.getNumSamples();
+}
+
+double PooledSample::getSampleRate() const noexcept
+{
+	return sampleRate;
+}
+
+const AudioBuffer<float>& PooledSample::getData() const noexcept
+{
+	return data;
+}
+
+bool PooledSample::isMappedFrom(const MemoryMappedFile& mapping) const noexcept
+{
+	return mappedFile.get() == &mapping;
+}
+
+SamplePool::SamplePool()
+{
+	//every slot starts with an empty sample, so the audio thread never has to check for nullptr
+	for (auto& slot : slots)
+	{
+		slot.publish(new PooledSample());
+	}
+}
+
+SamplePool::~SamplePool()
+{
+
+}
+
+bool SamplePool::shouldPreload(const AudioFormatReader& reader)
+{
+	return reader.lengthInSamples <= (int64) (reader.sampleRate * MaximumPreloadLengthInSeconds);
+}
+
+void SamplePool::loadSample(int slot, AudioFormatReader& reader)
+{
+	jassert(isPositiveAndBelow(slot, (int) NumberOfSlots));
+	slots[(size_t) slot].publish(new PooledSample(reader));
+}
+
+void SamplePool::setSample(int slot, PooledSample::Ptr sample)
+{
+	jassert(isPositiveAndBelow(slot, (int) NumberOfSlots) && sample != nullptr);
+	slots[(size_t) slot].publish(sample);
+}
+
+void SamplePool::clearSample(int slot)
+{
+	jassert(isPositiveAndBelow(slot, (int) NumberOfSlots));
+	slots[(size_t) slot].publish(new PooledSample());
+}
+
+PooledSample::Ptr SamplePool::getSample(int slot) const
+{
+	jassert(isPositiveAndBelow(slot, (int) NumberOfSlots));
+	return slots[(size_t) slot].getLatest();
+}
+
+const PooledSample* SamplePool::acquire(int slot) noexcept
+{
+	jassert(isPositiveAndBelow(slot, (int) NumberOfSlots));
+	return slots[(size_t) slot].acquire();
+}
+
+void SamplePool::collectGarbage()
+{
+	for (auto& slot : slots)
+	{
+		slot.collectGarbage();
+	}
+}
@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+	SamplePool.h
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include "../SnapshotExchange.h"
+
+/** A sample decoded fully into memory, along with the sample rate it was recorded at. Immutable once published. */
+
+class PooledSample		:	public ReferenceCountedObject
+{
+public:
+	typedef ReferenceCountedObjectPtr<PooledSample> Ptr;
+
+	/** Constructor. Creates an empty sample. */
+	PooledSample();
+
+	/** Constructor. Decodes every sample the reader holds into a contiguous float buffer (at most two channels).
+		@param	reference to the AudioFormatReader to decode */
+	PooledSample(AudioFormatReader& reader);
+
+	/** Constructor. Takes over audio already decoded by the caller, such as a sample imported from a module.
+		@param	AudioBuffer holding one or two channels of audio, moved into this object
+		@param	double sample rate the audio was recorded at */
+	PooledSample(AudioBuffer<float>&& decodedData, double rate);
+
+	/** Constructor. Refers to audio already decoded into a memory-mapped file, such as a project with embedded
+		samples, without copying it. The mapping is kept open for as long as this sample is alive.
+		@param	shared pointer to the MemoryMappedFile holding the audio
+		@param	array of pointers to the first sample of each channel within the mapping
+		@param	int number of channels, 1 or 2
+		@param	int number of samples in each channel
+		@param	double sample rate the audio was recorded at */
+	PooledSample(std::shared_ptr<MemoryMappedFile> mapping, const float* const* channels, int numChannels, int length, double rate);
+
+	/** Destructor. */
+	~PooledSample();
+
+	/** Returns true if this sample holds any audio. */
+	bool isEmpty() const noexcept;
+
+	/** Returns the number of samples in each channel of this sample. */
+	int getLengthInSamples() const noexcept;
+
+	/** Returns the sample rate the audio was recorded at. */
+	double getSampleRate() const noexcept;
+
+	/** Returns the decoded audio. */
+	const AudioBuffer<float>& getData() const noexcept;
+
+	/** Returns true if this sample's audio lies in the given memory-mapped file rather than in memory of its own.
+		@param	reference to the MemoryMappedFile to check */
+	bool isMappedFrom(const MemoryMappedFile& mapping) const noexcept;
+
+private:
+	AudioBuffer<float> data;
+	double sampleRate;
+	std::shared_ptr<MemoryMappedFile> mappedFile;
+};
+
+/** Holds a decoded copy of every sample short enough to be preloaded, one per slot. Samples are published from the
+	message thread - usually once a SampleLoader has decoded them in the background - and handed to the audio thread
+	through a SnapshotExchange, so a slot can be reloaded while it is playing without locking. */
+
+class SamplePool
+{
+public:
+	/** Constructor. */
+	SamplePool();
+
+	/** Destructor. */
+	~SamplePool();
+
+	/** Holds the number of sample slots, and the length beyond which files are streamed from disk instead. */
+	enum
+	{
+		NumberOfSlots = 32,
+		MaximumPreloadLengthInSeconds = 30
+	};
+
+	/** Returns true if the file behind the given reader is short enough to be decoded into the pool.
+		@param	reference to an AudioFormatReader for the file
+		@return	bool true if the file should be preloaded, false if it should be streamed */
+	static bool shouldPreload(const AudioFormatReader& reader);
+
+	/** Decodes the whole of the given reader into the slot, replacing what it held. Should only be called from the message thread.
+		@param	int slot in the range of NumberOfSlots
+		@param	reference to an AudioFormatReader for the file to decode */
+	void loadSample(int slot, AudioFormatReader& reader);
+
+	/** Places an already decoded sample in the slot, replacing what it held. Should only be called from the message thread.
+		@param	int slot in the range of NumberOfSlots
+		@param	PooledSample::Ptr to the sample, which must not be nullptr */
+	void setSample(int slot, PooledSample::Ptr sample);
+
+	/** Empties the slot. Should only be called from the message thread.
+		@param	int slot in the range of NumberOfSlots */
+	void clearSample(int slot);
+
+	/** Returns the sample most recently loaded into the slot. Should only be called from the message thread.
+		@param	int slot in the range of NumberOfSlots
+		@return	PooledSample::Ptr to the sample, never nullptr */
+	PooledSample::Ptr getSample(int slot) const;
+
+	/** Returns the sample the audio thread should play from the slot, picking up any newly loaded sample.
+		Never blocks or allocates. Should only be called from the audio thread.
+		@param	int slot in the range of NumberOfSlots
+		@return	pointer to the sample, never nullptr */
+	const PooledSample* acquire(int slot) noexcept;
+
+	/** Frees the samples the audio thread has finished with. Should be called regularly from the message thread. */
+	void collectGarbage();
+
+private:
+	std::array<SnapshotExchange<PooledSample>, NumberOfSlots> slots;
+};
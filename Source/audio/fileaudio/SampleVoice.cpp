@@ -0,0 +1,242 @@
+/*
+  ==============================================================================
+	SampleVoice.cpp
+  ==============================================================================
+*/
+
+#include "SampleVoice.h"
+
+SampleVoice::SampleVoice()		:	sample(nullptr),
+									position(0.0),
+									increment(1.0),
+									targetIncrement(1.0),
+									incrementRampRemaining(0),
+									rateRatio(1.0),
+									gain(1.f),
+									targetGain(1.f),
+									gainRampRemaining(0),
+									rampLength(1),
+									stopping(false),
+									looping(false),
+									interpolationMode(SampleInterpolator::Linear)
+{
+
+}
+
+SampleVoice::~SampleVoice()
+{
+
+}
+
+int SampleVoice::start(const PooledSample& sampleToPlay, double pitchRatio, float newGain, double outputSampleRate, int startOffset) noexcept
+{
+	rampLength = jmax(1, roundToInt(outputSampleRate * DeclickMilliseconds / 1000.0));
+
+	//the note already playing becomes a tail, and fades out from where it is rather than stopping dead - a tail still
+	//fading from the last retrigger is left to finish, unless both are, when the quieter one gives way
+	const bool wasSounding = sample != nullptr;
+	int tailIndex = -1;
+	if (wasSounding)
+	{
+		tailIndex = 0;
+		for (int i = 0; i < NumberOfTails; i++)
+		{
+			const Tail& candidate = tails[(size_t) i];
+			if (candidate.sample == nullptr)
+			{
+				tailIndex = i;
+				break;
+			}
+			if (candidate.gain < tails[(size_t) tailIndex].gain)
+			{
+				tailIndex = i;
+			}
+		}
+
+		Tail& tail = tails[(size_t) tailIndex];
+		tail.sample = sample;
+		tail.position = position;
+		tail.increment = increment;
+		tail.gain = gain;
+		tail.looping = looping;
+		tail.samplesRemaining = rampLength;
+	}
+
+	//an empty sample has nothing to play, and neither does one started past its end
+	if (sampleToPlay.isEmpty() || startOffset >= sampleToPlay.getLengthInSamples())
+	{
+		sample = nullptr;
+		return tailIndex;
+	}
+
+	sample = &sampleToPlay;
+	position = (double) jmax(0, startOffset);
+	//the pitch ratio is relative to the sample's own rate, so convert it to a step through the sample per output sample
+	rateRatio = sampleToPlay.getSampleRate() / outputSampleRate;
+	increment = pitchRatio * rateRatio;
+	targetIncrement = increment;
+	incrementRampRemaining = 0;
+	stopping = false;
+
+	//a sample starts from silence at its beginning - only a note cut in over another, or started part way, fades in
+	const bool fadeIn = wasSounding || startOffset > 0;
+	gain = fadeIn ? 0.f : newGain;
+	targetGain = newGain;
+	gainRampRemaining = fadeIn ? rampLength : 0;
+	return tailIndex;
+}
+
+void SampleVoice::stop() noexcept
+{
+	if (sample != nullptr && !stopping)
+	{
+		stopping = true;
+		targetGain = 0.f;
+		gainRampRemaining = rampLength;
+	}
+}
+
+void SampleVoice::stopImmediately() noexcept
+{
+	sample = nullptr;
+}
+
+void SampleVoice::stopTail(int tailIndex) noexcept
+{
+	jassert(isPositiveAndBelow(tailIndex, (int) NumberOfTails));
+	tails[(size_t) tailIndex].sample = nullptr;
+	tails[(size_t) tailIndex].samplesRemaining = 0;
+}
+
+bool SampleVoice::isActive() const noexcept
+{
+	if (sample != nullptr)
+	{
+		return true;
+	}
+	for (auto& tail : tails)
+	{
+		if (tail.sample != nullptr)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool SampleVoice::isPlaying() const noexcept
+{
+	return sample != nullptr && !stopping;
+}
+
+const PooledSample* SampleVoice::getSample() const noexcept
+{
+	return sample;
+}
+
+const PooledSample* SampleVoice::getTailSample(int tailIndex) const noexcept
+{
+	jassert(isPositiveAndBelow(tailIndex, (int) NumberOfTails));
+	return tails[(size_t) tailIndex].sample;
+}
+
+void SampleVoice::setGain(float newGain) noexcept
+{
+	if (!stopping && newGain != targetGain)
+	{
+		targetGain = newGain;
+		gainRampRemaining = rampLength;
+	}
+}
+
+float SampleVoice::getGain() const noexcept
+{
+	return targetGain;
+}
+
+void SampleVoice::setPitchRatio(double pitchRatio) noexcept
+{
+	const double newIncrement = pitchRatio * rateRatio;
+	if (newIncrement != targetIncrement)
+	{
+		targetIncrement = newIncrement;
+		incrementRampRemaining = rampLength;
+	}
+}
+
+void SampleVoice::setLooping(bool shouldLoop) noexcept
+{
+	looping = shouldLoop;
+}
+
+void SampleVoice::setInterpolationMode(SampleInterpolator::Mode newMode) noexcept
+{
+	interpolationMode = newMode;
+}
+
+void SampleVoice::renderNextBlock(AudioBuffer<float>& outputBuffer, int startSample, int numSamples) noexcept
+{
+	//the notes cut off by the last retriggers fade out underneath the new one
+	for (int i = 0; i < NumberOfTails; i++)
+	{
+		Tail& tail = tails[(size_t) i];
+		if (tail.sample == nullptr)
+		{
+			continue;
+		}
+
+		const int count = jmin(numSamples, tail.samplesRemaining);
+		const float endGain = tail.gain * (float) (tail.samplesRemaining - count) / (float) tail.samplesRemaining;
+		const bool tailContinues = SampleInterpolator::render(interpolationMode, tail.sample->getData(), tail.looping, tail.position,
+			tail.increment, tail.increment, tail.gain, endGain, outputBuffer, startSample, count);
+		tail.gain = endGain;
+		tail.samplesRemaining -= count;
+		if (!tailContinues || tail.samplesRemaining == 0)
+		{
+			stopTail(i);
+		}
+	}
+
+	//the block is split where a ramp ends, so within each section the gain and pitch move in a straight line
+	int i = 0;
+	while (sample != nullptr && i < numSamples)
+	{
+		int count = numSamples - i;
+		if (gainRampRemaining > 0)
+		{
+			count = jmin(count, gainRampRemaining);
+		}
+		if (incrementRampRemaining > 0)
+		{
+			count = jmin(count, incrementRampRemaining);
+		}
+
+		const float endGain = gainRampRemaining > 0 ? gain + (targetGain - gain) * (float) count / (float) gainRampRemaining : gain;
+		const double endIncrement = incrementRampRemaining > 0 ? increment + (targetIncrement - increment) * count / incrementRampRemaining : increment;
+
+		//reads straight from the decoded sample - ends playback when a sample that does not loop runs out
+		const bool noteContinues = SampleInterpolator::render(interpolationMode, sample->getData(), looping, position,
+			increment, endIncrement, gain, endGain, outputBuffer, startSample + i, count);
+
+		gain = endGain;
+		increment = endIncrement;
+		//the end of a ramp lands exactly on its target, whatever rounding the steps took
+		if (gainRampRemaining > 0)
+		{
+			gainRampRemaining -= count;
+			gain = gainRampRemaining == 0 ? targetGain : gain;
+		}
+		if (incrementRampRemaining > 0)
+		{
+			incrementRampRemaining -= count;
+			increment = incrementRampRemaining == 0 ? targetIncrement : increment;
+		}
+
+		//a stopped note ends once it has faded to silence
+		if (!noteContinues || (stopping && gainRampRemaining == 0))
+		{
+			sample = nullptr;
+		}
+		i += count;
+	}
+}
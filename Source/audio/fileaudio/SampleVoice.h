@@ -0,0 +1,126 @@
+/*
+  ==============================================================================
+	SampleVoice.h
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include "SamplePool.h"
+#include "SampleInterpolator.h"
+
+/** Plays a PooledSample straight from memory. Starting or retriggering a voice only resets its read position,
+	so it never touches the disk and costs the same however long the sample is. Nothing the voice does is heard as a
+	step: gain and pitch changes are ramped over DeclickMilliseconds, a stopped note fades out over the same time, and
+	a note cut off by a retrigger carries on as a tail that fades out while the new note fades in - a voice keeps two
+	tails, so retriggering again before the last tail has faded does not cut it dead. Each block is
+	rendered in at most a few sections, one per ramp, so the ramps cost nothing per sample beyond the gain itself.
+	Should only be used from the audio thread. */
+
+class SampleVoice
+{
+public:
+	/** Constructor. */
+	SampleVoice();
+
+	/** Destructor. */
+	~SampleVoice();
+
+	/** Holds the time every change of gain or pitch, and every fade in or out, is ramped over, and the number of
+		notes cut off by retriggers that can fade out at once. */
+	enum
+	{
+		DeclickMilliseconds = 2,
+		NumberOfTails = 2
+	};
+
+	/** Starts playing the given sample. Anything this voice was playing fades out alongside it on a free tail - or, if
+		both are still fading, on the quieter one - and the new note fades in unless it starts from the beginning of a
+		voice that was silent.
+		@param	reference to the PooledSample to play, which must stay alive while the voice is playing it
+		@param	double playback rate relative to the sample's original pitch
+		@param	float gain to play the sample at
+		@param	double sample rate of the output device
+		@param	int sample to start from - the voice does not start if this is past the end of the sample
+		@return	int index of the tail the note cut off fades out on, or -1 if no note was cut off */
+	int start(const PooledSample& sampleToPlay, double pitchRatio, float newGain, double outputSampleRate, int startOffset = 0) noexcept;
+
+	/** Fades the note out, ending it once it is silent. */
+	void stop() noexcept;
+
+	/** Ends the note straight away, without fading it out - for when the sample it reads is about to be freed.
+		Any tail is left to fade out. */
+	void stopImmediately() noexcept;
+
+	/** Ends a tail straight away - for when the sample it reads is about to be freed.
+		@param	int index of the tail, in the range of NumberOfTails */
+	void stopTail(int tailIndex) noexcept;
+
+	/** Returns true if the voice has anything left to render - a note, even one fading out, or any tail. */
+	bool isActive() const noexcept;
+
+	/** Returns true if the voice is playing a note that has not been stopped. */
+	bool isPlaying() const noexcept;
+
+	/** Returns the sample the note reads, or nullptr if there is no note. */
+	const PooledSample* getSample() const noexcept;
+
+	/** Returns the sample a tail reads, or nullptr if the tail has faded out.
+		@param	int index of the tail, in the range of NumberOfTails */
+	const PooledSample* getTailSample(int tailIndex) const noexcept;
+
+	/** Ramps the gain of the note to a new value. Does nothing to a note that is fading out.
+		@param	float new gain value */
+	void setGain(float newGain) noexcept;
+
+	/** Returns the gain the note is heading for - 0 if it is fading out. */
+	float getGain() const noexcept;
+
+	/** Ramps the playback rate of the note to a new value, without moving its read position.
+		@param	double playback rate relative to the sample's original pitch */
+	void setPitchRatio(double pitchRatio) noexcept;
+
+	/** Sets whether the voice jumps back to the start of the sample when it reaches the end.
+		@param	bool new looping state - true is loop, false is do not loop */
+	void setLooping(bool shouldLoop) noexcept;
+
+	/** Sets how the voice reads between the samples of its sample when it is pitched.
+		@param	SampleInterpolator::Mode new interpolation mode */
+	void setInterpolationMode(SampleInterpolator::Mode newMode) noexcept;
+
+	/** Adds the next section of the sample into the given buffer, read with the voice's SampleInterpolator mode.
+		Mono samples are added to every output channel.
+		@param	reference to the AudioBuffer to add to
+		@param	int first sample of the buffer to add to
+		@param	int number of samples to add */
+	void renderNextBlock(AudioBuffer<float>& outputBuffer, int startSample, int numSamples) noexcept;
+
+private:
+	/** A note cut off by a retrigger, fading out over its last few milliseconds. */
+	struct Tail
+	{
+		const PooledSample* sample = nullptr;
+		double position = 0.0;
+		double increment = 1.0;
+		float gain = 0.f;
+		bool looping = false;
+		int samplesRemaining = 0;
+	};
+
+	const PooledSample* sample;
+	double position;
+	double increment;
+	double targetIncrement;
+	int incrementRampRemaining;
+	double rateRatio;
+	float gain;
+	float targetGain;
+	int gainRampRemaining;
+	int rampLength;
+	bool stopping;
+	bool looping;
+	SampleInterpolator::Mode interpolationMode;
+	std::array<Tail, NumberOfTails> tails;
+};
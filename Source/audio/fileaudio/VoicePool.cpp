@@ -0,0 +1,343 @@
+/*
+  ==============================================================================
+	VoicePool.cpp
+  ==============================================================================
+*/
+
+#include "VoicePool.h"
+
+VoicePool::VoicePool()		:	outputSampleRate(44100.0),
+								nextStartOrder(0),
+								numActiveVoices(0),
+								stealingPolicy(StealOldest),
+								interpolationMode(SampleInterpolator::Linear)
+{
+	voiceSlots.fill(-1);
+	for (auto& tailSlots : voiceTailSlots)
+	{
+		tailSlots.fill(-1);
+	}
+	voiceStartOrders.fill(0);
+	activeVoices.fill(0);
+	voiceIsListed.fill(false);
+
+	for (int slot = 0; slot < SamplePool::NumberOfSlots; slot++)
+	{
+		slotLooping[(size_t) slot] = false;
+		slotMonophonic[(size_t) slot] = false;
+		slotVoiceCounts[(size_t) slot] = 0;
+	}
+}
+
+VoicePool::~VoicePool()
+{
+
+}
+
+void VoicePool::setSamplePool(SamplePool* pool)
+{
+	samplePool = pool;
+}
+
+void VoicePool::setSamples(const std::array<PooledSample::Ptr, SamplePool::NumberOfSlots>& samples)
+{
+	samplePool = nullptr;
+	fixedSamples = samples;
+}
+
+void VoicePool::setStealingPolicy(StealingPolicy newPolicy)
+{
+	stealingPolicy = newPolicy;
+}
+
+VoicePool::StealingPolicy VoicePool::getStealingPolicy() const
+{
+	return (StealingPolicy) stealingPolicy.load();
+}
+
+void VoicePool::setInterpolationMode(SampleInterpolator::Mode newMode)
+{
+	interpolationMode = newMode;
+}
+
+SampleInterpolator::Mode VoicePool::getInterpolationMode() const
+{
+	return (SampleInterpolator::Mode) interpolationMode.load();
+}
+
+void VoicePool::setSlotLooping(int slot, bool shouldLoop)
+{
+	jassert(isPositiveAndBelow(slot, (int) SamplePool::NumberOfSlots));
+	slotLooping[(size_t) slot] = shouldLoop;
+}
+
+void VoicePool::setSlotMonophonic(int slot, bool shouldBeMonophonic)
+{
+	jassert(isPositiveAndBelow(slot, (int) SamplePool::NumberOfSlots));
+	slotMonophonic[(size_t) slot] = shouldBeMonophonic;
+}
+
+bool VoicePool::isSlotPlaying(int slot) const
+{
+	jassert(isPositiveAndBelow(slot, (int) SamplePool::NumberOfSlots));
+	return slotVoiceCounts[(size_t) slot] > 0;
+}
+
+VoicePool::VoiceHandle VoicePool::startVoice(int slot, double pitchRatio, float gain, int startOffset) noexcept
+{
+	VoiceHandle handle;
+	if (!isPositiveAndBelow(slot, (int) SamplePool::NumberOfSlots))
+	{
+		return handle;
+	}
+
+	//an empty slot has nothing to play - don't take a voice from a note that is still sounding
+	const PooledSample* sample = getSlotSample(slot);
+	if (sample == nullptr || sample->isEmpty())
+	{
+		return handle;
+	}
+
+	if (slotMonophonic[(size_t) slot].load(std::memory_order_relaxed))
+	{
+		stopSlot(slot);
+	}
+
+	//the note cut off, if any, fades out as one of the voice's tails - the tail's slot is kept so a reload can still stop it
+	const int index = findVoiceToStart();
+	const int tailIndex = voices[(size_t) index].start(*sample, pitchRatio, gain, outputSampleRate, startOffset);
+	if (tailIndex >= 0)
+	{
+		voiceTailSlots[(size_t) index][(size_t) tailIndex] = voiceSlots[(size_t) index];
+	}
+	voiceSlots[(size_t) index] = slot;
+	voiceStartOrders[(size_t) index] = nextStartOrder++;
+	addActiveVoice(index);
+
+	handle.index = index;
+	handle.startOrder = voiceStartOrders[(size_t) index];
+	return handle;
+}
+
+bool VoicePool::isVoicePlaying(const VoiceHandle& handle) const noexcept
+{
+	return isPositiveAndBelow(handle.index, (int) NumberOfVoices)
+		&& voiceStartOrders[(size_t) handle.index] == handle.startOrder
+		&& voices[(size_t) handle.index].isPlaying();
+}
+
+void VoicePool::setVoicePitch(const VoiceHandle& handle, double pitchRatio) noexcept
+{
+	if (auto* voice = getVoice(handle))
+	{
+		voice->setPitchRatio(pitchRatio);
+	}
+}
+
+void VoicePool::setVoiceGain(const VoiceHandle& handle, float gain) noexcept
+{
+	if (auto* voice = getVoice(handle))
+	{
+		voice->setGain(gain);
+	}
+}
+
+void VoicePool::stopVoice(const VoiceHandle& handle) noexcept
+{
+	if (auto* voice = getVoice(handle))
+	{
+		voice->stop();
+	}
+}
+
+void VoicePool::stopSlot(int slot) noexcept
+{
+	for (int i = 0; i < NumberOfVoices; i++)
+	{
+		if (voiceSlots[(size_t) i] == slot)
+		{
+			voices[(size_t) i].stop();
+		}
+	}
+}
+
+int VoicePool::findVoiceToStart() const noexcept
+{
+	const bool stealQuietest = stealingPolicy.load(std::memory_order_relaxed) == StealQuietest;
+	int candidate = 0;
+	int fadingVoice = -1;
+
+	for (int i = 0; i < NumberOfVoices; i++)
+	{
+		const SampleVoice& voice = voices[(size_t) i];
+
+		//a free voice is always used first, then one that is already fading out
+		if (!voice.isActive())
+		{
+			return i;
+		}
+		if (!voice.isPlaying())
+		{
+			fadingVoice = fadingVoice < 0 ? i : fadingVoice;
+			continue;
+		}
+
+		if (stealQuietest)
+		{
+			//ties go to the older voice
+			const float gain = voice.getGain();
+			const float candidateGain = voices[(size_t) candidate].getGain();
+			if (gain < candidateGain || (gain == candidateGain && voiceStartOrders[(size_t) i] < voiceStartOrders[(size_t) candidate]))
+			{
+				candidate = i;
+			}
+		}
+		else if (voiceStartOrders[(size_t) i] < voiceStartOrders[(size_t) candidate])
+		{
+			candidate = i;
+		}
+	}
+	return fadingVoice >= 0 ? fadingVoice : candidate;
+}
+
+SampleVoice* VoicePool::getVoice(const VoiceHandle& handle) noexcept
+{
+	//a voice stolen since the handle was made has started again, so its start order no longer matches
+	return isVoicePlaying(handle) ? &voices[(size_t) handle.index] : nullptr;
+}
+
+void VoicePool::addActiveVoice(int index) noexcept
+{
+	if (!voiceIsListed[(size_t) index])
+	{
+		voiceIsListed[(size_t) index] = true;
+		activeVoices[(size_t) numActiveVoices++] = index;
+	}
+}
+
+const PooledSample* VoicePool::getSlotSample(int slot) noexcept
+{
+	if (samplePool != nullptr)
+	{
+		return samplePool->acquire(slot);
+	}
+	return fixedSamples[(size_t) slot].get();
+}
+
+//AudioSource
+void VoicePool::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+	outputSampleRate = sampleRate;
+}
+
+void VoicePool::releaseResources()
+{
+	for (auto& voice : voices)
+	{
+		voice.stopImmediately();
+		for (int tail = 0; tail < SampleVoice::NumberOfTails; tail++)
+		{
+			voice.stopTail(tail);
+		}
+	}
+}
+
+void VoicePool::getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill)
+{
+	bufferToFill.clearActiveBufferRegion();
+	renderVoices(0, beginBlock(), *bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
+	endBlock();
+}
+
+int VoicePool::beginBlock() noexcept
+{
+	const auto mode = (SampleInterpolator::Mode) interpolationMode.load(std::memory_order_relaxed);
+
+	//only the listed voices are visited - the SamplePool is read here, on the audio thread, never while rendering
+	for (int n = 0; n < numActiveVoices; n++)
+	{
+		const int i = activeVoices[(size_t) n];
+		SampleVoice& voice = voices[(size_t) i];
+
+		//if the slot has been reloaded, the voice must stop reading the sample it was given before - at once, as the
+		//sample may be freed as soon as this block ends
+		const int slot = voiceSlots[(size_t) i];
+		if (voice.getSample() != nullptr && voice.getSample() != getSlotSample(slot))
+		{
+			voice.stopImmediately();
+		}
+		for (int tail = 0; tail < SampleVoice::NumberOfTails; tail++)
+		{
+			const PooledSample* tailSample = voice.getTailSample(tail);
+			if (tailSample != nullptr && tailSample != getSlotSample(voiceTailSlots[(size_t) i][(size_t) tail]))
+			{
+				voice.stopTail(tail);
+			}
+		}
+
+		if (voice.getSample() != nullptr)
+		{
+			voice.setLooping(slotLooping[(size_t) slot].load(std::memory_order_relaxed));
+			voice.setInterpolationMode(mode);
+		}
+	}
+	return numActiveVoices;
+}
+
+void VoicePool::renderVoices(int firstVoice, int endVoice, AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept
+{
+	jassert(firstVoice >= 0 && endVoice <= numActiveVoices);
+	for (int n = firstVoice; n < endVoice; n++)
+	{
+		SampleVoice& voice = voices[(size_t) activeVoices[(size_t) n]];
+		if (voice.isActive())
+		{
+			voice.renderNextBlock(buffer, startSample, numSamples);
+		}
+	}
+}
+
+void VoicePool::endBlock() noexcept
+{
+	std::array<int, SamplePool::NumberOfSlots> counts;
+	counts.fill(0);
+
+	//voices that have finished are dropped from the list as they are found
+	int numStillActive = 0;
+	for (int n = 0; n < numActiveVoices; n++)
+	{
+		const int i = activeVoices[(size_t) n];
+		const SampleVoice& voice = voices[(size_t) i];
+		if (voice.isActive())
+		{
+			//a voice with only a tail left is still rendered, but no longer counts as playing its slot
+			if (voice.getSample() != nullptr)
+			{
+				counts[(size_t) voiceSlots[(size_t) i]]++;
+			}
+			activeVoices[(size_t) numStillActive++] = i;
+		}
+		else
+		{
+			voiceIsListed[(size_t) i] = false;
+		}
+	}
+	numActiveVoices = numStillActive;
+
+	//publishes how many voices each slot is playing on, for the interface
+	for (int slot = 0; slot < SamplePool::NumberOfSlots; slot++)
+	{
+		slotVoiceCounts[(size_t) slot].store(counts[(size_t) slot], std::memory_order_relaxed);
+	}
+}
+
+void VoicePool::takeLatestSamples() noexcept
+{
+	//every slot is picked up, not only those with a voice, so the pool no longer holds any sample it has replaced
+	for (int slot = 0; slot < SamplePool::NumberOfSlots; slot++)
+	{
+		getSlotSample(slot);
+	}
+	beginBlock();
+	endBlock();
+}
@@ -0,0 +1,187 @@
+/*
+  ==============================================================================
+	VoicePool.h
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include "SamplePool.h"
+#include "SampleVoice.h"
+
+/** A fixed number of SampleVoices shared by every preloaded sample, so a sample can sound on several voices
+	at once - retriggering it no longer cuts off the note already playing. All voices are allocated up front:
+	starting a note never locks or allocates. When every voice is busy, one still fading out is reused first, then
+	one is stolen according to the StealingPolicy - either way the note cut off fades out underneath the new one. Apart from the policy and state getters, every method should only be called from the audio thread. */
+
+class VoicePool		:	public AudioSource
+{
+public:
+	/** Constructor. */
+	VoicePool();
+
+	/** Destructor. */
+	~VoicePool();
+
+	/** Holds the number of voices that can sound at once. */
+	enum
+	{
+		NumberOfVoices = 64
+	};
+
+	/** Ways of choosing the voice to cut off when every voice is busy. */
+	enum StealingPolicy
+	{
+		StealOldest = 0,	/**< steals the voice that started longest ago */
+		StealQuietest		/**< steals the voice playing at the lowest gain */
+	};
+
+	/** Refers to the note started on one voice. A handle stops referring to its voice once the note ends or the
+		voice is stolen for another, so a note can be changed after it starts without touching whatever replaced it. */
+	struct VoiceHandle
+	{
+		int index = -1;
+		uint64 startOrder = 0;
+	};
+
+	/** Passes this object the SamplePool its voices play from.
+		@param	pointer to a SamplePool, expected to outlive this object */
+	void setSamplePool(SamplePool* pool);
+
+	/** Gives this object a fixed set of samples to play from instead of a SamplePool - used when rendering
+		away from the audio thread, where the pool's exchange must not be touched. Call before rendering.
+		@param	array holding the sample for each slot, none of which may be nullptr */
+	void setSamples(const std::array<PooledSample::Ptr, SamplePool::NumberOfSlots>& samples);
+
+	/** Sets the policy used to choose a voice to steal. Safe to call from any thread.
+		@param	StealingPolicy new policy */
+	void setStealingPolicy(StealingPolicy newPolicy);
+
+	/** Returns the policy used to choose a voice to steal. Safe to call from any thread. */
+	StealingPolicy getStealingPolicy() const;
+
+	/** Sets how every voice reads between samples when pitched. Safe to call from any thread.
+		@param	SampleInterpolator::Mode new interpolation mode */
+	void setInterpolationMode(SampleInterpolator::Mode newMode);
+
+	/** Returns how every voice reads between samples when pitched. Safe to call from any thread. */
+	SampleInterpolator::Mode getInterpolationMode() const;
+
+	/** Sets whether voices playing the given slot loop. Safe to call from any thread.
+		@param	int slot in the range of SamplePool::NumberOfSlots
+		@param	bool new looping state */
+	void setSlotLooping(int slot, bool shouldLoop);
+
+	/** Sets whether starting the given slot cuts off the voices already playing it. Safe to call from any thread.
+		@param	int slot in the range of SamplePool::NumberOfSlots
+		@param	bool true to play at most one voice of the slot at a time */
+	void setSlotMonophonic(int slot, bool shouldBeMonophonic);
+
+	/** Returns true if any voice was playing the given slot at the end of the last rendered block.
+		Safe to call from any thread.
+		@param	int slot in the range of SamplePool::NumberOfSlots */
+	bool isSlotPlaying(int slot) const;
+
+	/** Starts the given slot on a free voice, stealing one if none are free. The note is heard from the
+		start of the next block rendered.
+		@param	int slot in the range of SamplePool::NumberOfSlots
+		@param	double playback rate relative to the sample's original pitch
+		@param	float gain to play the sample at
+		@param	int sample to start from
+		@return	VoiceHandle referring to the note, which refers to no voice if the slot holds no preloaded sample */
+	VoiceHandle startVoice(int slot, double pitchRatio, float gain, int startOffset = 0) noexcept;
+
+	/** Returns true if the note the handle refers to is still playing.
+		@param	VoiceHandle returned by startVoice */
+	bool isVoicePlaying(const VoiceHandle& handle) const noexcept;
+
+	/** Sets the playback rate of a note that is playing. Does nothing if the note has ended.
+		@param	VoiceHandle returned by startVoice
+		@param	double playback rate relative to the sample's original pitch */
+	void setVoicePitch(const VoiceHandle& handle, double pitchRatio) noexcept;
+
+	/** Sets the gain of a note that is playing. Does nothing if the note has ended.
+		@param	VoiceHandle returned by startVoice
+		@param	float gain to play the sample at */
+	void setVoiceGain(const VoiceHandle& handle, float gain) noexcept;
+
+	/** Fades out a note that is playing. Does nothing if the note has ended.
+		@param	VoiceHandle returned by startVoice */
+	void stopVoice(const VoiceHandle& handle) noexcept;
+
+	/** Fades out every voice playing the given slot.
+		@param	int slot in the range of SamplePool::NumberOfSlots */
+	void stopSlot(int slot) noexcept;
+
+	//AudioSource
+	/** Overridden function inherited from AudioSource. Stores the output sample rate for new voices.
+		@param	int number of samples expected in each call to getNextAudioBlock()
+		@param	double output sample rate */
+	void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+	/** Overridden function inherited from AudioSource. Stops every voice straight away. */
+	void releaseResources() override;
+	/** Overridden function inherited from AudioSource. Clears the region and adds every active voice into it - only the
+		voices that are sounding are visited, so the cost follows the number of notes playing rather than the size of the pool.
+		@param	reference to the next block of audio data */
+	void getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill) override;
+
+	/** Readies the active voices for the next block, stopping any whose slot has been reloaded. The first of the three
+		steps getNextAudioBlock() takes, for callers that render the voices in groups on several threads - call
+		renderVoices() for each group, then endBlock(). Should only be called from the audio thread.
+		@return	int number of voices listed to render, the range renderVoices() divides */
+	int beginBlock() noexcept;
+
+	/** Adds a contiguous group of the voices listed by beginBlock() into a buffer. Groups that do not overlap touch
+		nothing in common, so they can be rendered on different threads at the same time.
+		@param	int position in the list of the first voice to render
+		@param	int position in the list after the last voice to render, no greater than the value beginBlock() returned
+		@param	reference to the buffer to add the voices into
+		@param	int first sample of the buffer to add into
+		@param	int number of samples to render */
+	void renderVoices(int firstVoice, int endVoice, AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept;
+
+	/** Drops the voices that have finished from the list and publishes how many voices each slot is playing on. Call on
+		the audio thread once every group has been rendered. */
+	void endBlock() noexcept;
+
+	/** Picks up the latest sample of every slot and stops at once any voice still reading the sample it replaced, so the
+		replaced samples can be freed straight away rather than after the next block. Must not be called while the audio
+		thread is using this object - hold the audio callback lock. */
+	void takeLatestSamples() noexcept;
+
+private:
+	/** Returns the index of the voice to play a new note on - a free voice if there is one, then one fading out,
+		otherwise the voice chosen by the stealing policy. */
+	int findVoiceToStart() const noexcept;
+
+	/** Returns the voice the handle refers to, or nullptr if its note has ended. */
+	SampleVoice* getVoice(const VoiceHandle& handle) noexcept;
+
+	/** Adds the voice to the list of voices to render, if it is not already in it. */
+	void addActiveVoice(int index) noexcept;
+
+	/** Returns the sample the given slot currently holds, from the SamplePool or the fixed set of samples. */
+	const PooledSample* getSlotSample(int slot) noexcept;
+
+	SamplePool* samplePool	{	nullptr	};
+	std::array<PooledSample::Ptr, SamplePool::NumberOfSlots> fixedSamples;
+	double outputSampleRate;
+	uint64 nextStartOrder;
+
+	std::array<SampleVoice, NumberOfVoices> voices;
+	std::array<int, NumberOfVoices> voiceSlots;
+	std::array<std::array<int, SampleVoice::NumberOfTails>, NumberOfVoices> voiceTailSlots;
+	std::array<uint64, NumberOfVoices> voiceStartOrders;
+	std::array<int, NumberOfVoices> activeVoices;
+	std::array<bool, NumberOfVoices> voiceIsListed;
+	int numActiveVoices;
+
+	std::atomic<int> stealingPolicy;
+	std::atomic<int> interpolationMode;
+	std::array<std::atomic<bool>, SamplePool::NumberOfSlots> slotLooping;
+	std::array<std::atomic<bool>, SamplePool::NumberOfSlots> slotMonophonic;
+	std::array<std::atomic<int>, SamplePool::NumberOfSlots> slotVoiceCounts;
+};
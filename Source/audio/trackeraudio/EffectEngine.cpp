@@ -0,0 +1,326 @@
+/*
+  ==============================================================================
+	EffectEngine.cpp
+  ==============================================================================
+*/
+
+#include "EffectEngine.h"
+
+/** The ratio of each interval from 0 to 15 semitones, for arpeggios. */
+static const double semitoneRatios[16] =
+{
+	1.0, 1.0594630943592953, 1.122462048309373, 1.189207115002721,
+	1.2599210498948732, 1.3348398541700344, 1.4142135623730951, 1.4983070768766815,
+	1.5874010519681994, 1.681792830507429, 1.7817974362806785, 1.887748625363387,
+	2.0, 2.1189261887185906, 2.244924096618746, 2.378414230005442
+};
+
+/** Half a cycle of the vibrato's sine wave in 32 steps, scaled to 255 - the other half is the same, negated. */
+static const uint8 vibratoSine[32] =
+{
+	0, 24, 49, 74, 97, 120, 141, 161, 180, 197, 212, 224, 235, 244, 250, 253,
+	255, 253, 250, 244, 235, 224, 212, 197, 180, 161, 141, 120, 97, 74, 49, 24
+};
+
+/** Returns the ratio of an interval given in sixteenths of a semitone. */
+static double getSixteenthsRatio(double sixteenths) noexcept
+{
+	return std::exp2(sixteenths / 192.0);
+}
+
+/** Limits a pitch ratio to six octaves either side of the sample's own pitch, so slides can't stall a voice or
+	send it racing through the sample. */
+static double limitPitch(double pitchRatio) noexcept
+{
+	return jlimit(1.0 / 64.0, 64.0, pitchRatio);
+}
+
+//indexed by TrackerEvent::Effect - the symbols follow the ProTracker commands where there is one
+const EffectEngine::EffectDefinition EffectEngine::effectTable[TrackerEvent::NumberOfEffects] =
+{
+	{	0,		false,	nullptr,								&EffectEngine::tickNothing				},	//NoEffect
+	{	'0',	false,	nullptr,								&EffectEngine::tickArpeggio				},	//Arpeggio
+	{	'1',	true,	&EffectEngine::startPortamentoUp,		&EffectEngine::tickPortamento			},	//PortamentoUp
+	{	'2',	true,	&EffectEngine::startPortamentoDown,		&EffectEngine::tickPortamento			},	//PortamentoDown
+	{	'3',	true,	&EffectEngine::startPortamentoUp,		&EffectEngine::tickTonePortamento		},	//TonePortamento
+	{	'4',	true,	nullptr,								&EffectEngine::tickVibrato				},	//Vibrato
+	{	'A',	true,	nullptr,								&EffectEngine::tickVolumeSlide			},	//VolumeSlide
+	{	'R',	true,	nullptr,								&EffectEngine::tickRetrigger			},	//Retrigger
+	{	'9',	true,	nullptr,								&EffectEngine::tickNothing				},	//SampleOffset
+	{	'X',	false,	nullptr,								&EffectEngine::tickNoteCut				}	//NoteCut
+};
+
+EffectEngine::EffectEngine()		:	numFilePlayers(0),
+										numListedChannels(0)
+{
+	listedChannels.fill(0);
+}
+
+EffectEngine::~EffectEngine()
+{
+
+}
+
+void EffectEngine::setVoicePool(VoicePool* pool)
+{
+	voicePool = pool;
+}
+
+void EffectEngine::setFilePlayers(FilePlayer* players, int numPlayers)
+{
+	filePlayers = players;
+	numFilePlayers = numPlayers;
+}
+
+juce_wchar EffectEngine::getEffectSymbol(int effect) noexcept
+{
+	return isPositiveAndBelow(effect, (int) TrackerEvent::NumberOfEffects) ? (juce_wchar) effectTable[effect].symbol : 0;
+}
+
+int EffectEngine::getEffectForSymbol(juce_wchar symbol) noexcept
+{
+	symbol = CharacterFunctions::toUpperCase(symbol);
+	for (int effect = TrackerEvent::NoEffect + 1; effect < TrackerEvent::NumberOfEffects; effect++)
+	{
+		if ((juce_wchar) effectTable[effect].symbol == symbol)
+		{
+			return effect;
+		}
+	}
+	return TrackerEvent::NoEffect;
+}
+
+void EffectEngine::reset() noexcept
+{
+	for (auto& channel : channels)
+	{
+		channel = Channel();
+	}
+	numListedChannels = 0;
+}
+
+void EffectEngine::beginRow() noexcept
+{
+	for (int n = 0; n < numListedChannels; n++)
+	{
+		Channel& channel = channels[(size_t) listedChannels[(size_t) n]];
+
+		//arpeggios and vibrato only move the pitch heard - the note carries on at the pitch it slid to
+		setNotePitch(channel, channel.pitch);
+		channel.effect = TrackerEvent::NoEffect;
+		channel.isListed = false;
+	}
+	numListedChannels = 0;
+}
+
+void EffectEngine::triggerEvent(int channelIndex, const TrackerEvent& event) noexcept
+{
+	jassert(isPositiveAndBelow(channelIndex, (int) Pattern::MaximumNumberOfChannels));
+	Channel& channel = channels[(size_t) channelIndex];
+
+	const int effect = isPositiveAndBelow(event.effect, (int) TrackerEvent::NumberOfEffects) ? event.effect : (int) TrackerEvent::NoEffect;
+	const EffectDefinition& definition = effectTable[effect];
+	channel.effect = effect;
+	channel.parameter = event.effectParameter;
+	if (definition.remembersParameter)
+	{
+		int& lastParameter = channel.lastParameters[(size_t) effect];
+		if (channel.parameter == 0)
+		{
+			channel.parameter = lastParameter;
+		}
+		lastParameter = channel.parameter;
+	}
+
+	if (!event.isEmpty())
+	{
+		channel.gain = event.gain;
+		//a tone portamento slides the note already playing towards the new one, rather than starting it
+		if (effect == TrackerEvent::TonePortamento && event.sample == channel.slot && isNotePlaying(channel))
+		{
+			channel.targetPitch = limitPitch(event.pitchRatio);
+			updateNoteGain(channel);
+		}
+		else
+		{
+			//the event's own pitch is held to the same range as the slides, so no note starts outside it
+			channel.slot = event.sample;
+			channel.pitch = limitPitch(event.pitchRatio);
+			channel.targetPitch = channel.pitch;
+			channel.vibratoPosition = 0;
+			startNote(channel, effect == TrackerEvent::SampleOffset ? channel.parameter * 256 : 0);
+		}
+	}
+
+	if (effect != TrackerEvent::NoEffect)
+	{
+		if (definition.start != nullptr)
+		{
+			definition.start(channel);
+		}
+		if (!channel.isListed)
+		{
+			channel.isListed = true;
+			listedChannels[(size_t) numListedChannels++] = channelIndex;
+		}
+	}
+}
+
+void EffectEngine::processTick(int tick) noexcept
+{
+	//only the channels with an effect in this row are visited
+	for (int n = 0; n < numListedChannels; n++)
+	{
+		Channel& channel = channels[(size_t) listedChannels[(size_t) n]];
+		effectTable[channel.effect].tick(*this, channel, tick);
+	}
+}
+
+void EffectEngine::startNote(Channel& channel, int startOffset) noexcept
+{
+	channel.voice = VoicePool::VoiceHandle();
+	channel.streamedSlot = -1;
+
+	if (voicePool != nullptr)
+	{
+		channel.voice = voicePool->startVoice(channel.slot, channel.pitch, channel.gain, startOffset);
+	}
+	//slots that are not preloaded are streamed on their FilePlayer, which plays one note at a time
+	if (channel.voice.index < 0 && isPositiveAndBelow(channel.slot, numFilePlayers))
+	{
+		//the start is queued, and applied when the FilePlayer renders its next block - nothing here locks or waits
+		channel.streamedNote = filePlayers[channel.slot].startStream(channel.pitch, channel.gain, startOffset);
+		channel.streamedSlot = channel.slot;
+	}
+}
+
+bool EffectEngine::isNotePlaying(const Channel& channel) const noexcept
+{
+	if (channel.streamedSlot >= 0)
+	{
+		return filePlayers[channel.streamedSlot].isStreamActive();
+	}
+	return voicePool != nullptr && voicePool->isVoicePlaying(channel.voice);
+}
+
+void EffectEngine::setNotePitch(Channel& channel, double pitchRatio) noexcept
+{
+	if (channel.streamedSlot >= 0)
+	{
+		filePlayers[channel.streamedSlot].setPlaybackRate(pitchRatio);
+	}
+	else if (voicePool != nullptr)
+	{
+		voicePool->setVoicePitch(channel.voice, pitchRatio);
+	}
+}
+
+void EffectEngine::updateNoteGain(Channel& channel) noexcept
+{
+	if (channel.streamedSlot >= 0)
+	{
+		filePlayers[channel.streamedSlot].setGain(channel.gain);
+	}
+	else if (voicePool != nullptr)
+	{
+		voicePool->setVoiceGain(channel.voice, channel.gain);
+	}
+}
+
+void EffectEngine::stopNote(Channel& channel) noexcept
+{
+	if (channel.streamedSlot >= 0)
+	{
+		filePlayers[channel.streamedSlot].stopStream(channel.streamedNote);
+	}
+	else if (voicePool != nullptr)
+	{
+		voicePool->stopVoice(channel.voice);
+	}
+}
+
+//Effects
+void EffectEngine::startPortamentoUp(Channel& channel)
+{
+	//the step is worked out once a row, so each tick is a single multiply
+	channel.pitchStep = getSixteenthsRatio(channel.parameter);
+}
+
+void EffectEngine::startPortamentoDown(Channel& channel)
+{
+	channel.pitchStep = 1.0 / getSixteenthsRatio(channel.parameter);
+}
+
+void EffectEngine::tickArpeggio(EffectEngine& engine, Channel& channel, int tick)
+{
+	//x and y are the intervals above the note played on the second and third of every three ticks
+	const int intervals[3] = { 0, channel.parameter >> 4, channel.parameter & 0x0f };
+	engine.setNotePitch(channel, limitPitch(channel.pitch * semitoneRatios[intervals[tick % 3]]));
+}
+
+void EffectEngine::tickPortamento(EffectEngine& engine, Channel& channel, int tick)
+{
+	if (tick > 0)
+	{
+		channel.pitch = limitPitch(channel.pitch * channel.pitchStep);
+		engine.setNotePitch(channel, channel.pitch);
+	}
+}
+
+void EffectEngine::tickTonePortamento(EffectEngine& engine, Channel& channel, int tick)
+{
+	if (tick > 0 && channel.pitch != channel.targetPitch)
+	{
+		//steps towards the target without passing it
+		channel.pitch = channel.pitch < channel.targetPitch ? jmin(channel.targetPitch, channel.pitch * channel.pitchStep)
+															: jmax(channel.targetPitch, channel.pitch / channel.pitchStep);
+		engine.setNotePitch(channel, channel.pitch);
+	}
+}
+
+void EffectEngine::tickVibrato(EffectEngine& engine, Channel& channel, int tick)
+{
+	//x steps through the 64 step cycle on every tick after the first, y is the depth at the peaks
+	if (tick > 0)
+	{
+		channel.vibratoPosition = (channel.vibratoPosition + (channel.parameter >> 4)) & 63;
+	}
+	const int sine = vibratoSine[channel.vibratoPosition & 31];
+	const int offset = (channel.vibratoPosition < 32 ? sine : -sine) * (channel.parameter & 0x0f);
+	engine.setNotePitch(channel, limitPitch(channel.pitch * getSixteenthsRatio(offset / 255.0)));
+}
+
+void EffectEngine::tickVolumeSlide(EffectEngine& engine, Channel& channel, int tick)
+{
+	if (tick > 0)
+	{
+		//slides up by x if it is set, otherwise down by y
+		const int up = channel.parameter >> 4;
+		const int down = channel.parameter & 0x0f;
+		channel.gain = jlimit(0.f, 1.f, channel.gain + (up > 0 ? up : -down) / 64.f);
+		engine.updateNoteGain(channel);
+	}
+}
+
+void EffectEngine::tickRetrigger(EffectEngine& engine, Channel& channel, int tick)
+{
+	if (tick > 0 && channel.parameter > 0 && tick % channel.parameter == 0 && channel.slot >= 0)
+	{
+		//the retriggered note cuts off the last one, rather than sounding alongside it
+		engine.stopNote(channel);
+		engine.startNote(channel, 0);
+	}
+}
+
+void EffectEngine::tickNoteCut(EffectEngine& engine, Channel& channel, int tick)
+{
+	if (tick == channel.parameter)
+	{
+		engine.stopNote(channel);
+	}
+}
+
+void EffectEngine::tickNothing(EffectEngine&, Channel&, int)
+{
+
+}
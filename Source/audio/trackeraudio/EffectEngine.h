@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+	EffectEngine.h
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include "Pattern.h"
+#include "../fileaudio/VoicePool.h"
+#include "../fileaudio/FilePlayer.h"
+
+/** Starts the events of a song's channels and applies their effects on every tick of each row. Each channel keeps
+	the note it last started, and the effect of the row being played slides, wobbles, retriggers or cuts that note.
+	Effects are dispatched through a table indexed by TrackerEvent::Effect, filled in at compile time, and only the
+	channels with an effect in the current row are visited on each tick - so the work per tick follows the number of
+	effects playing, and each one costs a few multiplies. Should only be used from the thread rendering the song.
+	@see	TrackerEvent::Effect */
+
+class EffectEngine
+{
+public:
+	/** Constructor. */
+	EffectEngine();
+
+	/** Destructor. */
+	~EffectEngine();
+
+	/** Passes this object the VoicePool preloaded samples are played on.
+		@param	pointer to a VoicePool, expected to outlive this object */
+	void setVoicePool(VoicePool* pool);
+
+	/** Passes this object the FilePlayers streamed samples are played on, one per slot. Without them, only preloaded
+		samples are played.
+		@param	pointer to the first of the FilePlayers, expected to outlive this object
+		@param	int number of FilePlayers */
+	void setFilePlayers(FilePlayer* players, int numPlayers);
+
+	/** Returns the character the given effect is shown as in the effect column.
+		@param	int effect, one of the TrackerEvent::Effect values
+		@return	juce_wchar symbol of the effect, or 0 for TrackerEvent::NoEffect */
+	static juce_wchar getEffectSymbol(int effect) noexcept;
+
+	/** Returns the effect shown as the given character in the effect column, ignoring case.
+		@param	juce_wchar symbol to look up
+		@return	int one of the TrackerEvent::Effect values, TrackerEvent::NoEffect if no effect is shown as the symbol */
+	static int getEffectForSymbol(juce_wchar symbol) noexcept;
+
+	/** Forgets the note and effect of every channel, leaving any notes still playing to ring on. */
+	void reset() noexcept;
+
+	/** Ends the effects of the last row. Call before the events of a new row are triggered. */
+	void beginRow() noexcept;
+
+	/** Starts an event's note in its channel, unless it slides to it with TonePortamento, and sets up its effect.
+		@param	int channel of the event, in the range of Pattern::MaximumNumberOfChannels
+		@param	TrackerEvent to trigger */
+	void triggerEvent(int channel, const TrackerEvent& event) noexcept;
+
+	/** Applies the effect of every channel that has one for the tick starting now. Call on every tick of the row,
+		including the first, after its events have been triggered.
+		@param	int tick of the row, 0 for the first */
+	void processTick(int tick) noexcept;
+
+private:
+	/** The note a channel last started, and the effect it is playing in the current row. */
+	struct Channel
+	{
+		VoicePool::VoiceHandle voice;
+		int streamedSlot = -1;
+		uint32 streamedNote = 0;
+		int slot = -1;
+		float gain = 1.f;
+		double pitch = 1.0;
+		double targetPitch = 1.0;
+		int effect = TrackerEvent::NoEffect;
+		int parameter = 0;
+		double pitchStep = 1.0;
+		int vibratoPosition = 0;
+		bool isListed = false;
+		std::array<int, TrackerEvent::NumberOfEffects> lastParameters {};
+	};
+
+	/** How an effect is shown and applied. */
+	struct EffectDefinition
+	{
+		/** Character the effect is shown as in the effect column. */
+		char symbol;
+		/** True if a parameter of 0 repeats the last parameter given to the effect in the same channel. */
+		bool remembersParameter;
+		/** Called once when the effect starts in a row, to work out anything it needs on every tick - may be nullptr. */
+		void (*start)(Channel& channel);
+		/** Called on every tick of the row the effect is in. */
+		void (*tick)(EffectEngine& engine, Channel& channel, int tick);
+	};
+
+	static const EffectDefinition effectTable[TrackerEvent::NumberOfEffects];
+
+	//the effects, as listed in effectTable
+	static void startPortamentoUp(Channel& channel);
+	static void startPortamentoDown(Channel& channel);
+	static void tickArpeggio(EffectEngine& engine, Channel& channel, int tick);
+	static void tickPortamento(EffectEngine& engine, Channel& channel, int tick);
+	static void tickTonePortamento(EffectEngine& engine, Channel& channel, int tick);
+	static void tickVibrato(EffectEngine& engine, Channel& channel, int tick);
+	static void tickVolumeSlide(EffectEngine& engine, Channel& channel, int tick);
+	static void tickRetrigger(EffectEngine& engine, Channel& channel, int tick);
+	static void tickNoteCut(EffectEngine& engine, Channel& channel, int tick);
+	static void tickNothing(EffectEngine& engine, Channel& channel, int tick);
+
+	/** Starts the channel's slot at its pitch and gain, on a voice if it is preloaded, otherwise on its FilePlayer. */
+	void startNote(Channel& channel, int startOffset) noexcept;
+
+	/** Returns true if the note the channel last started is still playing. */
+	bool isNotePlaying(const Channel& channel) const noexcept;
+
+	/** Sets the pitch the channel's note is heard at, leaving the pitch the channel slides from unchanged. */
+	void setNotePitch(Channel& channel, double pitchRatio) noexcept;
+
+	/** Sets the channel's note to the channel's gain. */
+	void updateNoteGain(Channel& channel) noexcept;
+
+	/** Stops the channel's note. */
+	void stopNote(Channel& channel) noexcept;
+
+	VoicePool* voicePool	{	nullptr	};
+	FilePlayer* filePlayers	{	nullptr	};
+	int numFilePlayers;
+
+	std::array<Channel, Pattern::MaximumNumberOfChannels> channels;
+	std::array<int, Pattern::MaximumNumberOfChannels> listedChannels;
+	int numListedChannels;
+
+	JUCE_DECLARE_NON_COPYABLE(EffectEngine)
+};
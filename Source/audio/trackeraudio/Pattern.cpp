@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+	Pattern.cpp
+  ==============================================================================
+*/
+
+#include "Pattern.h"
+
+Pattern::Pattern(const ChannelEvent* arena, const int* rowOffsets, int rows, int channels) noexcept
+																								:	events(arena),
+																									offsets(rowOffsets),
+																									numRows(rows),
+																									numChannels(channels)
+{
+
+}
+
+Pattern::~Pattern()
+{
+
+}
+
+bool Pattern::isValid() const noexcept
+{
+	return offsets != nullptr;
+}
+
+int Pattern::getNumRows() const noexcept
+{
+	return numRows;
+}
+
+int Pattern::getNumChannels() const noexcept
+{
+	return numChannels;
+}
+
+Pattern::Row Pattern::getRow(int row) const noexcept
+{
+	jassert(isValid());
+	jassert(isPositiveAndBelow(row, numRows));
+	return { events + offsets[row], events + offsets[row + 1] };
+}
+
+const TrackerEvent& Pattern::getEvent(int row, int channel) const noexcept
+{
+	static const TrackerEvent blankEvent;
+	jassert(isPositiveAndBelow(channel, numChannels));
+
+	//rows only hold a handful of events, so they are searched in order
+	for (auto& channelEvent : getRow(row))
+	{
+		if (channelEvent.channel == channel)
+		{
+			return channelEvent.event;
+		}
+		if (channelEvent.channel > channel)
+		{
+			break;
+		}
+	}
+	return blankEvent;
+}
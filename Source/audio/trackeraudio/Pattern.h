@@ -0,0 +1,131 @@
+/*
+  ==============================================================================
+	Pattern.h
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/** Plain description of a single tracker cell, ready to be read by the audio thread without any parsing. */
+
+struct TrackerEvent
+{
+	/** Commands of the effect column, applied to the note playing in the event's channel on every tick of the row.
+		Pitches move in sixteenths of a semitone and gains in sixty-fourths, as they do in most trackers.
+		@see	EffectEngine */
+	enum Effect
+	{
+		NoEffect = 0,
+		Arpeggio,			/**< xy - cycles the note, the note + x semitones and the note + y semitones, one per tick */
+		PortamentoUp,		/**< xx - raises the pitch by xx sixteenths of a semitone every tick after the first */
+		PortamentoDown,		/**< xx - lowers the pitch by xx sixteenths of a semitone every tick after the first */
+		TonePortamento,		/**< xx - slides towards the event's note by xx sixteenths of a semitone a tick, without retriggering */
+		Vibrato,			/**< xy - wobbles the pitch at speed x, up to y sixteenths of a semitone either side */
+		VolumeSlide,		/**< xy - raises the gain by x sixty-fourths every tick after the first, or lowers it by y */
+		Retrigger,			/**< xx - starts the note again every xx ticks */
+		SampleOffset,		/**< xx - starts the note xx * 256 samples into the sample */
+		NoteCut,			/**< xx - stops the note on tick xx */
+
+		NumberOfEffects
+	};
+
+	/** MIDI note number of the event, -1 if no valid note has been entered (the sample plays at C4). */
+	int note = -1;
+	/** Index of the sample to trigger, -1 if the cell is empty. */
+	int sample = -1;
+	/** Gain to play the sample at, in the range 0 to 1. */
+	float gain = 1.f;
+	/** Playback rate relative to C4, calculated from note when the event is created. */
+	double pitchRatio = 1.0;
+	/** Effect to apply to the channel during this row, one of the Effect values. */
+	int effect = NoEffect;
+	/** Parameter of the effect, in the range 0 to 255 - shown as two hex digits, x and y. */
+	int effectParameter = 0;
+
+	/** Returns true if this event does not trigger a sample. */
+	bool isEmpty() const noexcept { return sample < 0; }
+
+	/** Returns true if this event has an effect to apply. */
+	bool hasEffect() const noexcept { return effect != NoEffect; }
+
+	/** Returns true if every field still holds its default - blank events are not stored in a Song. */
+	bool isBlank() const noexcept { return note < 0 && sample < 0 && gain == 1.f && effect == NoEffect && effectParameter == 0; }
+};
+
+/** A TrackerEvent together with the channel it is in. The rows of a Song only hold these, one for each
+	channel that is not blank, in channel order. */
+
+struct ChannelEvent
+{
+	/** Channel the event is in. */
+	int channel = 0;
+	/** The event itself. */
+	TrackerEvent event;
+};
+
+/** A read-only view of one pattern of a Song. Each row only lists the channels that hold an event, so reading a
+	row costs as much as the notes in it rather than the width of the song. Cheap to copy, and only valid while
+	the Song it was taken from is alive and unmodified.
+	@see	Song */
+
+class Pattern
+{
+public:
+	/** The events of a single row, in channel order. Can be iterated with a range-based for loop. */
+	struct Row
+	{
+		const ChannelEvent* first = nullptr;
+		const ChannelEvent* last = nullptr;
+
+		const ChannelEvent* begin() const noexcept { return first; }
+		const ChannelEvent* end() const noexcept { return last; }
+		int size() const noexcept { return (int) (last - first); }
+	};
+
+	/** Constructor.
+		@param	pointer to the first event of the Song's arena, or nullptr for an invalid pattern
+		@param	pointer to the offset into the arena of each row of the pattern, followed by the offset the row after it starts at
+		@param	int number of rows in the pattern
+		@param	int number of channels in the pattern */
+	Pattern(const ChannelEvent* arena = nullptr, const int* rowOffsets = nullptr, int rows = 0, int channels = 0) noexcept;
+
+	/** Destructor. */
+	~Pattern();
+
+	/** Holds the limits on the size of a pattern, and the size new songs start with. */
+	enum
+	{
+		MaximumNumberOfChannels = 64,
+		MaximumNumberOfRows = 256,
+		DefaultNumberOfChannels = 4,
+		DefaultNumberOfRows = 64
+	};
+
+	/** Returns true if this view refers to a pattern. */
+	bool isValid() const noexcept;
+
+	/** Returns the number of rows in the pattern. */
+	int getNumRows() const noexcept;
+
+	/** Returns the number of channels in the pattern. */
+	int getNumChannels() const noexcept;
+
+	/** Returns the events held in the given row.
+		@param	int row in the range of getNumRows()
+		@return	Row listing only the channels that hold an event */
+	Row getRow(int row) const noexcept;
+
+	/** Returns the event at the given position in the pattern.
+		@param	int row in the range of getNumRows()
+		@param	int channel in the range of getNumChannels()
+		@return	reference to the TrackerEvent at the given position, or to a blank event if the channel holds none */
+	const TrackerEvent& getEvent(int row, int channel) const noexcept;
+
+private:
+	const ChannelEvent* events;
+	const int* offsets;
+	int numRows;
+	int numChannels;
+};
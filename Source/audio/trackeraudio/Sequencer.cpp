@@ -0,0 +1,192 @@
+/*
+  ==============================================================================
+	Sequencer.cpp
+  ==============================================================================
+*/
+
+#include "Sequencer.h"
+
+Sequencer::Groove::Groove()		:	length(1)
+{
+	rowLengths.fill(1.f);
+}
+
+Sequencer::Groove Sequencer::Groove::fromRowLengths(const float* lengths, int numLengths)
+{
+	Groove groove;
+	numLengths = jlimit(0, (int) MaximumGrooveLength, numLengths);
+
+	float total = 0.f;
+	for (int i = 0; i < numLengths; i++)
+	{
+		jassert(lengths[i] >= 0.f);
+		total += jmax(0.f, lengths[i]);
+	}
+	if (total <= 0.f)
+	{
+		return groove;
+	}
+
+	//scaled so the lengths average to 1, so a repeat of the groove lasts as long as the same rows played evenly
+	groove.length = numLengths;
+	for (int i = 0; i < numLengths; i++)
+	{
+		groove.rowLengths[(size_t) i] = jmax(0.f, lengths[i]) * numLengths / total;
+	}
+	return groove;
+}
+
+Sequencer::Groove Sequencer::Groove::fromSwing(int swingPercent)
+{
+	const float first = (float) jlimit((int) StraightSwing, (int) MaximumSwing, swingPercent);
+	const float lengths[2] = { first, 100.f - first };
+	return fromRowLengths(lengths, 2);
+}
+
+Sequencer::Sequencer()		:	sampleCounter(0),
+								rowLength(-1),
+								rowRemainder(0.0),
+								tickCounter(MaximumTicksPerRow),
+								rowCounter(0),
+								orderCounter(0),
+								rowDue(false)
+{
+
+}
+
+Sequencer::~Sequencer()
+{
+
+}
+
+double Sequencer::getSamplesPerRow(double sampleRate, double bpm) noexcept
+{
+	//a beat is 60 / bpm seconds, and each row a sixteenth note - a quarter of a beat
+	return sampleRate * 15.0 / jmax(1.0, bpm);
+}
+
+int64 Sequencer::getLengthInSamples(double samplesPerRow, const Groove& groove, int numRows, int numPatterns) noexcept
+{
+	double patternLength = 0.0;
+	for (int row = 0; row < numRows; row++)
+	{
+		patternLength += samplesPerRow * groove.getRowLength(row);
+	}
+	//advance() carries each row's remainder on, so the rows played add up to the exact length, rounded down
+	return (int64) (patternLength * numPatterns);
+}
+
+/** Returns the sample within a row that the given tick starts on. */
+static int getTickStart(int tick, int samplesPerRow, int ticksPerRow) noexcept
+{
+	return (int) ((int64) tick * samplesPerRow / ticksPerRow);
+}
+
+void Sequencer::reset(bool startImmediately) noexcept
+{
+	sampleCounter = 0;
+	//the length of the wait before the first row is set on the next advance
+	rowLength = -1;
+	rowRemainder = 0.0;
+	//no row has started, so there are no ticks to report until one does
+	tickCounter = MaximumTicksPerRow;
+	rowCounter = 0;
+	orderCounter = 0;
+	rowDue = startImmediately;
+	currentRow = Position();
+}
+
+int Sequencer::advance(int maxSamples, double samplesPerRow, int ticksPerRow, const Groove& groove,
+						int orderLength, int numRows, Position& startingPosition) noexcept
+{
+	startingPosition = Position();
+	if (rowLength < 0)
+	{
+		rowLength = jmax(1, (int) samplesPerRow);
+	}
+
+	if (rowDue || sampleCounter >= rowLength)
+	{
+		//the patterns may have been shortened since the last row - move on to the next entry of the order list if so
+		if (rowCounter >= numRows)
+		{
+			rowCounter = 0;
+			orderCounter++;
+		}
+		//the order list may have been shortened since the last row - start again from its first entry if so
+		if (orderCounter >= orderLength)
+		{
+			orderCounter = 0;
+		}
+		currentRow.order = orderCounter;
+		currentRow.row = rowCounter;
+
+		//the row lasts a whole number of samples, and the fraction left over is carried on to the next - so every row
+		//starts on the sample its exact position falls in, and a long song never drifts from its tempo
+		const double exactLength = samplesPerRow * groove.getRowLength(rowCounter) + rowRemainder;
+		rowLength = jmax(1, (int) exactLength);
+		rowRemainder = exactLength - rowLength;
+
+		//increment the row counter, moving on to the next entry of the order list at the end of the pattern
+		rowCounter++;
+		if (rowCounter >= numRows)
+		{
+			rowCounter = 0;
+			orderCounter++;
+			if (orderCounter >= orderLength)
+			{
+				orderCounter = 0;
+			}
+		}
+		//reset the sample and tick counters
+		sampleCounter = 0;
+		tickCounter = 0;
+		rowDue = false;
+	}
+
+	//a tick can be no shorter than a sample
+	ticksPerRow = jlimit(1, jmin(rowLength, (int) MaximumTicksPerRow), ticksPerRow);
+
+	//the first tick starts with the row, and each of the others a share of the way through it
+	if (tickCounter < ticksPerRow && sampleCounter >= getTickStart(tickCounter, rowLength, ticksPerRow))
+	{
+		startingPosition = currentRow;
+		startingPosition.tick = tickCounter++;
+	}
+
+	//only advance up to the next tick boundary - if the ticks per row have just been raised, the ticks already
+	//passed are reported one after another without advancing
+	const int nextBoundary = tickCounter < ticksPerRow ? getTickStart(tickCounter, rowLength, ticksPerRow) : rowLength;
+	const int samplesToAdvance = jmin(maxSamples, jmax(0, nextBoundary - sampleCounter));
+	sampleCounter += samplesToAdvance;
+	return samplesToAdvance;
+}
+
+Sequencer::Position Sequencer::getCurrentRow() const noexcept
+{
+	Position position;
+	position.order = jmax(0, currentRow.order);
+	position.row = jmax(0, currentRow.row);
+	return position;
+}
+
+int Sequencer::getClockPulses(int samplesAdvanced, int* offsets) const noexcept
+{
+	if (currentRow.row < 0)
+	{
+		return 0;
+	}
+
+	//advance() never crosses the end of a row, so the samples it moved over all belong to the current one
+	const int sectionStart = sampleCounter - samplesAdvanced;
+	int numPulses = 0;
+	for (int pulse = 0; pulse < ClocksPerRow; pulse++)
+	{
+		const int pulseStart = getTickStart(pulse, rowLength, ClocksPerRow);
+		if (pulseStart >= sectionStart && pulseStart < sampleCounter)
+		{
+			offsets[numPulses++] = pulseStart - sectionStart;
+		}
+	}
+	return numPulses;
+}
@@ -0,0 +1,139 @@
+/*
+  ==============================================================================
+	Sequencer.h
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include "Song.h"
+
+/** Counts samples, ticks and rows through the order list of a song, splitting the audio being rendered at every tick
+	boundary so each row, and each tick of the effects within it, starts at its exact sample. Holds no audio of its own - the live engine and the offline renderer both
+	step one through their blocks, so a bounce lands on exactly the samples playback would. Rows last a fractional number
+	of samples: each starts on the sample its exact position falls in, and the remainder is carried on to the next, so
+	the song never drifts from its tempo however long it plays. */
+
+class Sequencer
+{
+public:
+	/** Constructor. */
+	Sequencer();
+
+	/** Destructor. */
+	~Sequencer();
+
+	/** Holds the number of ticks each row is split into by default, and the most it can be split into. */
+	enum
+	{
+		DefaultTicksPerRow = 6,
+		MaximumTicksPerRow = 32
+	};
+
+	/** Holds the number of MIDI clock pulses in each row - 24 to the beat, and rows are sixteenth notes. */
+	enum
+	{
+		ClocksPerRow = 6
+	};
+
+	/** Holds the longest groove, and the range of swing in percent - 50 plays rows evenly, 75 plays every other row
+		three times as long as the row after it. */
+	enum
+	{
+		MaximumGrooveLength = 16,
+		StraightSwing = 50,
+		MaximumSwing = 75
+	};
+
+	/** The lengths of a repeating run of rows relative to the tempo - a swing or groove. The lengths average to 1, so
+		a groove moves rows within each repeat without changing the tempo. The first length is that of the first row of
+		every pattern. */
+	struct Groove
+	{
+		/** Creates a groove that plays every row for the same length. */
+		Groove();
+
+		/** Creates a groove from the relative lengths of a run of rows, scaled so they average to 1.
+			@param	pointer to the first of the lengths, none of which may be negative
+			@param	int number of lengths, limited to MaximumGrooveLength
+			@return	Groove playing the lengths, or an even groove if none are positive */
+		static Groove fromRowLengths(const float* lengths, int numLengths);
+
+		/** Creates a groove that swings every other row.
+			@param	int share of each pair of rows the first lasts for, in percent, limited to StraightSwing to MaximumSwing
+			@return	Groove playing the swing */
+		static Groove fromSwing(int swingPercent);
+
+		/** Returns the length of the given row relative to the tempo.
+			@param	int row of the pattern, not negative */
+		double getRowLength(int row) const noexcept { return rowLengths[(size_t) (row % length)]; }
+
+		std::array<float, MaximumGrooveLength> rowLengths;
+		int length;
+	};
+
+	/** A position in a song - the entry of the order list being played, the row of its pattern and the tick of the row. */
+	struct Position
+	{
+		int order = -1;
+		int row = -1;
+		int tick = -1;
+	};
+
+	/** Returns the number of samples each row lasts for, before any groove is applied. Rows are sixteenth notes.
+		@param	double output sample rate
+		@param	double tempo in beats per minute
+		@return	double exact number of samples per row, which is rarely a whole number */
+	static double getSamplesPerRow(double sampleRate, double bpm) noexcept;
+
+	/** Returns the number of samples the given number of patterns lasts for, as advance() counts them to within a sample.
+		@param	double number of samples per row
+		@param	Groove the rows are played with
+		@param	int number of rows in each pattern
+		@param	int number of patterns played
+		@return	int64 number of samples */
+	static int64 getLengthInSamples(double samplesPerRow, const Groove& groove, int numRows, int numPatterns) noexcept;
+
+	/** Moves back to the first row of the first entry of the order list.
+		@param	bool true to start the first row on the next sample, false to start it one row's length later */
+	void reset(bool startImmediately) noexcept;
+
+	/** Advances through the song, up to the next tick boundary at most. After the last row of a pattern the next
+		entry of the order list is played, and after the last entry the song starts again from the first. Each row's
+		length is set by the tempo and groove as it starts, and ticks split it as evenly as whole samples allow.
+		@param	int maximum number of samples to advance by
+		@param	double number of samples per row, as returned by getSamplesPerRow()
+		@param	int number of ticks per row, limited to the number of samples in the row
+		@param	Groove to lengthen and shorten rows by
+		@param	int number of entries in the order list of the song being played
+		@param	int number of rows in each pattern of the song being played
+		@param	reference to a Position set to the tick that starts at the first of these samples and the row it belongs
+				to, with tick -1 if none does - tick 0 is the start of a new row
+		@return	int number of samples advanced by - render this many before calling again */
+	int advance(int maxSamples, double samplesPerRow, int ticksPerRow, const Groove& groove,
+				int orderLength, int numRows, Position& startingPosition) noexcept;
+
+	/** Returns the row being played - the one the last sample advanced over belongs to.
+		@return	Position of the row with tick -1, or the first row of the first entry of the order list if none has started */
+	Position getCurrentRow() const noexcept;
+
+	/** Finds the MIDI clock pulses that fall in the samples the last call to advance() moved over. The pulses split
+		each row as evenly as whole samples allow, so they follow the groove, and none fall before the first row starts.
+		@param	int number of samples the last call to advance() moved over
+		@param	pointer to an array of at least ClocksPerRow ints, filled with the offset of each pulse from the first of
+				those samples
+		@return	int number of pulses found */
+	int getClockPulses(int samplesAdvanced, int* offsets) const noexcept;
+
+private:
+	int sampleCounter;
+	int rowLength;
+	double rowRemainder;
+	int tickCounter;
+	int rowCounter;
+	int orderCounter;
+	bool rowDue;
+	Position currentRow;
+};
@@ -0,0 +1,305 @@
+/*
+  ==============================================================================
+	Song.cpp
+  ==============================================================================
+*/
+
+#include "Song.h"
+#include <algorithm>
+
+Song::Song()		:	numChannels(Pattern::DefaultNumberOfChannels),
+						numRows(Pattern::DefaultNumberOfRows)
+{
+	//rowOffsets always ends with the offset one past the last row, so every row's events end where the next row's begin
+	rowOffsets.push_back(0);
+	addPattern();
+	orderList.push_back(0);
+}
+
+Song::Song(const Song& other)		:	numChannels(other.numChannels),
+										numRows(other.numRows),
+										arena(other.arena),
+										rowOffsets(other.rowOffsets),
+										orderList(other.orderList)
+{
+
+}
+
+Song::~Song()
+{
+
+}
+
+Song::Ptr Song::createFromData(int numChannels, int numRows, int numPatterns,
+								const ChannelEvent* events, int numEvents,
+								const int* rowOffsets,
+								const int* order, int orderLength)
+{
+	if (!isValidData(numChannels, numRows, numPatterns, events, numEvents, rowOffsets, order, orderLength))
+	{
+		return nullptr;
+	}
+
+	Ptr song = new Song();
+	song->numChannels = numChannels;
+	song->numRows = numRows;
+	song->arena.assign(events, events + numEvents);
+	song->rowOffsets.assign(rowOffsets, rowOffsets + numPatterns * numRows + 1);
+	song->orderList.assign(order, order + orderLength);
+	return song;
+}
+
+Song::Ptr Song::createFromData(int numChannels, int numRows,
+								std::vector<ChannelEvent>&& events,
+								std::vector<int>&& rowOffsets,
+								std::vector<int>&& order)
+{
+	//there must be exactly one offset for every row of every pattern, plus the one past the last row
+	if (numRows <= 0 || rowOffsets.empty() || (rowOffsets.size() - 1) % (size_t) numRows != 0)
+	{
+		return nullptr;
+	}
+	const int numPatterns = (int) ((rowOffsets.size() - 1) / (size_t) numRows);
+	if (!isValidData(numChannels, numRows, numPatterns, events.data(), (int) events.size(), rowOffsets.data(), order.data(), (int) order.size()))
+	{
+		return nullptr;
+	}
+
+	Ptr song = new Song();
+	song->numChannels = numChannels;
+	song->numRows = numRows;
+	song->arena = std::move(events);
+	song->rowOffsets = std::move(rowOffsets);
+	song->orderList = std::move(order);
+	return song;
+}
+
+bool Song::isValidData(int numChannels, int numRows, int numPatterns,
+						const ChannelEvent* events, int numEvents,
+						const int* rowOffsets,
+						const int* order, int orderLength)
+{
+	if (!isPositiveAndNotGreaterThan(numChannels, (int) Pattern::MaximumNumberOfChannels) || numChannels == 0
+		|| !isPositiveAndNotGreaterThan(numRows, (int) Pattern::MaximumNumberOfRows) || numRows == 0
+		|| !isPositiveAndNotGreaterThan(numPatterns, (int) MaximumNumberOfPatterns) || numPatterns == 0
+		|| !isPositiveAndNotGreaterThan(orderLength, (int) MaximumOrderLength) || orderLength == 0
+		|| numEvents < 0)
+	{
+		return false;
+	}
+
+	//every row must start where the last one ended, and hold events in ascending channel order
+	const int numRowsInSong = numPatterns * numRows;
+	if (rowOffsets[0] != 0 || rowOffsets[numRowsInSong] != numEvents)
+	{
+		return false;
+	}
+	for (int row = 0; row < numRowsInSong; row++)
+	{
+		if (rowOffsets[row + 1] < rowOffsets[row] || rowOffsets[row + 1] > numEvents)
+		{
+			return false;
+		}
+		for (int i = rowOffsets[row]; i < rowOffsets[row + 1]; i++)
+		{
+			const ChannelEvent& channelEvent = events[i];
+			if (!isPositiveAndBelow(channelEvent.channel, numChannels)
+				|| (i > rowOffsets[row] && events[i - 1].channel >= channelEvent.channel)
+				|| !isPositiveAndBelow(channelEvent.event.effect, (int) TrackerEvent::NumberOfEffects)
+				|| !isPositiveAndNotGreaterThan(channelEvent.event.effectParameter, 255)
+				|| !isValidEvent(channelEvent.event))
+			{
+				return false;
+			}
+		}
+	}
+	for (int position = 0; position < orderLength; position++)
+	{
+		if (!isPositiveAndBelow(order[position], numPatterns))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Song::isValidEvent(const TrackerEvent& event) noexcept
+{
+	//the values are played as they are, so one that would send a voice nowhere - or read a NaN - is refused here
+	return event.note >= -1 && event.note <= 127
+		&& isPositiveAndNotGreaterThan(event.gain, 1.f)
+		&& std::isfinite(event.pitchRatio) && event.pitchRatio > 0.0;
+}
+
+int Song::getNumChannels() const noexcept
+{
+	return numChannels;
+}
+
+void Song::setNumChannels(int newNumChannels)
+{
+	resize(numRows, jlimit(1, (int) Pattern::MaximumNumberOfChannels, newNumChannels));
+}
+
+int Song::getNumRows() const noexcept
+{
+	return numRows;
+}
+
+void Song::setNumRows(int newNumRows)
+{
+	resize(jlimit(1, (int) Pattern::MaximumNumberOfRows, newNumRows), numChannels);
+}
+
+int Song::getNumPatterns() const noexcept
+{
+	return (int) (rowOffsets.size() - 1) / numRows;
+}
+
+int Song::addPattern()
+{
+	const int index = getNumPatterns();
+	if (index >= MaximumNumberOfPatterns)
+	{
+		return -1;
+	}
+
+	//an empty pattern's rows all start and end at the end of the arena
+	rowOffsets.insert(rowOffsets.end(), (size_t) numRows, (int) arena.size());
+	return index;
+}
+
+Pattern Song::getPattern(int pattern) const noexcept
+{
+	jassert(isPositiveAndBelow(pattern, getNumPatterns()));
+	return Pattern(arena.data(), rowOffsets.data() + (size_t) pattern * (size_t) numRows, numRows, numChannels);
+}
+
+const TrackerEvent& Song::getEvent(int pattern, int row, int channel) const noexcept
+{
+	return getPattern(pattern).getEvent(row, channel);
+}
+
+void Song::setEvent(int pattern, int row, int channel, const TrackerEvent& event)
+{
+	jassert(isPositiveAndBelow(pattern, getNumPatterns()));
+	jassert(isPositiveAndBelow(row, numRows) && isPositiveAndBelow(channel, numChannels));
+
+	//finds where the channel's event is, or would be, among the row's events
+	const size_t rowIndex = (size_t) pattern * (size_t) numRows + (size_t) row;
+	const auto rowEnd = arena.begin() + rowOffsets[rowIndex + 1];
+	const auto position = std::find_if(arena.begin() + rowOffsets[rowIndex],
+										rowEnd,
+										[channel](const ChannelEvent& e) { return e.channel >= channel; });
+	const bool isStored = position != rowEnd && position->channel == channel;
+
+	int offsetChange = 0;
+	if (isStored && !event.isBlank())
+	{
+		position->event = event;
+	}
+	else if (isStored)
+	{
+		arena.erase(position);
+		offsetChange = -1;
+	}
+	else if (!event.isBlank())
+	{
+		arena.insert(position, ChannelEvent { channel, event });
+		offsetChange = 1;
+	}
+
+	//every row after this one now starts one event earlier or later
+	if (offsetChange != 0)
+	{
+		for (size_t i = rowIndex + 1; i < rowOffsets.size(); i++)
+		{
+			rowOffsets[i] += offsetChange;
+		}
+	}
+}
+
+int Song::getNumEvents() const noexcept
+{
+	return (int) arena.size();
+}
+
+const ChannelEvent* Song::getEventData() const noexcept
+{
+	return arena.data();
+}
+
+const int* Song::getRowOffsetData() const noexcept
+{
+	return rowOffsets.data();
+}
+
+int Song::getOrderLength() const noexcept
+{
+	return (int) orderList.size();
+}
+
+int Song::getPatternAtOrder(int position) const noexcept
+{
+	jassert(isPositiveAndBelow(position, getOrderLength()));
+	return orderList[(size_t) position];
+}
+
+void Song::setOrderList(const Array<int>& newOrder)
+{
+	orderList.clear();
+	for (int pattern : newOrder)
+	{
+		if (isPositiveAndBelow(pattern, getNumPatterns()) && orderList.size() < (size_t) MaximumOrderLength)
+		{
+			orderList.push_back(pattern);
+		}
+	}
+
+	if (orderList.empty())
+	{
+		orderList.push_back(0);
+	}
+}
+
+void Song::resize(int newNumRows, int newNumChannels)
+{
+	if (newNumRows == numRows && newNumChannels == numChannels)
+	{
+		return;
+	}
+
+	const int numPatterns = getNumPatterns();
+	std::vector<ChannelEvent> newArena;
+	std::vector<int> newRowOffsets;
+	newArena.reserve(arena.size());
+	newRowOffsets.reserve((size_t) numPatterns * (size_t) newNumRows + 1);
+
+	for (int pattern = 0; pattern < numPatterns; pattern++)
+	{
+		const Pattern oldPattern = getPattern(pattern);
+		for (int row = 0; row < newNumRows; row++)
+		{
+			newRowOffsets.push_back((int) newArena.size());
+			//rows added to the end of the pattern are empty
+			if (row >= numRows)
+			{
+				continue;
+			}
+
+			for (auto& channelEvent : oldPattern.getRow(row))
+			{
+				if (channelEvent.channel < newNumChannels)
+				{
+					newArena.push_back(channelEvent);
+				}
+			}
+		}
+	}
+	newRowOffsets.push_back((int) newArena.size());
+
+	arena.swap(newArena);
+	rowOffsets.swap(newRowOffsets);
+	numRows = newNumRows;
+	numChannels = newNumChannels;
+}
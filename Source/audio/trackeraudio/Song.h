@@ -0,0 +1,160 @@
+/*
+  ==============================================================================
+	Song.h
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include "Pattern.h"
+
+/** Every pattern of a song and the order they are played in. Only the cells that hold an event are stored - back
+	to back in one contiguous arena, row after row and pattern after pattern - alongside the offset each row starts
+	at, so a Pattern is only a pair of pointers into them. Every pattern of a song has the same number of channels
+	and rows. Built and edited on the message thread and handed to the audio thread through a SnapshotExchange -
+	once published it must not be modified. */
+
+class Song		:	public ReferenceCountedObject
+{
+public:
+	typedef ReferenceCountedObjectPtr<Song> Ptr;
+
+	/** Constructor. Creates a song holding one empty pattern of the default size, played once. */
+	Song();
+
+	/** Constructor. Copies the patterns and order list of another song, so it can be edited without touching the original.
+		@param	reference to the Song to copy */
+	Song(const Song& other);
+
+	/** Destructor. */
+	~Song();
+
+	/** Creates a song from arrays laid out exactly as a Song holds them, as read from a project file. Everything is
+		checked before it is used, so a damaged file can not produce a song the audio thread would read out of bounds or
+		play at a pitch or gain it can't handle - except the sample each event plays, which the caller checks against
+		the slots it has.
+		@param	int number of channels in every pattern
+		@param	int number of rows in every pattern
+		@param	int number of patterns
+		@param	pointer to the events of every row, row after row and pattern after pattern
+		@param	int number of events
+		@param	pointer to the offset of each row's first event, followed by numEvents
+		@param	pointer to the order list
+		@param	int number of entries in the order list
+		@return	Song::Ptr to the new song, or nullptr if the arrays do not describe a valid song */
+	static Ptr createFromData(int numChannels, int numRows, int numPatterns,
+								const ChannelEvent* events, int numEvents,
+								const int* rowOffsets,
+								const int* order, int orderLength);
+
+	/** Creates a song from arrays laid out exactly as a Song holds them, taking them over rather than copying them -
+		used by importers that build the arena row by row as they parse. Checked in the same way as the other overload.
+		@param	int number of channels in every pattern
+		@param	int number of rows in every pattern
+		@param	vector of the events of every row, row after row and pattern after pattern
+		@param	vector of the offset of each row's first event, for every row of every pattern, followed by the number of events
+		@param	vector holding the order list
+		@return	Song::Ptr to the new song, or nullptr if the arrays do not describe a valid song */
+	static Ptr createFromData(int numChannels, int numRows,
+								std::vector<ChannelEvent>&& events,
+								std::vector<int>&& rowOffsets,
+								std::vector<int>&& order);
+
+	/** Holds the most patterns a song can hold, and the longest its order list can be. */
+	enum
+	{
+		MaximumNumberOfPatterns = 256,
+		MaximumOrderLength = 256
+	};
+
+	/** Returns the number of channels in every pattern of the song. */
+	int getNumChannels() const noexcept;
+
+	/** Sets the number of channels in every pattern of the song. Events in channels that are removed are lost.
+		Only call this before the song is published.
+		@param	int number of channels, in the range 1 to Pattern::MaximumNumberOfChannels */
+	void setNumChannels(int newNumChannels);
+
+	/** Returns the number of rows in every pattern of the song. */
+	int getNumRows() const noexcept;
+
+	/** Sets the number of rows in every pattern of the song. Events in rows that are removed are lost.
+		Only call this before the song is published.
+		@param	int number of rows, in the range 1 to Pattern::MaximumNumberOfRows */
+	void setNumRows(int newNumRows);
+
+	/** Returns the number of patterns in the song. */
+	int getNumPatterns() const noexcept;
+
+	/** Adds an empty pattern to the end of the song. Only call this before the song is published.
+		@return	int index of the new pattern, or -1 if the song already holds MaximumNumberOfPatterns */
+	int addPattern();
+
+	/** Returns a view of the given pattern.
+		@param	int pattern in the range of getNumPatterns()
+		@return	Pattern referring to the pattern's events, only valid while this Song is alive and unmodified */
+	Pattern getPattern(int pattern) const noexcept;
+
+	/** Returns the event at the given position in the given pattern.
+		@param	int pattern in the range of getNumPatterns()
+		@param	int row in the range of getNumRows()
+		@param	int channel in the range of getNumChannels()
+		@return	reference to the event, or to a blank event if the cell holds none */
+	const TrackerEvent& getEvent(int pattern, int row, int channel) const noexcept;
+
+	/** Sets the event at the given position in the given pattern - a blank event clears the cell.
+		Only call this before the song is published.
+		@param	int pattern in the range of getNumPatterns()
+		@param	int row in the range of getNumRows()
+		@param	int channel in the range of getNumChannels()
+		@param	TrackerEvent to store at the given position */
+	void setEvent(int pattern, int row, int channel, const TrackerEvent& event);
+
+	/** Returns the number of events stored in the song, over every pattern. */
+	int getNumEvents() const noexcept;
+
+	/** Returns the events of every pattern, row after row and pattern after pattern - getNumEvents() of them.
+		Used to write the song to a project file without converting it. */
+	const ChannelEvent* getEventData() const noexcept;
+
+	/** Returns the offset of each row's first event into getEventData(), for every row of every pattern, followed
+		by getNumEvents(). Used to write the song to a project file without converting it. */
+	const int* getRowOffsetData() const noexcept;
+
+	/** Returns the number of entries in the order list - always at least one. */
+	int getOrderLength() const noexcept;
+
+	/** Returns the pattern played at the given position of the order list.
+		@param	int position in the range of getOrderLength()
+		@return	int index of the pattern */
+	int getPatternAtOrder(int position) const noexcept;
+
+	/** Replaces the order list. Only call this before the song is published. Entries that are not the index of
+		a pattern are dropped, and an order list left empty plays the first pattern.
+		@param	Array of pattern indices, in the order they are played */
+	void setOrderList(const Array<int>& newOrder);
+
+private:
+	/** Returns true if the given arrays describe a valid song - see createFromData. */
+	static bool isValidData(int numChannels, int numRows, int numPatterns,
+							const ChannelEvent* events, int numEvents,
+							const int* rowOffsets,
+							const int* order, int orderLength);
+
+	/** Returns true if an event's note, gain and pitch can be played - a note from -1 to 127, a gain from 0 to 1 and
+		a finite pitch ratio above 0. NaN fails every check. */
+	static bool isValidEvent(const TrackerEvent& event) noexcept;
+
+	/** Rebuilds the arena for a new pattern size, keeping every event that still fits.
+		@param	int new number of rows
+		@param	int new number of channels */
+	void resize(int newNumRows, int newNumChannels);
+
+	int numChannels;
+	int numRows;
+	std::vector<ChannelEvent> arena;
+	std::vector<int> rowOffsets;
+	std::vector<int> orderList;
+};
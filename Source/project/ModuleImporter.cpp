@@ -0,0 +1,619 @@
+/*
+  ==============================================================================
+	ModuleImporter.cpp
+  ==============================================================================
+*/
+
+#include "ModuleImporter.h"
+#include <algorithm>
+#include <vector>
+
+/** Builds the arena of a Song one row at a time, in the order a module stores its cells. */
+
+class ModuleSongBuilder
+{
+public:
+	/** Constructor.
+		@param	int number of channels in the module
+		@param	int number of events to reserve space for */
+	ModuleSongBuilder(int channels, int expectedEvents)		:	numChannels(channels)
+	{
+		events.reserve((size_t) expectedEvents);
+		rowOffsets.push_back(0);
+	}
+
+	/** Adds an event to the row being built - each row's channels must be added in ascending order.
+		@param	int channel of the event
+		@param	TrackerEvent to add */
+	void addEvent(int channel, const TrackerEvent& event)
+	{
+		events.push_back(ChannelEvent { channel, event });
+	}
+
+	/** Ends the row being built. */
+	void endRow()
+	{
+		rowOffsets.push_back((int) events.size());
+	}
+
+	/** Ends the pattern being built.
+		@param	int number of rows it held */
+	void endPattern(int numRows)
+	{
+		patternLengths.push_back(numRows);
+	}
+
+	/** Gives every event left without a gain the default volume of the sample it plays, once every sample has been read.
+		@param	reference to the gain of each slot */
+	void applySampleGains(const std::array<float, SamplePool::NumberOfSlots>& slotGains)
+	{
+		for (auto& channelEvent : events)
+		{
+			if (channelEvent.event.gain < 0.f)
+			{
+				channelEvent.event.gain = slotGains[(size_t) channelEvent.event.sample];
+			}
+		}
+	}
+
+	/** Hands the arena over to a new Song, padding every pattern with empty rows to the length of the longest.
+		@param	vector holding the order list
+		@return	Song::Ptr to the new song, or nullptr if the module did not describe a valid song */
+	Song::Ptr build(std::vector<int>&& order)
+	{
+		int numRows = 0;
+		for (int length : patternLengths)
+		{
+			numRows = jmax(numRows, length);
+		}
+
+		//empty rows hold no events, so padding only adds offsets - each one where its pattern's last row ended
+		if (std::any_of(patternLengths.begin(), patternLengths.end(), [numRows] (int length) { return length != numRows; }))
+		{
+			std::vector<int> paddedOffsets;
+			paddedOffsets.reserve(patternLengths.size() * (size_t) numRows + 1);
+			size_t firstRow = 0;
+			for (int length : patternLengths)
+			{
+				for (int row = 0; row < numRows; row++)
+				{
+					paddedOffsets.push_back(rowOffsets[firstRow + (size_t) jmin(row, length)]);
+				}
+				firstRow += (size_t) length;
+			}
+			paddedOffsets.push_back((int) events.size());
+			rowOffsets = std::move(paddedOffsets);
+		}
+
+		return Song::createFromData(numChannels, numRows, std::move(events), std::move(rowOffsets), std::move(order));
+	}
+
+private:
+	int numChannels;
+	std::vector<ChannelEvent> events;
+	std::vector<int> rowOffsets;
+	std::vector<int> patternLengths;
+};
+
+/** Returns an event playing the given slot at the given MIDI note.
+	@param	int MIDI note number, where 60 plays the sample at its own rate
+	@param	int slot to play
+	@param	float gain in the range 0 to 1, or -1 to use the sample's default volume */
+static TrackerEvent makeEvent(int note, int slot, float gain)
+{
+	TrackerEvent event;
+	event.note = jlimit(0, 127, note);
+	event.sample = slot;
+	event.gain = gain;
+	event.pitchRatio = std::pow(2.0, (event.note - 60) / 12.0);
+	return event;
+}
+
+/** Converts a module's speed (ticks per row) and tempo into the bpm of a song whose rows are sixteenth notes. */
+static double toSongBpm(int speed, int moduleBpm)
+{
+	//a module row lasts speed * 2.5 / bpm seconds, and a song row 15 / bpm - the tempo is kept exact, as most speeds
+	//give a fraction
+	return jlimit(1.0, 999.0, moduleBpm * 6.0 / jmax(1, speed));
+}
+
+/** Applies a set speed/tempo effect (Fxx in both formats) to the tempo a module starts at. */
+static void applyTempoEffect(int parameter, int& speed, int& moduleBpm)
+{
+	if (parameter >= 32)
+	{
+		moduleBpm = parameter;
+	}
+	else if (parameter > 0)
+	{
+		speed = parameter;
+	}
+}
+
+/** Copies a MOD or XM effect the EffectEngine can play into an event - both formats share the ProTracker commands.
+	@param	int effect command of the cell
+	@param	int parameter of the effect
+	@param	reference to the TrackerEvent to set the effect of */
+static void setModuleEffect(int effect, int parameter, TrackerEvent& event)
+{
+	int engineEffect = TrackerEvent::NoEffect;
+	switch (effect)
+	{
+		case 0x0:	engineEffect = parameter != 0 ? TrackerEvent::Arpeggio : TrackerEvent::NoEffect; break;
+		case 0x1:	engineEffect = TrackerEvent::PortamentoUp; break;
+		case 0x2:	engineEffect = TrackerEvent::PortamentoDown; break;
+		case 0x3:	engineEffect = TrackerEvent::TonePortamento; break;
+		case 0x4:	engineEffect = TrackerEvent::Vibrato; break;
+		case 0x9:	engineEffect = TrackerEvent::SampleOffset; break;
+		case 0xa:	engineEffect = TrackerEvent::VolumeSlide; break;
+		//the extended commands keep their parameter in the low nibble - E9x retriggers and ECx cuts
+		case 0xe:
+			if ((parameter >> 4) == 0x9 || (parameter >> 4) == 0xc)
+			{
+				engineEffect = (parameter >> 4) == 0x9 ? TrackerEvent::Retrigger : TrackerEvent::NoteCut;
+				parameter &= 0x0f;
+			}
+			break;
+		default:	break;
+	}
+
+	if (engineEffect != TrackerEvent::NoEffect)
+	{
+		event.effect = engineEffect;
+		event.effectParameter = parameter;
+	}
+}
+
+/** Decodes signed 8 or 16 bit PCM straight from the stream into a new sample, a small block at a time. A sample
+	cut short by the end of the stream is left silent from there on.
+	@param	reference to the InputStream, positioned at the sample's first byte
+	@param	int number of frames in each channel
+	@param	int number of channels, stored one after the other
+	@param	bool true for 16 bit little-endian values, false for 8 bit
+	@param	bool true if each value is stored as the difference from the one before, as in XM
+	@param	double sample rate the sample plays at for C-4
+	@return	PooledSample::Ptr to the sample, or nullptr if it holds no frames */
+static PooledSample::Ptr readSample(InputStream& stream, int numFrames, int numChannels, bool sixteenBit, bool deltaEncoded, double sampleRate)
+{
+	if (numFrames <= 0)
+	{
+		return nullptr;
+	}
+
+	AudioBuffer<float> data(numChannels, numFrames);
+	data.clear();
+
+	const int bytesPerFrame = sixteenBit ? 2 : 1;
+	const float scale = sixteenBit ? 1.f / 32768.f : 1.f / 128.f;
+	uint8 block[4096];
+	bool exhausted = false;
+	for (int channel = 0; channel < numChannels && !exhausted; channel++)
+	{
+		float* destination = data.getWritePointer(channel);
+		int previous = 0;
+		for (int frame = 0; frame < numFrames && !exhausted;)
+		{
+			const int framesToRead = jmin(numFrames - frame, (int) sizeof(block) / bytesPerFrame);
+			const int framesRead = stream.read(block, framesToRead * bytesPerFrame) / bytesPerFrame;
+			for (int i = 0; i < framesRead; i++)
+			{
+				int value = sixteenBit ? (int) (int16) (block[2 * i] | (block[2 * i + 1] << 8)) : (int) (int8) block[i];
+				if (deltaEncoded)
+				{
+					//the running sum wraps around at the sample's own width
+					value = sixteenBit ? (int) (int16) (previous + value) : (int) (int8) (previous + value);
+					previous = value;
+				}
+				destination[frame + i] = (float) value * scale;
+			}
+			frame += framesRead;
+			exhausted = framesRead < framesToRead;
+		}
+	}
+	return new PooledSample(std::move(data), sampleRate);
+}
+
+/** Returns the number of channels given by a MOD's signature, or 0 if it is not one this importer can read. */
+static int getModChannels(const uint8* signature)
+{
+	const char* tag = reinterpret_cast<const char*>(signature);
+	if (memcmp(tag, "M.K.", 4) == 0 || memcmp(tag, "M!K!", 4) == 0 || memcmp(tag, "FLT4", 4) == 0)
+	{
+		return 4;
+	}
+	if (memcmp(tag, "OKTA", 4) == 0 || memcmp(tag, "CD81", 4) == 0)
+	{
+		return 8;
+	}
+	//"6CHN", "8CHN" and so on
+	if (CharacterFunctions::isDigit(tag[0]) && memcmp(tag + 1, "CHN", 3) == 0)
+	{
+		return tag[0] - '0';
+	}
+	//"10CH" to "32CH", and "xxCN"
+	if (CharacterFunctions::isDigit(tag[0]) && CharacterFunctions::isDigit(tag[1]) && tag[2] == 'C' && (tag[3] == 'H' || tag[3] == 'N'))
+	{
+		return (tag[0] - '0') * 10 + (tag[1] - '0');
+	}
+	return 0;
+}
+
+String ModuleImporter::getWildcard()
+{
+	return "*.mod;*.xm";
+}
+
+Result ModuleImporter::importFile(const File& file, ProjectFile::Contents& contents)
+{
+	FileInputStream fileStream(file);
+	if (!fileStream.openedOk())
+	{
+		return Result::fail("Could not open " + file.getFullPathName());
+	}
+
+	//cells are read a byte at a time, so the file is read through a buffer rather than a call to the system each
+	BufferedInputStream stream(fileStream, 1 << 16);
+	return importStream(stream, file.getFileName(), contents);
+}
+
+Result ModuleImporter::importStream(InputStream& stream, const String& name, ProjectFile::Contents& contents)
+{
+	//an XM starts with its ID text, and a MOD has its signature just before the first pattern
+	uint8 header[1084] = {};
+	const int xmIdLength = 17;
+	if (stream.read(header, xmIdLength) == xmIdLength && memcmp(header, "Extended Module: ", (size_t) xmIdLength) == 0)
+	{
+		return importXm(stream, name, contents);
+	}
+
+	const int headerRemaining = (int) sizeof(header) - xmIdLength;
+	if (stream.read(header + xmIdLength, headerRemaining) != headerRemaining || getModChannels(header + 1080) == 0)
+	{
+		return Result::fail(name + " is not a MOD or XM module this version of JuceTracker can read");
+	}
+	return importMod(stream, header, name, contents);
+}
+
+Result ModuleImporter::importMod(InputStream& stream, const uint8* header, const String& name, ProjectFile::Contents& contents)
+{
+	enum
+	{
+		NumberOfSamples = 31,
+		SampleHeaderSize = 30,
+		SongLengthOffset = 950,
+		OrderOffset = 952,
+		MaximumOrderLength = 128,
+		RowsPerPattern = 64
+	};
+
+	const int numChannels = getModChannels(header + 1080);
+	const int songLength = header[SongLengthOffset];
+	if (!isPositiveAndNotGreaterThan(numChannels, (int) Pattern::MaximumNumberOfChannels)
+		|| !isPositiveAndNotGreaterThan(songLength, (int) MaximumOrderLength) || songLength == 0)
+	{
+		return Result::fail(name + " is damaged");
+	}
+
+	//every pattern named anywhere in the order table is stored, even beyond the song's length
+	std::vector<int> order;
+	int numPatterns = 0;
+	for (int position = 0; position < MaximumOrderLength; position++)
+	{
+		const int pattern = header[OrderOffset + position];
+		numPatterns = jmax(numPatterns, pattern + 1);
+		if (position < songLength)
+		{
+			order.push_back(pattern);
+		}
+	}
+
+	std::array<float, SamplePool::NumberOfSlots> slotGains;
+	slotGains.fill(1.f);
+	for (int sample = 0; sample < NumberOfSamples; sample++)
+	{
+		slotGains[(size_t) sample] = jmin(64, (int) header[20 + sample * SampleHeaderSize + 25]) / 64.f;
+	}
+
+	//patterns are stored row by row, each row every channel in order, each cell four bytes - and hold at most one event per cell
+	ModuleSongBuilder builder(numChannels, numPatterns * RowsPerPattern * numChannels);
+	std::array<int, Pattern::MaximumNumberOfChannels> lastSample = {};
+	int speed = DefaultSpeed;
+	int moduleBpm = DefaultModuleBpm;
+	uint8 row[4 * Pattern::MaximumNumberOfChannels];
+	for (int pattern = 0; pattern < numPatterns; pattern++)
+	{
+		for (int rowIndex = 0; rowIndex < RowsPerPattern; rowIndex++)
+		{
+			if (stream.read(row, 4 * numChannels) != 4 * numChannels)
+			{
+				return Result::fail(name + " is cut short");
+			}
+
+			for (int channel = 0; channel < numChannels; channel++)
+			{
+				const uint8* cell = row + 4 * channel;
+				const int sample = (cell[0] & 0xf0) | (cell[2] >> 4);
+				const int period = ((cell[0] & 0x0f) << 8) | cell[1];
+				const int effect = cell[2] & 0x0f;
+				const int parameter = cell[3];
+
+				if (effect == 0xf && pattern == order[0] && rowIndex == 0)
+				{
+					applyTempoEffect(parameter, speed, moduleBpm);
+				}
+				if (isPositiveAndNotGreaterThan(sample, (int) NumberOfSamples) && sample > 0)
+				{
+					lastSample[(size_t) channel] = sample;
+				}
+
+				//a note without a sample number plays the last sample used in its channel
+				TrackerEvent event;
+				if (period > 0 && lastSample[(size_t) channel] > 0)
+				{
+					//period 428 is C-2 in ProTracker, which plays the sample at its own rate
+					const int note = 60 + roundToInt(12.0 * std::log2(428.0 / period));
+					const float gain = effect == 0xc ? jmin(64, parameter) / 64.f : -1.f;
+					event = makeEvent(note, lastSample[(size_t) channel] - 1, gain);
+				}
+				setModuleEffect(effect, parameter, event);
+				if (!event.isBlank())
+				{
+					builder.addEvent(channel, event);
+				}
+			}
+			builder.endRow();
+		}
+		builder.endPattern(RowsPerPattern);
+	}
+
+	ProjectFile::Contents imported;
+	for (int sample = 0; sample < NumberOfSamples; sample++)
+	{
+		const uint8* sampleHeader = header + 20 + sample * SampleHeaderSize;
+		const int length = 2 * ((sampleHeader[22] << 8) | sampleHeader[23]);
+		const int loopLength = 2 * ((sampleHeader[28] << 8) | sampleHeader[29]);
+		//the finetune is a signed nibble, in eighths of a semitone
+		const int finetune = (int) (int8) (uint8) (sampleHeader[24] << 4) >> 4;
+
+		ProjectFile::Slot& slot = imported.slots[(size_t) sample];
+		slot.sample = readSample(stream, length, 1, false, false, MiddleCSampleRate * std::pow(2.0, finetune / 96.0));
+		slot.looping = loopLength > 2;
+	}
+	builder.applySampleGains(slotGains);
+
+	imported.song = builder.build(std::move(order));
+	if (imported.song == nullptr)
+	{
+		return Result::fail(name + " is damaged");
+	}
+	imported.bpm = toSongBpm(speed, moduleBpm);
+	imported.ticksPerRow = jlimit(1, (int) Sequencer::MaximumTicksPerRow, speed);
+	contents = std::move(imported);
+	return Result::ok();
+}
+
+Result ModuleImporter::importXm(InputStream& stream, const String& name, ProjectFile::Contents& contents)
+{
+	enum
+	{
+		SupportedVersion = 0x0104,
+		MaximumOrderLength = 256,
+		MaximumNumberOfInstruments = 128,
+		KeyOff = 97,
+		InstrumentHeaderStart = 29,
+		InstrumentHeaderWithSamples = 129,
+		SampleHeaderFields = 17,
+		MiddleCNote = 49
+	};
+
+	//module name, 0x1a, tracker name
+	stream.skipNextBytes(41);
+	if ((uint16) stream.readShort() != SupportedVersion)
+	{
+		return Result::fail(name + " was saved in an XM version this version of JuceTracker can't read");
+	}
+
+	const int headerSize = stream.readInt();
+	const int songLength = (uint16) stream.readShort();
+	stream.skipNextBytes(2);
+	const int numChannels = (uint16) stream.readShort();
+	const int numPatterns = (uint16) stream.readShort();
+	const int numInstruments = (uint16) stream.readShort();
+	stream.skipNextBytes(2);
+	int speed = (uint16) stream.readShort();
+	int moduleBpm = (uint16) stream.readShort();
+	uint8 orderTable[MaximumOrderLength];
+	if (stream.read(orderTable, MaximumOrderLength) != MaximumOrderLength
+		|| headerSize < 20 + MaximumOrderLength
+		|| !isPositiveAndNotGreaterThan(songLength, (int) MaximumOrderLength) || songLength == 0
+		|| !isPositiveAndNotGreaterThan(numChannels, (int) Pattern::MaximumNumberOfChannels) || numChannels == 0
+		|| !isPositiveAndNotGreaterThan(numPatterns, (int) Song::MaximumNumberOfPatterns) || numPatterns == 0
+		|| numInstruments > MaximumNumberOfInstruments)
+	{
+		return Result::fail(name + " is damaged");
+	}
+	stream.skipNextBytes(headerSize - (20 + MaximumOrderLength));
+
+	//entries naming a pattern the module doesn't hold play nothing, so they are left out
+	std::vector<int> order;
+	for (int position = 0; position < songLength; position++)
+	{
+		if (orderTable[position] < numPatterns)
+		{
+			order.push_back(orderTable[position]);
+		}
+	}
+	if (order.empty())
+	{
+		order.push_back(0);
+	}
+
+	ModuleSongBuilder builder(numChannels, 0);
+	std::array<int, Pattern::MaximumNumberOfChannels> lastInstrument = {};
+	for (int pattern = 0; pattern < numPatterns; pattern++)
+	{
+		const int patternHeaderSize = stream.readInt();
+		stream.skipNextBytes(1);
+		const int numRows = (uint16) stream.readShort();
+		const int packedSize = (uint16) stream.readShort();
+		if (stream.isExhausted() || patternHeaderSize < 9 || !isPositiveAndNotGreaterThan(numRows, (int) Pattern::MaximumNumberOfRows) || numRows == 0)
+		{
+			return Result::fail(name + " is damaged");
+		}
+		stream.skipNextBytes(patternHeaderSize - 9);
+
+		//a pattern with no packed data is empty
+		int bytesRead = 0;
+		auto readPacked = [&stream, &bytesRead] () { bytesRead++; return (int) (uint8) stream.readByte(); };
+		for (int row = 0; row < numRows; row++)
+		{
+			for (int channel = 0; channel < numChannels && packedSize > 0; channel++)
+			{
+				//a cell either starts with a mask of the fields that follow, or holds all five fields
+				int note = readPacked();
+				int instrument = 0, volume = 0, effect = 0, parameter = 0;
+				if ((note & 0x80) != 0)
+				{
+					const int mask = note;
+					note = (mask & 0x01) != 0 ? readPacked() : 0;
+					instrument = (mask & 0x02) != 0 ? readPacked() : 0;
+					volume = (mask & 0x04) != 0 ? readPacked() : 0;
+					effect = (mask & 0x08) != 0 ? readPacked() : 0;
+					parameter = (mask & 0x10) != 0 ? readPacked() : 0;
+				}
+				else
+				{
+					instrument = readPacked();
+					volume = readPacked();
+					effect = readPacked();
+					parameter = readPacked();
+				}
+				if (bytesRead > packedSize)
+				{
+					return Result::fail(name + " is damaged");
+				}
+
+				if (effect == 0xf && pattern == order[0] && row == 0)
+				{
+					applyTempoEffect(parameter, speed, moduleBpm);
+				}
+				if (instrument > 0)
+				{
+					lastInstrument[(size_t) channel] = instrument;
+				}
+
+				//instruments beyond the last slot have nowhere to play from, and key offs are dropped
+				const int slot = lastInstrument[(size_t) channel] - 1;
+				TrackerEvent event;
+				if (note > 0 && note < KeyOff && isPositiveAndBelow(slot, (int) SamplePool::NumberOfSlots))
+				{
+					float gain = -1.f;
+					if (volume >= 0x10 && volume <= 0x50)
+					{
+						gain = (volume - 0x10) / 64.f;
+					}
+					else if (effect == 0xc)
+					{
+						gain = jmin(64, parameter) / 64.f;
+					}
+					//XM note 49 is C-4, which plays the sample at its own rate
+					event = makeEvent(note - MiddleCNote + 60, slot, gain);
+				}
+				setModuleEffect(effect, parameter, event);
+				if (!event.isBlank())
+				{
+					builder.addEvent(channel, event);
+				}
+			}
+			builder.endRow();
+		}
+		builder.endPattern(numRows);
+		stream.skipNextBytes(packedSize - bytesRead);
+	}
+
+	//each instrument is read up to its sample headers, then the sample it plays at C-4 is decoded and the rest skipped
+	ProjectFile::Contents imported;
+	std::array<float, SamplePool::NumberOfSlots> slotGains;
+	slotGains.fill(1.f);
+	const int numSlotsUsed = jmin(numInstruments, (int) SamplePool::NumberOfSlots);
+	for (int instrument = 0; instrument < numSlotsUsed && !stream.isExhausted(); instrument++)
+	{
+		const int instrumentHeaderSize = stream.readInt();
+		stream.skipNextBytes(23);
+		const int numSamples = (uint16) stream.readShort();
+		if (numSamples == 0)
+		{
+			stream.skipNextBytes(instrumentHeaderSize - InstrumentHeaderStart);
+			continue;
+		}
+
+		const int sampleHeaderSize = stream.readInt();
+		uint8 keymap[96];
+		stream.read(keymap, (int) sizeof(keymap));
+		if (instrumentHeaderSize < InstrumentHeaderWithSamples || sampleHeaderSize < SampleHeaderFields)
+		{
+			return Result::fail(name + " is damaged");
+		}
+		stream.skipNextBytes(instrumentHeaderSize - InstrumentHeaderWithSamples);
+
+		struct SampleHeader
+		{
+			int length, loopLength, volume, finetune, type, relativeNote;
+		};
+		const int chosen = keymap[MiddleCNote - 1] < numSamples ? keymap[MiddleCNote - 1] : 0;
+		SampleHeader chosenHeader = {};
+		std::vector<int> lengths((size_t) numSamples);
+		for (int sample = 0; sample < numSamples; sample++)
+		{
+			SampleHeader sampleHeader;
+			sampleHeader.length = stream.readInt();
+			stream.skipNextBytes(4);
+			sampleHeader.loopLength = stream.readInt();
+			sampleHeader.volume = (uint8) stream.readByte();
+			sampleHeader.finetune = (int8) stream.readByte();
+			sampleHeader.type = (uint8) stream.readByte();
+			stream.skipNextBytes(1);
+			sampleHeader.relativeNote = (int8) stream.readByte();
+			//the reserved byte, the name and anything newer trackers have added
+			stream.skipNextBytes(sampleHeaderSize - SampleHeaderFields);
+
+			lengths[(size_t) sample] = jmax(0, sampleHeader.length);
+			if (sample == chosen)
+			{
+				chosenHeader = sampleHeader;
+			}
+		}
+
+		for (int sample = 0; sample < numSamples; sample++)
+		{
+			if (sample != chosen)
+			{
+				stream.skipNextBytes(lengths[(size_t) sample]);
+				continue;
+			}
+
+			//lengths are in bytes - 16 bit samples hold half as many frames, and stereo ones store each channel in turn
+			const bool sixteenBit = (chosenHeader.type & 0x10) != 0;
+			const int numSampleChannels = (chosenHeader.type & 0x20) != 0 ? 2 : 1;
+			const int numFrames = lengths[(size_t) sample] / ((sixteenBit ? 2 : 1) * numSampleChannels);
+			//finetune is in 128ths of a semitone
+			const double sampleRate = MiddleCSampleRate * std::pow(2.0, (chosenHeader.relativeNote + chosenHeader.finetune / 128.0) / 12.0);
+
+			ProjectFile::Slot& slot = imported.slots[(size_t) instrument];
+			slot.sample = readSample(stream, numFrames, numSampleChannels, sixteenBit, true, sampleRate);
+			slot.looping = (chosenHeader.type & 0x03) != 0 && chosenHeader.loopLength > 0;
+			slotGains[(size_t) instrument] = jmin(64, chosenHeader.volume) / 64.f;
+		}
+	}
+	builder.applySampleGains(slotGains);
+
+	imported.song = builder.build(std::move(order));
+	if (imported.song == nullptr)
+	{
+		return Result::fail(name + " is damaged");
+	}
+	imported.bpm = toSongBpm(speed, moduleBpm);
+	imported.ticksPerRow = jlimit(1, (int) Sequencer::MaximumTicksPerRow, speed);
+	contents = std::move(imported);
+	return Result::ok();
+}
@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+	ModuleImporter.h
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ProjectFile.h"
+
+/** Imports ProTracker MOD and FastTracker II XM modules as a project - the patterns and order list become a Song,
+	and each sample (in an XM, the sample each instrument plays at C-4) is decoded into the slot of the same number.
+	A module is read once, front to back, from an InputStream: pattern cells are written straight into the arena of
+	the new Song and PCM straight into the float buffer of each new sample, without reading any part of the module
+	into memory first.
+
+	Only what the engine can play is kept - the note, sample and volume of each cell, the effects the EffectEngine
+	shares with ProTracker, and the speed and tempo the song starts at. Other effects, loop points and XM envelopes
+	are dropped, a looped sample loops as a whole, and an XM whose patterns differ in length has the shorter ones
+	padded with empty rows. Portamento and vibrato keep their parameters, which are close to the engine's
+	sixteenths of a semitone in an XM with linear frequencies and only roughly so elsewhere. */
+
+class ModuleImporter
+{
+public:
+	/** Returns the wildcard matching the modules that can be imported, for FileChoosers. */
+	static String getWildcard();
+
+	/** Imports the module held in a file.
+		@param	File to read
+		@param	reference to the Contents to fill - slots the module has no sample for are left empty
+		@return	Result describing why the module could not be imported, if it could not */
+	static Result importFile(const File& file, ProjectFile::Contents& contents);
+
+	/** Imports a module from a stream, reading it once from its current position.
+		@param	reference to the InputStream to read
+		@param	String name of the module, used in error messages
+		@param	reference to the Contents to fill - slots the module has no sample for are left empty
+		@return	Result describing why the module could not be imported, if it could not */
+	static Result importStream(InputStream& stream, const String& name, ProjectFile::Contents& contents);
+
+	/** Holds the tempo modules start at unless they set their own, and the rate their samples are played at for C-4. */
+	enum
+	{
+		DefaultSpeed = 6,
+		DefaultModuleBpm = 125,
+		MiddleCSampleRate = 8363
+	};
+
+private:
+	/** Reads the rest of a MOD, once its header has been read.
+		@param	reference to the InputStream, positioned after the header
+		@param	pointer to the header - the 1084 bytes before the first pattern
+		@param	String name of the module, used in error messages
+		@param	reference to the Contents to fill
+		@return	Result describing why the module could not be imported, if it could not */
+	static Result importMod(InputStream& stream, const uint8* header, const String& name, ProjectFile::Contents& contents);
+
+	/** Reads the rest of an XM, once its ID text has been read.
+		@param	reference to the InputStream, positioned after the ID text
+		@param	String name of the module, used in error messages
+		@param	reference to the Contents to fill
+		@return	Result describing why the module could not be imported, if it could not */
+	static Result importXm(InputStream& stream, const String& name, ProjectFile::Contents& contents);
+};
@@ -0,0 +1,376 @@
+/*
+  ==============================================================================
+	ProjectFile.cpp
+  ==============================================================================
+*/
+
+#include "ProjectFile.h"
+
+#if JUCE_BIG_ENDIAN
+ #error "Project files are written and mapped in little-endian order"
+#endif
+
+/** The first bytes of every project file. */
+struct ProjectFile::Header
+{
+	char magic[4];
+	uint32 version;
+	int32 numChannels;
+	int32 numRows;
+	int32 numPatterns;
+	int32 orderLength;
+	int32 numEvents;
+	int32 numSlots;
+	int64 slotsOffset;
+	int64 orderOffset;
+	int64 rowOffsetsOffset;
+	int64 eventsOffset;
+	double bpm;
+	int32 ticksPerRow;
+	int32 swing;
+};
+
+/** The layout each event is stored in. Fixed in size with no padding, and written and read field by field - a
+	ChannelEvent's own layout is up to the compiler, so it is never copied to or from the file as it is. */
+struct ProjectFile::EventRecord
+{
+	int32 channel;
+	int32 note;
+	int32 sample;
+	float gain;
+	double pitchRatio;
+	int32 effect;
+	int32 effectParameter;
+};
+
+/** The settings of one slot, and where its path and any embedded audio are. */
+struct ProjectFile::SlotRecord
+{
+	/** Flags held by each slot. */
+	enum
+	{
+		Looping = 1 << 0,
+		Embedded = 1 << 1
+	};
+
+	int64 pathOffset;
+	int32 pathLength;
+	int32 flags;
+	double sampleRate;
+	int64 dataOffset;
+	int32 numChannels;
+	int32 lengthInSamples;
+};
+
+/** Returns the given offset rounded up to the next section boundary. */
+static int64 alignSection(int64 offset)
+{
+	return (offset + ProjectFile::SectionAlignment - 1) & ~(int64) (ProjectFile::SectionAlignment - 1);
+}
+
+/** Writes zeros up to the next section boundary. */
+static bool padToSection(OutputStream& stream)
+{
+	const int64 padding = alignSection(stream.getPosition()) - stream.getPosition();
+	return padding == 0 || stream.writeRepeatedByte(0, (size_t) padding);
+}
+
+/** Writes an event in the layout of an EventRecord. */
+static bool writeEventRecord(OutputStream& stream, const ChannelEvent& channelEvent)
+{
+	const TrackerEvent& event = channelEvent.event;
+	return stream.writeInt(channelEvent.channel) && stream.writeInt(event.note) && stream.writeInt(event.sample)
+		&& stream.writeFloat(event.gain) && stream.writeDouble(event.pitchRatio)
+		&& stream.writeInt(event.effect) && stream.writeInt(event.effectParameter);
+}
+
+/** Reads an event stored in the layout of an EventRecord. */
+static ChannelEvent readEventRecord(InputStream& stream)
+{
+	ChannelEvent channelEvent;
+	channelEvent.channel = stream.readInt();
+	channelEvent.event.note = stream.readInt();
+	channelEvent.event.sample = stream.readInt();
+	channelEvent.event.gain = stream.readFloat();
+	channelEvent.event.pitchRatio = stream.readDouble();
+	channelEvent.event.effect = stream.readInt();
+	channelEvent.event.effectParameter = stream.readInt();
+	return channelEvent;
+}
+
+/** Returns true if count elements of the given size starting at offset lie within a file of the given size. */
+static bool isRangeInFile(int64 offset, int64 count, size_t elementSize, size_t fileSize)
+{
+	return offset >= 0 && count >= 0
+		&& offset <= (int64) fileSize
+		&& count <= ((int64) fileSize - offset) / (int64) jmax((size_t) 1, elementSize);
+}
+
+String ProjectFile::getWildcard()
+{
+	return "*." + getExtension();
+}
+
+String ProjectFile::getExtension()
+{
+	return "jtp";
+}
+
+Result ProjectFile::save(const File& file, const Contents& contents, bool embedSamples)
+{
+	//the records are copied to and from the file byte for byte, so their layout must never change - events are
+	//written field by field, and their record only gives the size and order of the fields
+	static_assert(sizeof(Header) == 80 && offsetof(Header, slotsOffset) == 32 && offsetof(Header, bpm) == 64, "Header layout has changed");
+	static_assert(sizeof(SlotRecord) == 40 && offsetof(SlotRecord, sampleRate) == 16, "SlotRecord layout has changed");
+	static_assert(sizeof(EventRecord) == 32 && offsetof(EventRecord, pitchRatio) == 16 && offsetof(EventRecord, effectParameter) == 28,
+				  "EventRecord layout has changed");
+
+	const Song* song = contents.song.get();
+	if (song == nullptr)
+	{
+		return Result::fail("There is no song to save");
+	}
+
+	//works out where every section goes before anything is written, so the records can point forwards
+	const int numRowsInSong = song->getNumPatterns() * song->getNumRows();
+	Header header = {};
+	memcpy(header.magic, "JTRK", 4);
+	header.version = FormatVersion;
+	header.bpm = contents.bpm;
+	header.ticksPerRow = contents.ticksPerRow;
+	header.swing = contents.swing;
+	header.numChannels = song->getNumChannels();
+	header.numRows = song->getNumRows();
+	header.numPatterns = song->getNumPatterns();
+	header.orderLength = song->getOrderLength();
+	header.numEvents = song->getNumEvents();
+	header.numSlots = SamplePool::NumberOfSlots;
+	header.slotsOffset = alignSection(sizeof(Header));
+	header.orderOffset = alignSection(header.slotsOffset + (int64) sizeof(SlotRecord) * header.numSlots);
+	header.rowOffsetsOffset = alignSection(header.orderOffset + (int64) sizeof(int32) * header.orderLength);
+	header.eventsOffset = alignSection(header.rowOffsetsOffset + (int64) sizeof(int32) * (numRowsInSong + 1));
+
+	std::array<SlotRecord, SamplePool::NumberOfSlots> records = {};
+	std::array<std::string, SamplePool::NumberOfSlots> paths;
+	int64 offset = header.eventsOffset + (int64) sizeof(EventRecord) * header.numEvents;
+	for (size_t slot = 0; slot < records.size(); slot++)
+	{
+		const Slot& source = contents.slots[slot];
+		SlotRecord& record = records[slot];
+
+		paths[slot] = source.file == File() ? std::string() : source.file.getFullPathName().toStdString();
+		record.pathOffset = alignSection(offset);
+		record.pathLength = (int32) paths[slot].size();
+		record.flags = source.looping ? SlotRecord::Looping : 0;
+		offset = record.pathOffset + record.pathLength;
+	}
+	for (size_t slot = 0; slot < records.size(); slot++)
+	{
+		const PooledSample* sample = contents.slots[slot].sample.get();
+		if (!embedSamples || sample == nullptr || sample->isEmpty())
+		{
+			continue;
+		}
+
+		SlotRecord& record = records[slot];
+		record.flags |= SlotRecord::Embedded;
+		record.sampleRate = sample->getSampleRate();
+		record.numChannels = sample->getData().getNumChannels();
+		record.lengthInSamples = sample->getLengthInSamples();
+		record.dataOffset = alignSection(offset);
+		offset = record.dataOffset + (int64) sizeof(float) * record.numChannels * record.lengthInSamples;
+	}
+
+	//writes to a temporary file first, so a failed save never damages the project already on disk
+	TemporaryFile temporaryFile(file);
+	{
+		FileOutputStream stream(temporaryFile.getFile());
+		if (!stream.openedOk())
+		{
+			return Result::fail("Could not open " + file.getFullPathName() + " for writing");
+		}
+
+		bool ok = stream.write(&header, sizeof(Header)) && padToSection(stream)
+				&& stream.write(records.data(), sizeof(SlotRecord) * records.size()) && padToSection(stream);
+		for (int position = 0; ok && position < header.orderLength; position++)
+		{
+			ok = stream.writeInt(song->getPatternAtOrder(position));
+		}
+		ok = ok && padToSection(stream)
+			&& stream.write(song->getRowOffsetData(), sizeof(int32) * (size_t) (numRowsInSong + 1)) && padToSection(stream);
+		const ChannelEvent* events = song->getEventData();
+		for (int i = 0; ok && i < header.numEvents; i++)
+		{
+			ok = writeEventRecord(stream, events[i]);
+		}
+		for (size_t slot = 0; ok && slot < records.size(); slot++)
+		{
+			ok = padToSection(stream) && stream.write(paths[slot].data(), paths[slot].size());
+		}
+		for (size_t slot = 0; ok && slot < records.size(); slot++)
+		{
+			if ((records[slot].flags & SlotRecord::Embedded) != 0)
+			{
+				const auto& data = contents.slots[slot].sample->getData();
+				ok = padToSection(stream);
+				for (int channel = 0; ok && channel < data.getNumChannels(); channel++)
+				{
+					ok = stream.write(data.getReadPointer(channel), sizeof(float) * (size_t) data.getNumSamples());
+				}
+			}
+		}
+
+		stream.flush();
+		if (!ok || stream.getStatus().failed())
+		{
+			return Result::fail("Could not write to " + file.getFullPathName());
+		}
+	}
+
+	if (!temporaryFile.overwriteTargetFileWithTemporary())
+	{
+		return Result::fail("Could not replace " + file.getFullPathName() + " - it may be open in another program");
+	}
+	return Result::ok();
+}
+
+Result ProjectFile::load(const File& file, Contents& contents)
+{
+	auto mapping = std::make_shared<MemoryMappedFile>(file, MemoryMappedFile::readOnly);
+	const auto* data = static_cast<const char*>(mapping->getData());
+	const size_t size = mapping->getSize();
+	if (data == nullptr || size < sizeof(Header))
+	{
+		return Result::fail("Could not open " + file.getFullPathName());
+	}
+
+	Header header;
+	memcpy(&header, data, sizeof(Header));
+	if (memcmp(header.magic, "JTRK", 4) != 0)
+	{
+		return Result::fail(file.getFileName() + " is not a project file");
+	}
+	if (header.version != FormatVersion)
+	{
+		return Result::fail(file.getFileName() + " was saved by a version of JuceTracker this one can't read");
+	}
+
+	//every section is checked to lie within the file before anything is read from it - the song checks the rest
+	const int64 numRowsInSong = (int64) header.numPatterns * header.numRows;
+	if (header.numSlots != SamplePool::NumberOfSlots
+		|| header.numPatterns <= 0 || header.numRows <= 0 || numRowsInSong > (int64) Song::MaximumNumberOfPatterns * Pattern::MaximumNumberOfRows
+		|| !isRangeInFile(header.slotsOffset, header.numSlots, sizeof(SlotRecord), size)
+		|| !isRangeInFile(header.orderOffset, header.orderLength, sizeof(int32), size)
+		|| !isRangeInFile(header.rowOffsetsOffset, numRowsInSong + 1, sizeof(int32), size)
+		|| !isRangeInFile(header.eventsOffset, header.numEvents, sizeof(EventRecord), size)
+		|| header.orderOffset % alignof(int32) != 0
+		|| header.rowOffsetsOffset % alignof(int32) != 0)
+	{
+		return Result::fail(file.getFileName() + " is damaged");
+	}
+
+	//the row offsets and order list are used where they lie in the mapping, and the events are read out of their
+	//records - each is copied once into the new Song
+	std::vector<ChannelEvent> events((size_t) header.numEvents);
+	MemoryInputStream stream(data + header.eventsOffset, sizeof(EventRecord) * events.size(), false);
+	for (auto& event : events)
+	{
+		event = readEventRecord(stream);
+	}
+	for (auto& event : events)
+	{
+		if (event.event.sample >= SamplePool::NumberOfSlots)
+		{
+			return Result::fail(file.getFileName() + " is damaged");
+		}
+	}
+	Song::Ptr song = Song::createFromData(header.numChannels, header.numRows, header.numPatterns,
+											events.data(), header.numEvents,
+											reinterpret_cast<const int32*>(data + header.rowOffsetsOffset),
+											reinterpret_cast<const int32*>(data + header.orderOffset), header.orderLength);
+	if (song == nullptr)
+	{
+		return Result::fail(file.getFileName() + " is damaged");
+	}
+
+	Contents loaded;
+	loaded.song = song;
+	loaded.bpm = std::isfinite(header.bpm) ? jlimit(1.0, 999.0, header.bpm) : 130.0;
+	loaded.ticksPerRow = jlimit(1, (int) Sequencer::MaximumTicksPerRow, (int) header.ticksPerRow);
+	loaded.swing = jlimit((int) Sequencer::StraightSwing, (int) Sequencer::MaximumSwing, (int) header.swing);
+
+	bool anyEmbedded = false;
+	for (size_t slot = 0; slot < loaded.slots.size(); slot++)
+	{
+		SlotRecord record;
+		memcpy(&record, data + header.slotsOffset + (int64) (sizeof(SlotRecord) * slot), sizeof(SlotRecord));
+		if (!isRangeInFile(record.pathOffset, record.pathLength, 1, size))
+		{
+			return Result::fail(file.getFileName() + " is damaged");
+		}
+
+		Slot& target = loaded.slots[slot];
+		target.looping = (record.flags & SlotRecord::Looping) != 0;
+		if (record.pathLength > 0)
+		{
+			target.file = File(String::fromUTF8(data + record.pathOffset, record.pathLength));
+			//a project moved along with its samples finds them next to it
+			if (!target.file.existsAsFile() && file.getSiblingFile(target.file.getFileName()).existsAsFile())
+			{
+				target.file = file.getSiblingFile(target.file.getFileName());
+			}
+		}
+
+		if ((record.flags & SlotRecord::Embedded) != 0)
+		{
+			if (!isPositiveAndNotGreaterThan(record.numChannels, 2) || record.numChannels == 0 || record.lengthInSamples <= 0
+				|| record.sampleRate <= 0.0 || record.dataOffset % alignof(float) != 0
+				|| !isRangeInFile(record.dataOffset, (int64) record.numChannels * record.lengthInSamples, sizeof(float), size))
+			{
+				return Result::fail(file.getFileName() + " is damaged");
+			}
+
+			//the channels are stored one after the other, and played from where they lie
+			const auto* firstChannel = reinterpret_cast<const float*>(data + record.dataOffset);
+			const float* channels[2] = { firstChannel, firstChannel + record.lengthInSamples };
+			target.sample = new PooledSample(mapping, channels, record.numChannels, record.lengthInSamples, record.sampleRate);
+			anyEmbedded = true;
+		}
+	}
+
+	//without embedded samples nothing refers to the mapping, and it is closed as soon as this returns
+	if (anyEmbedded)
+	{
+		loaded.mapping = mapping;
+	}
+	contents = std::move(loaded);
+	return Result::ok();
+}
+
+MappedFileWarmer::MappedFileWarmer(std::shared_ptr<MemoryMappedFile> mappingToWarm)
+																		:	Thread("Mapped File Warmer"),
+																			mapping(std::move(mappingToWarm)),
+																			checksum(0)
+{
+	startThread(2);
+}
+
+MappedFileWarmer::~MappedFileWarmer()
+{
+	stopThread(2000);
+}
+
+void MappedFileWarmer::run()
+{
+	//reading a single byte of a page is enough for the system to bring the whole page into memory
+	const auto* data = static_cast<const uint8*>(mapping->getData());
+	const size_t pageSize = 4096;
+	uint8 sum = 0;
+	for (size_t position = 0; data != nullptr && position < mapping->getSize() && !threadShouldExit(); position += pageSize)
+	{
+		sum = (uint8) (sum + data[position]);
+	}
+	//stores the sum so the reads can't be optimised away
+	checksum = sum;
+	mapping = nullptr;
+}
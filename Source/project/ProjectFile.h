@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+	ProjectFile.h
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include "../audio/fileaudio/SamplePool.h"
+#include "../audio/trackeraudio/Song.h"
+#include "../audio/trackeraudio/Sequencer.h"
+
+/** Reads and writes projects - the song, tempo and slot settings, and optionally the decoded audio of every
+	preloaded sample - in a compact binary format laid out to be memory-mapped. Every section starts on a 16 byte
+	boundary, so opening a project is one mapping, a few range checks and a copy of the song's arrays. Embedded
+	samples are played straight from the mapping and are never copied.
+
+	Layout, in little-endian order:
+	- Header, at the start of the file
+	- one SlotRecord for each slot of the SamplePool, at Header::slotsOffset
+	- the order list as int32s, at Header::orderOffset
+	- the offset of each row's first event as int32s, at Header::rowOffsetsOffset - see Song::getRowOffsetData()
+	- the events as EventRecords, at Header::eventsOffset - see Song::getEventData()
+	- the path of each slot's file as UTF-8, at SlotRecord::pathOffset
+	- the planar float audio of each embedded sample, at SlotRecord::dataOffset */
+
+class ProjectFile
+{
+public:
+	/** What a slot holds in a project. */
+	struct Slot
+	{
+		/** File the slot was loaded from, or File() if it was empty. */
+		File file;
+		/** True if the slot loops. */
+		bool looping = false;
+		/** The decoded sample embedded in the project, or nullptr if the file is to be loaded from disk. */
+		PooledSample::Ptr sample;
+	};
+
+	/** Everything a project holds. */
+	struct Contents
+	{
+		Song::Ptr song;
+		double bpm = 130.0;
+		int ticksPerRow = Sequencer::DefaultTicksPerRow;
+		int swing = Sequencer::StraightSwing;
+		std::array<Slot, SamplePool::NumberOfSlots> slots;
+		/** The open project file, which embedded samples are played from - nullptr if none are embedded. */
+		std::shared_ptr<MemoryMappedFile> mapping;
+	};
+
+	/** Holds the version of the format written, and the alignment of every section. */
+	enum
+	{
+		FormatVersion = 1,
+		SectionAlignment = 16
+	};
+
+	/** Returns the wildcard matching project files, for FileChoosers. */
+	static String getWildcard();
+
+	/** Returns the extension given to project files, without a leading dot. */
+	static String getExtension();
+
+	/** Writes a project to a file, replacing it only once the new project has been written in full.
+		@param	File to write to
+		@param	Contents to write - samples that are nullptr or empty are stored as a path only
+		@param	bool true to embed the decoded audio of every sample that is not nullptr or empty
+		@return	Result describing why the project could not be written, if it could not */
+	static Result save(const File& file, const Contents& contents, bool embedSamples);
+
+	/** Opens a project file by memory-mapping it. Embedded samples refer to the mapping, which stays open for as
+		long as any of them is alive.
+		@param	File to read
+		@param	reference to the Contents to fill
+		@return	Result describing why the project could not be read, if it could not */
+	static Result load(const File& file, Contents& contents);
+
+private:
+	struct Header;
+	struct SlotRecord;
+	struct EventRecord;
+};
+
+/** Reads one byte of every page of a memory-mapped file on a background thread, so the pages holding embedded
+	samples are in memory before the audio thread plays them, rather than being read from disk mid-callback. */
+
+class MappedFileWarmer		:	private Thread
+{
+public:
+	/** Constructor. Starts reading straight away.
+		@param	shared pointer to the mapping to read, kept open until this object is deleted or has finished */
+	MappedFileWarmer(std::shared_ptr<MemoryMappedFile> mappingToWarm);
+
+	/** Destructor. Stops reading if it has not finished. */
+	~MappedFileWarmer();
+
+private:
+	//Thread
+	/** Overridden function inherited from Thread. Touches every page of the mapping, then lets it go. */
+	void run() override;
+
+	std::shared_ptr<MemoryMappedFile> mapping;
+	std::atomic<uint8> checksum;
+};
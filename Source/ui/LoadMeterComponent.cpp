@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+	LoadMeterComponent.cpp
+  ==============================================================================
+*/
+
+#include "LoadMeterComponent.h"
+
+LoadMeterComponent::LoadMeterComponent(Audio& a)		:	audio(a),
+															load(0.f),
+															peakLoad(0.f),
+															overruns(0),
+															deviceXRuns(0),
+															underruns(0)
+{
+	histogram.fill(0);
+	startTimerHz(10);
+}
+
+LoadMeterComponent::~LoadMeterComponent()
+{
+	stopTimer();
+}
+
+void LoadMeterComponent::paint(Graphics& g)
+{
+	auto r = getLocalBounds();
+	g.setColour(Colours::black.withAlpha(0.6f));
+	g.fillRoundedRectangle(r.toFloat(), 4.f);
+
+	//anything getting close to the deadline is shown in orange, anything past it in red
+	const bool hasOverrun = overruns > 0 || deviceXRuns > 0 || underruns > 0;
+	const Colour loadColour = hasOverrun ? Colours::red : (peakLoad > 0.7f ? Colours::orange : Colours::lightgreen);
+
+	r.reduce(6, 2);
+	auto histogramBounds = r.removeFromRight(CallbackTelemetry::NumberOfBins * 4).toFloat();
+
+	g.setColour(loadColour);
+	g.setFont(12.f);
+	g.drawText("DSP " + String(roundToInt(load * 100.f)) + "% (peak " + String(roundToInt(peakLoad * 100.f)) + "%)"
+				+ "  overruns " + String(overruns)
+				+ "  xruns " + String(deviceXRuns)
+				+ "  underruns " + String(underruns),
+				r, Justification::centredLeft, true);
+
+	//each bar is the share of callbacks whose load fell in that bin, scaled to the fullest bin
+	int64 largestCount = 1;
+	for (auto count : histogram)
+	{
+		largestCount = jmax(largestCount, count);
+	}
+	for (int bin = 0; bin < CallbackTelemetry::NumberOfBins; bin++)
+	{
+		const float height = histogramBounds.getHeight() * (float) histogram[(size_t) bin] / (float) largestCount;
+		g.setColour(bin == CallbackTelemetry::NumberOfBins - 1 ? Colours::red : Colours::lightgrey);
+		g.fillRect(histogramBounds.getX() + bin * 4.f, histogramBounds.getBottom() - height, 3.f, height);
+	}
+}
+
+void LoadMeterComponent::mouseDown(const MouseEvent&)
+{
+	audio.resetTelemetry();
+	histogram.fill(0);
+	peakLoad = 0.f;
+	overruns = 0;
+	deviceXRuns = 0;
+	underruns = 0;
+	repaint();
+}
+
+void LoadMeterComponent::timerCallback()
+{
+	CallbackTelemetry& telemetry = audio.getTelemetry();
+	load = telemetry.getLoad();
+	//the peak is held and falls away slowly, so a single slow callback stays visible for a moment
+	peakLoad = jmax(telemetry.takePeakLoad(), peakLoad * 0.9f);
+	overruns = telemetry.getNumOverruns();
+	deviceXRuns = audio.getDeviceXRunCount();
+	underruns = audio.getStreamUnderrunCount();
+	for (int bin = 0; bin < CallbackTelemetry::NumberOfBins; bin++)
+	{
+		histogram[(size_t) bin] = telemetry.getHistogramCount(bin);
+	}
+	repaint();
+}
@@ -0,0 +1,43 @@
+/*
+  ==============================================================================
+	LoadMeterComponent.h
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../audio/Audio.h"
+
+/** Small overlay showing how close the audio callback is getting to its deadline: the current and peak load, a
+	histogram of the load of every callback, and counts of overruns, device xruns and streamed file underruns.
+	Polls the Audio object's telemetry from the message thread. Clicking it resets the counts. */
+
+class LoadMeterComponent		:	public Component,
+									private Timer
+{
+public:
+	/** Constructor.
+		@param	reference to the Audio object to follow */
+	LoadMeterComponent(Audio& a);
+
+	/** Destructor. */
+	~LoadMeterComponent();
+
+	//Component
+	void paint(Graphics&) override;
+	void mouseDown(const MouseEvent&) override;
+
+private:
+	//Timer
+	/** Overridden function inherited from Timer. Reads the latest telemetry and repaints. */
+	void timerCallback() override;
+
+	Audio& audio;
+	float load;
+	float peakLoad;
+	int64 overruns;
+	int deviceXRuns;
+	int underruns;
+	std::array<int64, CallbackTelemetry::NumberOfBins> histogram;
+};
@@ -9,7 +9,9 @@
 MainComponent::MainComponent(Audio& a)		:	audio(a),
 												fileManagerComponent(a),
 												trackerComponent(audio.getFilePlayerArray(), a),
-												tabs(TabbedButtonBar::Orientation::TabsAtTop)
+												tabs(TabbedButtonBar::Orientation::TabsAtTop),
+												loadMeter(a),
+												sampleLoadProgress(0.0)
 {
 	fileManagerViewport.setViewedComponent(&fileManagerComponent);
 	//hides the redundant horizontal scrollbar
@@ -22,19 +24,26 @@ MainComponent::MainComponent(Audio& a)		:	audio(a),
 	tabs.addTab("Sample Manager", getLookAndFeel().findColour(juce::TabbedComponent::backgroundColourId), &fileManagerViewport, true);
 	tabs.addTab("Tracker", getLookAndFeel().findColour(juce::TabbedComponent::backgroundColourId), &trackerComponent, true);
 	addAndMakeVisible(tabs);
+	//the load meter sits over the right hand end of the tab bar, with the sample loading progress beside it while files load
+	addAndMakeVisible(loadMeter);
+	sampleLoadBar.setTextToDisplay("Loading samples");
+	addChildComponent(sampleLoadBar);
+	audio.getSampleLoader().addListener(this);
 
 	setSize(1280, 720);
 }
 
 MainComponent::~MainComponent()
 {
-
+	audio.getSampleLoader().removeListener(this);
 }
 
 void MainComponent::resized()
 {
 	auto r = getLocalBounds();
 	tabs.setBounds(r);
+	loadMeter.setBounds(r.getRight() - 400, 2, 396, tabs.getTabBarDepth() - 4);
+	sampleLoadBar.setBounds(loadMeter.getX() - 204, 2, 200, tabs.getTabBarDepth() - 4);
 
 	//each FilePlayerGui is 40px high - set the height of this component to be 40 * number of FilePlayerGui objects
 	//does not matter if this component is larger than the size of the window - it will be scrollable via the Viewport
@@ -55,7 +64,45 @@ PopupMenu MainComponent::getMenuForIndex(int topLevelMenuIndex, const String& me
 {
 	PopupMenu menu;
 	if (topLevelMenuIndex == 0)
+	{
+		menu.addItem(OpenProject, "Open Project...", true, false);
+		menu.addItem(SaveProject, "Save Project...", true, false);
+		menu.addItem(SaveProjectWithSamples, "Save Project with Samples...", true, false);
+		menu.addItem(ImportModule, "Import Module...", true, false);
+		menu.addSeparator();
 		menu.addItem(AudioPrefs, "Audio Prefrences", true, false);
+		menu.addSeparator();
+		menu.addItem(StealOldestVoice, "Steal Oldest Voice", true, audio.getVoiceStealingPolicy() == VoicePool::StealOldest);
+		menu.addItem(StealQuietestVoice, "Steal Quietest Voice", true, audio.getVoiceStealingPolicy() == VoicePool::StealQuietest);
+
+		PopupMenu interpolationMenu;
+		for (int mode = 0; mode < SampleInterpolator::NumModes; mode++)
+		{
+			interpolationMenu.addItem(FirstInterpolationMode + mode, SampleInterpolator::getModeName((SampleInterpolator::Mode) mode),
+				true, audio.getInterpolationMode() == mode);
+		}
+		menu.addSubMenu("Interpolation", interpolationMenu);
+		menu.addItem(ParallelRendering, "Render Voices on Every Core", true, audio.isParallelRendering());
+
+		//the devices are listed afresh each time the menu opens, so ones plugged in since are offered
+		const String clockOutput = audio.getMidiClockOutputIdentifier();
+		bool isClockOnDevice = false;
+		PopupMenu midiClockMenu;
+		midiClockMenu.addItem(MidiClockOff, "None", true, clockOutput.isEmpty());
+		const auto devices = MidiOutput::getAvailableDevices();
+		for (int i = 0; i < jmin(devices.size(), LastMidiClockDevice - FirstMidiClockDevice + 1); i++)
+		{
+			isClockOnDevice = isClockOnDevice || devices[i].identifier == clockOutput;
+			midiClockMenu.addItem(FirstMidiClockDevice + i, devices[i].name, true, devices[i].identifier == clockOutput);
+		}
+#if ! JUCE_WINDOWS
+		midiClockMenu.addItem(MidiClockVirtualPort, "Virtual Port", true, clockOutput.isNotEmpty() && !isClockOnDevice);
+#endif
+		menu.addSubMenu("Send MIDI Clock", midiClockMenu);
+		menu.addSeparator();
+		menu.addItem(RenderMix, "Render to WAV...", true, false);
+		menu.addItem(RenderMixAndStems, "Render to WAV with Stems...", true, false);
+	}
 	return menu;
 }
 
@@ -76,5 +123,241 @@ void MainComponent::menuItemSelected(int menuItemID, int topLevelMenuIndex)
 			la.componentToCentreAround = this;
 			la.launchAsync();
 		}
+		else if (menuItemID == StealOldestVoice)
+		{
+			audio.setVoiceStealingPolicy(VoicePool::StealOldest);
+		}
+		else if (menuItemID == StealQuietestVoice)
+		{
+			audio.setVoiceStealingPolicy(VoicePool::StealQuietest);
+		}
+		else if (menuItemID >= FirstInterpolationMode && menuItemID <= LastInterpolationMode)
+		{
+			audio.setInterpolationMode((SampleInterpolator::Mode) (menuItemID - FirstInterpolationMode));
+		}
+		else if (menuItemID == ParallelRendering)
+		{
+			audio.setParallelRendering(!audio.isParallelRendering());
+		}
+		else if (menuItemID >= MidiClockOff && menuItemID <= LastMidiClockDevice)
+		{
+			setMidiClockOutput(menuItemID);
+		}
+		else if (menuItemID == RenderMix || menuItemID == RenderMixAndStems)
+		{
+			renderToFile(menuItemID == RenderMixAndStems);
+		}
+		else if (menuItemID == OpenProject)
+		{
+			openProject();
+		}
+		else if (menuItemID == SaveProject || menuItemID == SaveProjectWithSamples)
+		{
+			saveProject(menuItemID == SaveProjectWithSamples);
+		}
+		else if (menuItemID == ImportModule)
+		{
+			importModule();
+		}
 	}
 }
+
+//SampleLoader::Listener
+void MainComponent::sampleLoadStarted(int)
+{
+	sampleLoadProgress = audio.getSampleLoader().getProgress();
+	sampleLoadBar.setVisible(true);
+}
+
+void MainComponent::sampleLoadFinished(int, const Result&)
+{
+	sampleLoadProgress = audio.getSampleLoader().getProgress();
+	sampleLoadBar.setVisible(audio.getSampleLoader().isLoading());
+}
+
+void MainComponent::renderToFile(bool renderStems)
+{
+	//only one render runs at a time
+	if (renderWindow != nullptr && renderWindow->isThreadRunning())
+	{
+		return;
+	}
+
+	renderChooser = std::make_unique<FileChooser>("Render to WAV",
+												File::getSpecialLocation(File::userMusicDirectory).getChildFile("Song.wav"),
+												"*.wav");
+	renderChooser->launchAsync(FileBrowserComponent::saveMode | FileBrowserComponent::canSelectFiles | FileBrowserComponent::warnAboutOverwriting,
+		[this, renderStems] (const FileChooser& chooser)
+		{
+			const File file = chooser.getResult();
+			if (file == File())
+			{
+				return;
+			}
+
+			//renders at the device's sample rate, so the bounce matches what is heard
+			OfflineRenderer::Settings settings;
+			if (auto* device = audio.getAudioDeviceManager().getCurrentAudioDevice())
+			{
+				settings.sampleRate = device->getCurrentSampleRate();
+			}
+			settings.renderStems = renderStems;
+
+			renderWindow = std::make_unique<RenderWindow>(audio, file.withFileExtension("wav"), settings);
+			renderWindow->launchThread();
+		});
+}
+
+void MainComponent::openProject()
+{
+	projectChooser = std::make_unique<FileChooser>("Open Project", projectFile, ProjectFile::getWildcard());
+	projectChooser->launchAsync(FileBrowserComponent::openMode | FileBrowserComponent::canSelectFiles,
+		[this] (const FileChooser& chooser)
+		{
+			const File file = chooser.getResult();
+			if (file == File())
+			{
+				return;
+			}
+
+			ProjectFile::Contents contents;
+			auto result = ProjectFile::load(file, contents);
+			if (result.failed())
+			{
+				AlertWindow::showMessageBoxAsync(AlertWindow::WarningIcon, "Open Project", result.getErrorMessage());
+				return;
+			}
+			projectFile = file;
+			applyProjectContents(contents);
+		});
+}
+
+void MainComponent::setMidiClockOutput(int menuItemID)
+{
+	std::unique_ptr<MidiOutput> output;
+	if (menuItemID == MidiClockVirtualPort)
+	{
+		//other software on this machine sees the port as an input named after the application
+		output = MidiOutput::createNewDevice(JUCEApplication::getInstance()->getApplicationName() + " Clock");
+	}
+	else if (menuItemID >= FirstMidiClockDevice)
+	{
+		const auto devices = MidiOutput::getAvailableDevices();
+		if (isPositiveAndBelow(menuItemID - FirstMidiClockDevice, devices.size()))
+		{
+			output = MidiOutput::openDevice(devices[menuItemID - FirstMidiClockDevice].identifier);
+		}
+	}
+
+	if (output == nullptr && menuItemID != MidiClockOff)
+	{
+		AlertWindow::showMessageBoxAsync(AlertWindow::WarningIcon, "MIDI Clock", "The MIDI output could not be opened.");
+		return;
+	}
+	audio.setMidiClockOutput(std::move(output));
+}
+
+void MainComponent::importModule()
+{
+	projectChooser = std::make_unique<FileChooser>("Import Module", projectFile.getParentDirectory(), ModuleImporter::getWildcard());
+	projectChooser->launchAsync(FileBrowserComponent::openMode | FileBrowserComponent::canSelectFiles,
+		[this] (const FileChooser& chooser)
+		{
+			const File file = chooser.getResult();
+			if (file == File())
+			{
+				return;
+			}
+
+			ProjectFile::Contents contents;
+			auto result = ModuleImporter::importFile(file, contents);
+			if (result.failed())
+			{
+				AlertWindow::showMessageBoxAsync(AlertWindow::WarningIcon, "Import Module", result.getErrorMessage());
+				return;
+			}
+			//the module itself is never overwritten - saving offers a project of the same name instead
+			projectFile = file.withFileExtension(ProjectFile::getExtension());
+			applyProjectContents(contents);
+		});
+}
+
+void MainComponent::applyProjectContents(ProjectFile::Contents& contents)
+{
+	//embedded samples go straight into their slots - the rest are loaded from their files as if chosen by hand
+	for (int slot = 0; slot < Audio::NumberOfFilePlayers; slot++)
+	{
+		const auto& projectSlot = contents.slots[(size_t) slot];
+		FilePlayer* filePlayer = audio.getFilePlayer(slot);
+		filePlayer->setLooping(projectSlot.looping);
+		if (projectSlot.sample != nullptr)
+		{
+			audio.getSampleLoader().cancel(slot);
+			filePlayer->loadSample(projectSlot.sample, projectSlot.file);
+		}
+		else
+		{
+			//every file decodes in parallel in the background - a missing file just empties its slot
+			audio.getSampleLoader().loadFile(slot, projectSlot.file.existsAsFile() ? projectSlot.file : File());
+		}
+	}
+	fileManagerComponent.updateFromFilePlayers();
+	trackerComponent.setSong(contents.song, contents.bpm, contents.ticksPerRow, contents.swing);
+
+	//brings the embedded samples into memory in the background, before they are first played
+	mappedFileWarmer = nullptr;
+	projectMapping = contents.mapping;
+	if (contents.mapping != nullptr)
+	{
+		mappedFileWarmer = std::make_unique<MappedFileWarmer>(contents.mapping);
+	}
+}
+
+void MainComponent::saveProject(bool embedSamples)
+{
+	const File defaultFile = projectFile != File() ? projectFile
+												: File::getSpecialLocation(File::userDocumentsDirectory).getChildFile("Song.jtp");
+	projectChooser = std::make_unique<FileChooser>("Save Project", defaultFile, ProjectFile::getWildcard());
+	projectChooser->launchAsync(FileBrowserComponent::saveMode | FileBrowserComponent::canSelectFiles | FileBrowserComponent::warnAboutOverwriting,
+		[this, embedSamples] (const FileChooser& chooser)
+		{
+			if (chooser.getResult() == File())
+			{
+				return;
+			}
+			const File file = chooser.getResult().withFileExtension(ProjectFile::getExtension());
+
+			//a file can't be replaced while it is mapped - saving over the open project first moves the samples
+			//embedded in it into memory, so nothing is played from the file any more and the mapping closes
+			if (file == projectFile)
+			{
+				if (auto mapping = projectMapping.lock())
+				{
+					mappedFileWarmer = nullptr;
+					audio.copySamplesFromMapping(*mapping);
+				}
+			}
+
+			ProjectFile::Contents contents;
+			contents.song = trackerComponent.getSong();
+			contents.bpm = trackerComponent.getBpm();
+			contents.ticksPerRow = trackerComponent.getTicksPerRow();
+			contents.swing = trackerComponent.getSwing();
+			for (int slot = 0; slot < Audio::NumberOfFilePlayers; slot++)
+			{
+				FilePlayer* filePlayer = audio.getFilePlayer(slot);
+				auto& projectSlot = contents.slots[(size_t) slot];
+				projectSlot.file = filePlayer->getFile();
+				projectSlot.looping = filePlayer->isLooping();
+				projectSlot.sample = audio.getPreloadedSample(slot);
+			}
+
+			auto result = ProjectFile::save(file, contents, embedSamples);
+			if (result.failed())
+			{
+				AlertWindow::showMessageBoxAsync(AlertWindow::WarningIcon, "Save Project", result.getErrorMessage());
+				return;
+			}
+			projectFile = file;
+		});
+}
@@ -11,10 +11,15 @@
 #include "./fileui/FilePlayerGui.h"
 #include "./fileui/FileManagerComponent.h"
 #include "./trackerui/TrackerComponent.h"
+#include "./RenderWindow.h"
+#include "./LoadMeterComponent.h"
+#include "../project/ProjectFile.h"
+#include "../project/ModuleImporter.h"
 
 /**  This class is a component used to control the GUI. */
 class MainComponent		:	public Component,
-							public MenuBarModel
+							public MenuBarModel,
+							private SampleLoader::Listener
 {
 public:
 	/** Constructor. 
@@ -43,17 +48,73 @@ public:
 	enum FileMenuItems
 	{
 		AudioPrefs = 1,
+		StealOldestVoice,
+		StealQuietestVoice,
+		FirstInterpolationMode,
+		LastInterpolationMode = FirstInterpolationMode + SampleInterpolator::NumModes - 1,
+		RenderMix,
+		RenderMixAndStems,
+		OpenProject,
+		SaveProject,
+		SaveProjectWithSamples,
+		ImportModule,
+		ParallelRendering,
+		MidiClockOff,
+		MidiClockVirtualPort,
+		FirstMidiClockDevice,
+		LastMidiClockDevice = FirstMidiClockDevice + 63,
 
 		NumFileItems
 	};
 
 private:
+	//SampleLoader::Listener
+	/** Overridden function inherited from SampleLoader::Listener. Shows the progress bar while files are loading.
+		@param	int slot the file is loading into */
+	void sampleLoadStarted(int slot) override;
+	/** Overridden function inherited from SampleLoader::Listener. Moves the progress bar on, and hides it once every file has loaded.
+		@param	int slot the file was loaded into
+		@param	Result of the load */
+	void sampleLoadFinished(int slot, const Result& result) override;
+
+	/** Asks for a file to write to, then renders the song into it offline behind a progress window.
+		@param	bool true to write one file per channel alongside the master mix */
+	void renderToFile(bool renderStems);
+
+	/** Asks for a project file, then opens it in place of the current song and samples. */
+	void openProject();
+
+	/** Asks for a file to write to, then saves the song, tempo and slot settings into it.
+		@param	bool true to embed the audio of every preloaded sample, so the project opens without the original files */
+	void saveProject(bool embedSamples);
+
+	/** Sends MIDI clock to the chosen output, or stops sending it.
+		@param	int menu item chosen from the MIDI clock submenu */
+	void setMidiClockOutput(int menuItemID);
+
+	/** Asks for a MOD or XM module, then imports it in place of the current song and samples. Save it with its
+		samples to keep them - they have no files of their own. */
+	void importModule();
+
+	/** Replaces the song, tempo and every slot with those of an opened or imported project.
+		@param	reference to the Contents to apply */
+	void applyProjectContents(ProjectFile::Contents& contents);
+
 	Audio& audio;
 
 	TabbedComponent tabs;
 	TrackerComponent trackerComponent;
 	Viewport fileManagerViewport;
 	FileManagerComponent fileManagerComponent;
+	LoadMeterComponent loadMeter;
+	double sampleLoadProgress;
+	ProgressBar sampleLoadBar	{	sampleLoadProgress	};
+	std::unique_ptr<FileChooser> renderChooser;
+	std::unique_ptr<RenderWindow> renderWindow;
+	std::unique_ptr<FileChooser> projectChooser;
+	std::unique_ptr<MappedFileWarmer> mappedFileWarmer;
+	std::weak_ptr<MemoryMappedFile> projectMapping;
+	File projectFile;
 	//==============================================================================
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainComponent)
 };
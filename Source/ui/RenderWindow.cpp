@@ -0,0 +1,53 @@
+/*
+  ==============================================================================
+	RenderWindow.cpp
+  ==============================================================================
+*/
+
+#include "RenderWindow.h"
+
+RenderWindow::RenderWindow(Audio& audio, const File& file, const OfflineRenderer::Settings& s)
+																	:	ThreadWithProgressWindow("Rendering " + file.getFileName(), true, true),
+																		renderer(audio),
+																		masterFile(file),
+																		settings(s),
+																		result(Result::ok())
+{
+
+}
+
+RenderWindow::~RenderWindow()
+{
+	//make sure the render has stopped before the renderer is deleted
+	renderer.cancel();
+	stopThread(-1);
+}
+
+void RenderWindow::run()
+{
+	result = renderer.render(masterFile, settings, [this] (double progress)
+	{
+		setProgress(progress);
+		//the cancel button asks this thread to exit - pass that on to the renderer's jobs
+		if (threadShouldExit())
+		{
+			renderer.cancel();
+		}
+	});
+}
+
+void RenderWindow::threadComplete(bool userPressedCancel)
+{
+	if (userPressedCancel || result.failed())
+	{
+		AlertWindow::showMessageBoxAsync(AlertWindow::WarningIcon,
+										"Render Failed",
+										userPressedCancel ? "The render was cancelled." : result.getErrorMessage());
+	}
+	else
+	{
+		AlertWindow::showMessageBoxAsync(AlertWindow::InfoIcon,
+										"Render Finished",
+										"The song was rendered to " + masterFile.getFullPathName());
+	}
+}
@@ -0,0 +1,40 @@
+/*
+  ==============================================================================
+	RenderWindow.h
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../audio/OfflineRenderer.h"
+
+/** Runs an OfflineRenderer on a background thread behind a progress bar, and reports how the render went
+	when it finishes. */
+
+class RenderWindow		:	public ThreadWithProgressWindow
+{
+public:
+	/** Constructor. Takes a copy of what the Audio object will play - should only be called from the message thread.
+		@param	reference to the Audio object to render
+		@param	File to write the master mix to
+		@param	OfflineRenderer::Settings to render with */
+	RenderWindow(Audio& audio, const File& file, const OfflineRenderer::Settings& s);
+
+	/** Destructor. */
+	~RenderWindow();
+
+	//ThreadWithProgressWindow
+	/** Overridden function inherited from ThreadWithProgressWindow. Renders the song, passing the renderer's
+		progress on to the progress bar and cancelling the render if the window's cancel button is pressed. */
+	void run() override;
+	/** Overridden function inherited from ThreadWithProgressWindow. Shows where the files were written, or why they were not.
+		@param	bool true if the cancel button was pressed */
+	void threadComplete(bool userPressedCancel) override;
+
+private:
+	OfflineRenderer renderer;
+	File masterFile;
+	OfflineRenderer::Settings settings;
+	Result result;
+};
@@ -14,15 +14,41 @@ FileManagerComponent::FileManagerComponent(Audio& a)		:	audio(a)
 	{
 		//pass each FilePlayerGui its index in the array it is stored in within this object
 		filePlayerGui[i].setIndex(i);
-		//pass each FilePlayerGui the FilePlayer it will control
+		//pass each FilePlayerGui the FilePlayer it will control, and the SampleLoader to load its files through
 		filePlayerGui[i].setFilePlayer(audio.getFilePlayer(i));
+		filePlayerGui[i].setSampleLoader(&audio.getSampleLoader());
 		addAndMakeVisible(filePlayerGui[i]);
 	}
+	audio.getSampleLoader().addListener(this);
 }
 
 FileManagerComponent::~FileManagerComponent()
 {
+	audio.getSampleLoader().removeListener(this);
+}
+
+void FileManagerComponent::updateFromFilePlayers()
+{
+	for (auto& gui : filePlayerGui)
+	{
+		gui.updateFromFilePlayer();
+	}
+}
 
+//SampleLoader::Listener
+void FileManagerComponent::sampleLoadStarted(int slot)
+{
+	filePlayerGui[(size_t) slot].setLoading(true);
+}
+
+void FileManagerComponent::sampleLoadFinished(int slot, const Result& result)
+{
+	filePlayerGui[(size_t) slot].setLoading(false);
+	filePlayerGui[(size_t) slot].updateFromFilePlayer();
+	if (result.failed())
+	{
+		AlertWindow::showMessageBoxAsync(AlertWindow::WarningIcon, "File error", result.getErrorMessage());
+	}
 }
 
 void FileManagerComponent::resized()
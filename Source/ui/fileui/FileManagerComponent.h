@@ -12,7 +12,8 @@
 
 /** This class is a component used to contain, manage and display an array of FilePlayerGui objects. */
 
-class FileManagerComponent		:	public Component
+class FileManagerComponent		:	public Component,
+									private SampleLoader::Listener
 {
 public:
 	/** Constructor.
@@ -22,6 +23,19 @@ public:
 	/** Destructor. */
 	~FileManagerComponent();
 
+	/** Shows the file and looping state every FilePlayer currently holds - called after a project is opened. */
+	void updateFromFilePlayers();
+
+	//SampleLoader::Listener
+	/** Overridden function inherited from SampleLoader::Listener. Marks the slot's FilePlayerGui as loading.
+		@param	int slot the file is loading into */
+	void sampleLoadStarted(int slot) override;
+	/** Overridden function inherited from SampleLoader::Listener. Shows what the slot now holds, and why its file
+		could not be loaded if it could not.
+		@param	int slot the file was loaded into
+		@param	Result of the load */
+	void sampleLoadFinished(int slot, const Result& result) override;
+
 	//Component
 	void resized() override;
 	void paint(Graphics&) override;
@@ -17,12 +17,11 @@ FilePlayerGui::FilePlayerGui()		:	index(0),
 	loopButton.addListener(this);
 	addAndMakeVisible(loopButton);
 
-	AudioFormatManager formatManager;
-	formatManager.registerBasicFormats();
+	SharedResourcePointer<SampleFormatManager> formatManager;
 	fileChooser = std::make_unique<FilenameComponent>("audiofile",
 														File(),
 														true, false, false,
-														formatManager.getWildcardForAllFormats(),
+														formatManager->getWildcardForAllFormats(),
 														String(),
 														"(select an audio file)");
 	fileChooser->addListener(this);
@@ -44,6 +43,11 @@ void FilePlayerGui::setFilePlayer(FilePlayer* fp)
 	filePlayer = fp;
 }
 
+void FilePlayerGui::setSampleLoader(SampleLoader* loader)
+{
+	sampleLoader = loader;
+}
+
 void FilePlayerGui::setIndex(int newIndex)
 {
 	index = newIndex;
@@ -58,6 +62,22 @@ void FilePlayerGui::setIndex(int newIndex)
 	}
 }
 
+void FilePlayerGui::setLoading(bool isLoading)
+{
+	//the index is swapped for a marker until the file can be played
+	indexLabel.setText(isLoading ? String("...") : String(index), dontSendNotification);
+}
+
+void FilePlayerGui::updateFromFilePlayer()
+{
+	if (filePlayer != nullptr)
+	{
+		//the file is only shown - the FilePlayer already holds it, so it must not be loaded again
+		fileChooser->setCurrentFile(filePlayer->getFile(), false, dontSendNotification);
+		loopButton.setToggleState(filePlayer->isLooping(), dontSendNotification);
+	}
+}
+
 //Component
 void FilePlayerGui::resized()
 {
@@ -118,11 +138,11 @@ void FilePlayerGui::filenameComponentChanged(FilenameComponent* fileComponentTha
 	{
 		File audioFile(fileChooser->getCurrentFile().getFullPathName());
 
-		//only set the file if a filePlayer has actually been passed to this object
-		//and if the chosen file actually exists
-		if (filePlayer != nullptr && audioFile.existsAsFile())
+		//only load the file if a sampleLoader has actually been passed to this object
+		//and if the chosen file actually exists - it is decoded in the background
+		if (sampleLoader != nullptr && audioFile.existsAsFile())
 		{
-			filePlayer->loadFile(audioFile);
+			sampleLoader->loadFile(index, audioFile);
 		}
 		else
 		{
@@ -8,6 +8,7 @@
 
 #include <JuceHeader.h>
 #include "../Source/audio/fileaudio/FilePlayer.h"
+#include "../Source/audio/fileaudio/SampleLoader.h"
 
 /** GUI for the FilePlayer class. */
 
@@ -28,11 +29,22 @@ public:
 		@see	FilePlayer */
 	void setFilePlayer(FilePlayer* fp);
 
+	/** Sets the SampleLoader files chosen in this GUI are loaded through, into the slot given by setIndex.
+		@param	pointer to a SampleLoader, expected to outlive this object */
+	void setSampleLoader(SampleLoader* loader);
+
 	/** Passes this object its index in the array it has been created in and sets the Label
 		component text and background colour of the GUI's child components accordingly.
 		@param	int expected to be the index of this object in the array it has been created in */
 	void setIndex(int newIndex);
 
+	/** Shows whether a file is still loading into this GUI's slot.
+		@param	bool true while the file is loading */
+	void setLoading(bool isLoading);
+
+	/** Shows the file and looping state the FilePlayer currently holds - called after a project is opened. */
+	void updateFromFilePlayer();
+
 	//Button::Listener
 	/** Overridden function inherited from Button::Listener. If the play button has been pressed, flips the
 		play state of the FilePlayer object this object controls and provides GUI feedback of this change.
@@ -48,8 +60,8 @@ public:
 	void sliderValueChanged(Slider* slider) override;
 
 	//FilenameComponent::Listener
-	/** Overridden function inherited from FilenameComponent::Listener. Passes the file selected by the user to the FilePlayer
-		object this object controls.
+	/** Overridden function inherited from FilenameComponent::Listener. Passes the file selected by the user to the SampleLoader,
+		to be loaded into the FilePlayer object this object controls.
 		@param pointer to the FilenameComponent that was changed */
 	void filenameComponentChanged(FilenameComponent* fileComponentThatHasChanged) override;
 
@@ -68,4 +80,5 @@ private:
 	Colour colour;
 
 	FilePlayer* filePlayer	{	nullptr	};
+	SampleLoader* sampleLoader	{	nullptr	};
 };
@@ -6,25 +6,32 @@
 
 #include "TrackerCellGui.h"
 
-TrackerCellGui::TrackerCellGui() : eventInfo({"1", "-1", "1"})
+TrackerCellGui::TrackerCellGui()
 {
 	noteTextEditor.setJustification(Justification::centred);
-	noteTextEditor.setTextToShowWhenEmpty("---", getLookAndFeel().findColour(juce::TextEditor::textColourId));
+	noteTextEditor.setTextToShowWhenEmpty(getFieldPlaceholder(NoteField), getLookAndFeel().findColour(juce::TextEditor::textColourId));
 	noteTextEditor.setInputRestrictions(3, "012345678#ABCDEFGabcdefg");
 	noteTextEditor.addListener(this);
 	addAndMakeVisible(noteTextEditor);
 
 	sampleTextEditor.setJustification(Justification::centred);
-	sampleTextEditor.setTextToShowWhenEmpty("--", getLookAndFeel().findColour(juce::TextEditor::textColourId));
+	sampleTextEditor.setTextToShowWhenEmpty(getFieldPlaceholder(SampleField), getLookAndFeel().findColour(juce::TextEditor::textColourId));
 	sampleTextEditor.setInputRestrictions(2, "0123456789");
 	sampleTextEditor.addListener(this);
 	addAndMakeVisible(sampleTextEditor);
 
 	gainTextEditor.setJustification(Justification::centred);
-	gainTextEditor.setTextToShowWhenEmpty("---", getLookAndFeel().findColour(juce::TextEditor::textColourId));
+	gainTextEditor.setTextToShowWhenEmpty(getFieldPlaceholder(GainField), getLookAndFeel().findColour(juce::TextEditor::textColourId));
 	gainTextEditor.setInputRestrictions(3, "0.123456789");
 	gainTextEditor.addListener(this);
 	addAndMakeVisible(gainTextEditor);
+
+	//the effect is its symbol followed by a two digit hex parameter, e.g. A0F
+	effectTextEditor.setJustification(Justification::centred);
+	effectTextEditor.setTextToShowWhenEmpty(getFieldPlaceholder(EffectField), getLookAndFeel().findColour(juce::TextEditor::textColourId));
+	effectTextEditor.setInputRestrictions(3, "0123456789ABCDEFabcdefRrXx");
+	effectTextEditor.addListener(this);
+	addAndMakeVisible(effectTextEditor);
 }
 
 TrackerCellGui::~TrackerCellGui()
@@ -32,9 +39,51 @@ TrackerCellGui::~TrackerCellGui()
 
 }
 
-std::array<String, 3> TrackerCellGui::getEventInfo()
+TrackerEvent TrackerCellGui::getEvent() const
+{
+	return event;
+}
+
+void TrackerCellGui::setEvent(const TrackerEvent& newEvent)
+{
+	event = newEvent;
+
+	noteTextEditor.setText(getFieldText(event, NoteField), false);
+	sampleTextEditor.setText(getFieldText(event, SampleField), false);
+	gainTextEditor.setText(getFieldText(event, GainField), false);
+	effectTextEditor.setText(getFieldText(event, EffectField), false);
+}
+
+Rectangle<int> TrackerCellGui::getFieldBounds(Rectangle<int> cellBounds, Field field)
 {
-	return eventInfo;
+	//each field is a quarter of the cell wide, leaving a gap of 40 pixels on the right of the cell
+	auto r = cellBounds.withTrimmedRight(40);
+	Rectangle<int> fieldBounds;
+	for (int i = 0; i <= field; i++)
+	{
+		fieldBounds = r.removeFromLeft((cellBounds.getWidth() - 40) / NumberOfFields);
+	}
+	return fieldBounds;
+}
+
+String TrackerCellGui::getFieldText(const TrackerEvent& event, Field field)
+{
+	//fields left at their defaults are shown empty, as they were before the user typed in them
+	switch (field)
+	{
+		case NoteField:		return event.note >= 0 ? getMidiNoteName(event.note, true, true, 4) : String();
+		case SampleField:	return event.sample >= 0 ? String(event.sample) : String();
+		case GainField:		return event.gain != 1.f ? String(event.gain) : String();
+		case EffectField:	return event.hasEffect() ? String::charToString(EffectEngine::getEffectSymbol(event.effect))
+														+ String::toHexString(event.effectParameter).paddedLeft('0', 2).toUpperCase()
+													: String();
+		default:			return {};
+	}
+}
+
+String TrackerCellGui::getFieldPlaceholder(Field field)
+{
+	return field == SampleField ? "--" : "---";
 }
 
 int TrackerCellGui::getMidiNoteNumber(String noteOctave)
@@ -97,18 +146,18 @@ void TrackerCellGui::textEditorTextChanged(TextEditor& textEditor)
 		//if noteTextEditor.getText() is a valid MIDI note 
 		if (isMidiNoteValid(textEditor.getText()))
 		{
-			//return the pitch ratio to be used by a ResamplingAudioSource
-			//this assumes all samples are at C4 - hence divide by the frequency of C4
-			//if note noteTextEditor.getText() is C4, pitch ratio will be 1, if C5, pitch ratio will be 2, etc.
-			pitchRatio = getMidiNoteInHertz(getMidiNoteNumber(textEditor.getText())) / 261.626;
-			//set the first element in the array eventInfo to the given pitch ratio
-			eventInfo[0] = String(pitchRatio);
+			event.note = getMidiNoteNumber(textEditor.getText());
+			//set the pitch ratio to be used by a ResamplingAudioSource
+			//this assumes all samples are at C4 - hence the semitones from C4
+			//if note noteTextEditor.getText() is C4, pitch ratio will be exactly 1, if C5, pitch ratio will be 2, etc.
+			event.pitchRatio = std::pow(2.0, (event.note - 60) / 12.0);
 		}
 		//if noteTextEditor.getText() is not a valid MIDI note 
 		else
 		{
-			//set the first element in the array eventInfo to 1 (i.e. just play at C4)
-			eventInfo[0] = String(1);
+			//set the pitch ratio to 1 (i.e. just play at C4)
+			event.note = -1;
+			event.pitchRatio = 1.0;
 		}
 	}
 	if (&textEditor == &sampleTextEditor)
@@ -116,14 +165,14 @@ void TrackerCellGui::textEditorTextChanged(TextEditor& textEditor)
 		//if sampleTextEditor.getText() is a valid sample number
 		if (textEditor.getText().getIntValue() >= 0 && textEditor.getText().getIntValue() <= 31)
 		{
-			//set the second element in the array eventInfo to the given sample number
-			eventInfo[1] = String(textEditor.getText());
+			//set the sample of the event to the given sample number
+			event.sample = textEditor.getText().getIntValue();
 		}
 		else
 		{
-			//set the second element in the array eventInfo to -1:
+			//set the sample of the event to -1:
 			//this should be interpretted by other classes as an invalid sample number
-			eventInfo[1] = String(-1);
+			event.sample = -1;
 		}
 	}
 	if (&textEditor == &gainTextEditor)
@@ -131,25 +180,48 @@ void TrackerCellGui::textEditorTextChanged(TextEditor& textEditor)
 		//if sampleTextEditor.getText() is a valid gain value
 		if (textEditor.getText().getFloatValue() >= 0.f && textEditor.getText().getFloatValue() <= 1.f)
 		{
-			//set the third element in the array eventInfo to the given gain
-			eventInfo[2] = String(textEditor.getText());
+			//set the gain of the event to the given gain
+			event.gain = textEditor.getText().getFloatValue();
+		}
+		else
+		{
+			//set the gain of the event to 0 - this will cause the sample to play silently
+			event.gain = 0.f;
+		}
+	}
+
+	if (&textEditor == &effectTextEditor)
+	{
+		//if effectTextEditor.getText() is an effect symbol followed by a two digit parameter
+		const String text = textEditor.getText();
+		const int effect = text.length() == 3 ? EffectEngine::getEffectForSymbol(text[0]) : (int) TrackerEvent::NoEffect;
+		if (effect != TrackerEvent::NoEffect && text.substring(1).containsOnly("0123456789ABCDEFabcdef"))
+		{
+			event.effect = effect;
+			event.effectParameter = text.substring(1).getHexValue32();
 		}
 		else
 		{
-			//set the third element in the array eventInfo to 0 - this will cause the sample to play silently
-			eventInfo[2] = String(0);
+			//set the event to have no effect until a whole command has been typed
+			event.effect = TrackerEvent::NoEffect;
+			event.effectParameter = 0;
 		}
 	}
+
+	//let the owner of this cell know the event has changed
+	if (onEventChanged != nullptr)
+	{
+		onEventChanged();
+	}
 }
 
 //Component
 void TrackerCellGui::resized()
 {
-	auto r = getLocalBounds();
-	r.removeFromRight(40);
-	noteTextEditor.setBounds(r.removeFromLeft(getWidth() / 3));
-	sampleTextEditor.setBounds(r.removeFromLeft(getWidth() / 3));
-	gainTextEditor.setBounds(r.removeFromLeft(getWidth() / 3));
+	noteTextEditor.setBounds(getFieldBounds(getLocalBounds(), NoteField));
+	sampleTextEditor.setBounds(getFieldBounds(getLocalBounds(), SampleField));
+	gainTextEditor.setBounds(getFieldBounds(getLocalBounds(), GainField));
+	effectTextEditor.setBounds(getFieldBounds(getLocalBounds(), EffectField));
 }
 
 void TrackerCellGui::paint(Graphics& g)
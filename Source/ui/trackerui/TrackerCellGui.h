@@ -7,9 +7,10 @@
 #pragma once
 
 #include <JuceHeader.h>
-#include "../Source/audio/fileaudio/FilePlayer.h"
+#include "../Source/audio/trackeraudio/Pattern.h"
+#include "../Source/audio/trackeraudio/EffectEngine.h"
 
-/** GUI for the FilePlayer class. */
+/** GUI for a single event in the tracker. */
 
 class TrackerCellGui		:	public Component,
 								public TextEditor::Listener,
@@ -22,10 +23,44 @@ public:
 	/** Destructor. */
 	~TrackerCellGui();
 
-	/** Returns the array of Strings representing the user-inputted event info held by this object.
-		@return	std::array of String, size [3]
+	/** Returns the event represented by the user input held by this object.
+		@return	TrackerEvent holding the validated note, sample, gain and effect of this cell
 		@see	textEditorTextChanged */
-	std::array<String, 3> getEventInfo();
+	TrackerEvent getEvent() const;
+
+	/** Shows the given event in this cell, replacing what it held without calling onEventChanged.
+		@param	TrackerEvent to show */
+	void setEvent(const TrackerEvent& newEvent);
+
+	/** Called whenever the user changes the event held by this object. */
+	std::function<void()> onEventChanged;
+
+	/** Holds the fields of a cell, from left to right. */
+	enum Field
+	{
+		NoteField = 0,
+		SampleField,
+		GainField,
+		EffectField,
+		NumberOfFields
+	};
+
+	/** Returns the area a field takes up within a cell, so cells can be painted exactly where they are edited.
+		@param	Rectangle area of the whole cell
+		@param	Field to find the area of
+		@return	Rectangle area of the field */
+	static Rectangle<int> getFieldBounds(Rectangle<int> cellBounds, Field field);
+
+	/** Returns the text a field shows for the given event - empty if the field holds its default.
+		@param	TrackerEvent to show
+		@param	Field to show
+		@return	String to show in the field */
+	static String getFieldText(const TrackerEvent& event, Field field);
+
+	/** Returns the text a field shows while it is empty.
+		@param	Field to show
+		@return	String to show in the field */
+	static String getFieldPlaceholder(Field field);
 
 	/** Returns int MIDI note number for the human-readable note name passed to this method.
 		It is advisable to first check that the note name being passed is valid using isMidiNoteValid.
@@ -41,7 +76,7 @@ public:
 
 	//TextEditor::Listener
 	/** Overridden function inherited from TextEditor::Listener. Performs input validity checks, then
-		sets the elements of eventInfo to the parameters entered by the user in the Tracker interface.
+		sets the fields of event to the parameters entered by the user in the Tracker interface and calls onEventChanged.
 		@param pointer to the TextEditor that was changed */
 	void textEditorTextChanged(TextEditor &textEditor) override;
 
@@ -53,8 +88,8 @@ private:
 	TextEditor noteTextEditor;
 	TextEditor sampleTextEditor;
 	TextEditor gainTextEditor;
+	TextEditor effectTextEditor;
 
-	std::array<String, 3> eventInfo;
+	TrackerEvent event;
 	StringArray noteNames = { "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B" };
-	double pitchRatio;
 };
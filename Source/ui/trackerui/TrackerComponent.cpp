@@ -11,76 +11,121 @@
 TrackerComponent::TrackerComponent(std::array<FilePlayer, Audio::NumberOfFilePlayers>& fpa, Audio& a)
 																											:	filePlayerArray(fpa),
 																												audio(a),
-																												bpm(130),
-																												counter(TrackerComponent::NumberOfRowsPerPattern)
+																												song(new Song()),
+																												shownPattern(0),
+																												bpm(130.0),
+																												ticksPerRow(Sequencer::DefaultTicksPerRow),
+																												swing(Sequencer::StraightSwing),
+																												keyboard(a.getLiveInput().getKeyboardState(), MidiKeyboardComponent::horizontalKeyboard)
 {
-	audio.setTrackerCellGuiArray(trackerCellGuiArray);
-	counter.setListener(this);
 
 	//bpmEditor formatting and setup
 	bpmEditor.addListener(this);
 	addAndMakeVisible(bpmEditor);
 	bpmEditor.setJustification(Justification::centred);
 	bpmEditor.setTextToShowWhenEmpty("130", getLookAndFeel().findColour(juce::TextEditor::textColourId));
-	bpmEditor.setInputRestrictions(3, "0123456789");
+	bpmEditor.setInputRestrictions(7, "0123456789.");
 
 	//playButton setup
 	playButton.addListener(this);
 	addAndMakeVisible(playButton);
 
-	//channelNumberLabels formatting and setup
-	channelNumberLabel1.setJustificationType(Justification::centred);
-	channelNumberLabel1.setText("Channel 1", dontSendNotification);
-	addAndMakeVisible(channelNumberLabel1);
+	//patternSelector chooses the pattern shown in the grid, newPatternButton adds an empty one to the song
+	patternSelector.onChange = [this] { showPattern(patternSelector.getSelectedItemIndex()); };
+	addAndMakeVisible(patternSelector);
+	newPatternButton.addListener(this);
+	addAndMakeVisible(newPatternButton);
 
-	channelNumberLabel2.setJustificationType(Justification::centred);
-	channelNumberLabel2.setText("Channel 2", dontSendNotification);
-	addAndMakeVisible(channelNumberLabel2);
+	//orderEditor holds the order list - the patterns to play, separated by spaces or commas
+	orderLabel.setText("Order", dontSendNotification);
+	orderLabel.setJustificationType(Justification::centredRight);
+	addAndMakeVisible(orderLabel);
+	orderEditor.setTextToShowWhenEmpty("0", getLookAndFeel().findColour(juce::TextEditor::textColourId));
+	orderEditor.setInputRestrictions(0, "0123456789 ,");
+	orderEditor.addListener(this);
+	addAndMakeVisible(orderEditor);
 
-	channelNumberLabel3.setJustificationType(Justification::centred);
-	channelNumberLabel3.setText("Channel 3", dontSendNotification);
-	addAndMakeVisible(channelNumberLabel3);
+	//channelsEditor and rowsEditor set the size of every pattern - they are applied when Return is pressed or they lose
+	//focus, so typing a number does not pass through smaller sizes and lose events on the way
+	channelsLabel.setText("Channels", dontSendNotification);
+	channelsLabel.setJustificationType(Justification::centredRight);
+	addAndMakeVisible(channelsLabel);
+	channelsEditor.setJustification(Justification::centred);
+	channelsEditor.setInputRestrictions(2, "0123456789");
+	channelsEditor.addListener(this);
+	addAndMakeVisible(channelsEditor);
 
-	channelNumberLabel4.setJustificationType(Justification::centred);
-	channelNumberLabel4.setText("Channel 4", dontSendNotification);
-	addAndMakeVisible(channelNumberLabel4);
+	rowsLabel.setText("Rows", dontSendNotification);
+	rowsLabel.setJustificationType(Justification::centredRight);
+	addAndMakeVisible(rowsLabel);
+	rowsEditor.setJustification(Justification::centred);
+	rowsEditor.setInputRestrictions(3, "0123456789");
+	rowsEditor.addListener(this);
+	addAndMakeVisible(rowsEditor);
 
-	//creates an extra, empty box in top left corner to improve formatting
-	addAndMakeVisible(trackerRowLabelCorner);
+	//ticksEditor sets how many ticks each row is split into - the steps the effects of the song move in
+	ticksLabel.setText("Ticks", dontSendNotification);
+	ticksLabel.setJustificationType(Justification::centredRight);
+	addAndMakeVisible(ticksLabel);
+	ticksEditor.setJustification(Justification::centred);
+	ticksEditor.setInputRestrictions(2, "0123456789");
+	ticksEditor.setText(String(ticksPerRow), false);
+	ticksEditor.addListener(this);
+	addAndMakeVisible(ticksEditor);
 
-	//trackerRowLabels and trackerCellGuis formatting and setup in a grid
-	for (int row = 0; row < trackerCellGuiArray.size(); row++)
-	{
-		for (int col = 0; col < trackerCellGuiArray[0].size(); col++)
-		{
-			trackerRowLabelArray[row].setJustificationType(Justification::centred);
-			if (row % 4 == 0)
-			{
-				//trackerRowLabelArray[row].getFont().setBold(true);
-				trackerRowLabelArray[row].setFont(juce::Font(16.0f, juce::Font::bold));
-			}
-			trackerGridComponent.addAndMakeVisible(trackerRowLabelArray[row]);
-			trackerRowLabelArray[row].setText(String(row), dontSendNotification);
-			trackerGridComponent.addAndMakeVisible(trackerCellGuiArray[row][col]);
-		}
-	}
+	//swingEditor sets the share of each pair of rows the first lasts for, in percent - 50 plays them evenly
+	swingLabel.setText("Swing", dontSendNotification);
+	swingLabel.setJustificationType(Justification::centredRight);
+	addAndMakeVisible(swingLabel);
+	swingEditor.setJustification(Justification::centred);
+	swingEditor.setInputRestrictions(2, "0123456789");
+	swingEditor.setText(String(swing), false);
+	swingEditor.addListener(this);
+	addAndMakeVisible(swingEditor);
 
-	trackerGridComponent.setSize(getParentWidth(), (40 * TrackerComponent::NumberOfRowsPerPattern));
+	//the keyboard plays the live slot at the pitch of each key, as MIDI input devices do - recordButton writes the notes
+	//played into the rows they are played in while the song plays
+	addAndMakeVisible(keyboard);
+	liveSlotLabel.setText("Live Slot", dontSendNotification);
+	liveSlotLabel.setJustificationType(Justification::centredRight);
+	addAndMakeVisible(liveSlotLabel);
+	liveSlotEditor.setJustification(Justification::centred);
+	liveSlotEditor.setInputRestrictions(2, "0123456789");
+	liveSlotEditor.setText(String(audio.getLiveInput().getSlot()), false);
+	liveSlotEditor.addListener(this);
+	addAndMakeVisible(liveSlotEditor);
+	recordButton.setClickingTogglesState(true);
+	recordButton.addListener(this);
+	addAndMakeVisible(recordButton);
 
-	trackerViewport.setViewedComponent(&trackerGridComponent);
-	//hides the redundant horizontal scrollbar
+	//stores each edited cell's event in the song and republishes it
+	trackerGridComponent.onEventChanged = [this](int row, int channel, const TrackerEvent& event)
+	{
+		song->setEvent(shownPattern, row, channel, event);
+		publishSong();
+	};
+
+	trackerViewport.setViewedComponent(&trackerGridComponent, false);
+	//the horizontal scrollbar only appears when the channels are too wide to fit
 	trackerViewport.setScrollBarsShown(true,
-										false,
+										true,
 										true,
 										false);
+	trackerViewport.getHorizontalScrollBar().addListener(this);
 	addAndMakeVisible(trackerViewport);
 
+	channelsEditor.setText(String(song->getNumChannels()), false);
+	rowsEditor.setText(String(song->getNumRows()), false);
+	showPattern(shownPattern);
+	updatePatternSelector();
+	publishSong();
+
 	setSize(1280, 720);
 }
 
 TrackerComponent::~TrackerComponent()
 {
-
+	trackerViewport.getHorizontalScrollBar().removeListener(this);
 }
 
 void TrackerComponent::resized()
@@ -88,41 +133,67 @@ void TrackerComponent::resized()
 	//sets play button and bpm box position
 	auto r = getLocalBounds();
 	auto firstRow = r.removeFromTop(40);
-	bpmEditor.setBounds(firstRow.removeFromRight(40));
+	bpmEditor.setBounds(firstRow.removeFromRight(60));
+	patternSelector.setBounds(firstRow.removeFromLeft(140));
+	newPatternButton.setBounds(firstRow.removeFromLeft(100));
+	orderLabel.setBounds(firstRow.removeFromLeft(60));
+	orderEditor.setBounds(firstRow.removeFromLeft(300));
+	channelsLabel.setBounds(firstRow.removeFromLeft(70));
+	channelsEditor.setBounds(firstRow.removeFromLeft(40));
+	rowsLabel.setBounds(firstRow.removeFromLeft(50));
+	rowsEditor.setBounds(firstRow.removeFromLeft(40));
+	ticksLabel.setBounds(firstRow.removeFromLeft(50));
+	ticksEditor.setBounds(firstRow.removeFromLeft(40));
+	swingLabel.setBounds(firstRow.removeFromLeft(55));
+	swingEditor.setBounds(firstRow.removeFromLeft(40));
 	playButton.setBounds(firstRow);
 
-	//sets the channel number labels poisitions
-	auto secondRow = r.removeFromTop(40);
-	trackerRowLabelCorner.setBounds(secondRow.removeFromLeft(40));
-	channelNumberLabel1.setBounds(secondRow.removeFromLeft(getWidth() / 4));
-	channelNumberLabel2.setBounds(secondRow.removeFromLeft(getWidth() / 4));
-	channelNumberLabel3.setBounds(secondRow.removeFromLeft(getWidth() / 4));
-	channelNumberLabel4.setBounds(secondRow);
+	//the live controls sit beside the keyboard along the bottom
+	auto liveRow = r.removeFromBottom(70);
+	auto liveControls = liveRow.removeFromLeft(140);
+	recordButton.setBounds(liveControls.removeFromBottom(35).reduced(4));
+	liveSlotLabel.setBounds(liveControls.removeFromLeft(80));
+	liveSlotEditor.setBounds(liveControls.reduced(4));
+	keyboard.setBounds(liveRow);
+
+	//the channel labels are painted above the grid, moved along with it
+	channelHeaderBounds = r.removeFromTop(TrackerGridComponent::RowHeight).withTrimmedLeft(TrackerGridComponent::RowLabelWidth);
 
 	trackerViewport.setBounds(r);
-	auto trackerBounds = trackerGridComponent.getLocalBounds();
 
-	//sets trackerRowLabels and trackerCellGuis positions in a grid
-	for (int row = 0; row < trackerCellGuiArray.size(); row++)
-	{
-		auto rowBounds = trackerBounds.removeFromTop(40);
-		trackerRowLabelArray[row].setBounds(rowBounds.removeFromLeft(40));
-		for (int col = 0; col < trackerCellGuiArray[0].size(); col++)
-		{
-			trackerCellGuiArray[row][col].setBounds(rowBounds.removeFromLeft(getWidth() / 4));
-		}
-	}
+	//channels share the width of the viewport, down to MinimumChannelWidth - beyond that the grid scrolls sideways
+	const int availableWidth = r.getWidth() - TrackerGridComponent::RowLabelWidth - trackerViewport.getScrollBarThickness();
+	trackerGridComponent.setChannelWidth(jmax((int) TrackerGridComponent::MinimumChannelWidth, availableWidth / song->getNumChannels()));
 }
 
 void TrackerComponent::paint(Graphics& g)
 {
 	g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
+
+	//only the channels scrolled into view are labelled
+	g.reduceClipRegion(channelHeaderBounds);
+	g.setColour(Colours::white);
+	g.setFont(Font(15.0f));
+	const int channelWidth = trackerGridComponent.getChannelWidth();
+	const int scrollPosition = trackerViewport.getViewPositionX();
+	const int firstChannel = scrollPosition / channelWidth;
+	const int lastChannel = jmin(song->getNumChannels() - 1, (scrollPosition + channelHeaderBounds.getWidth()) / channelWidth);
+	for (int channel = firstChannel; channel <= lastChannel; channel++)
+	{
+		g.drawText("Channel " + String(channel + 1),
+					channelHeaderBounds.getX() + channel * channelWidth - scrollPosition,
+					channelHeaderBounds.getY(),
+					channelWidth,
+					channelHeaderBounds.getHeight(),
+					Justification::centred,
+					false);
+	}
 }
 
 bool TrackerComponent::isBpmValid(String bpmString)
 {
-	// if the bpm is 0, it is invalid, otherwise it is valid
-	if (bpmString.getIntValue() == 0)
+	// if the bpm is 0 or more than one decimal point was typed, it is invalid, otherwise it is valid
+	if (bpmString.getDoubleValue() <= 0.0 || bpmString.indexOfChar('.') != bpmString.lastIndexOfChar('.'))
 	{
 		return false;
 	}
@@ -132,27 +203,183 @@ bool TrackerComponent::isBpmValid(String bpmString)
 	}
 }
 
+Song::Ptr TrackerComponent::getSong() const
+{
+	return song;
+}
+
+void TrackerComponent::setSong(Song::Ptr newSong, double newBpm, int newTicksPerRow, int newSwing)
+{
+	song = newSong;
+	bpm = newBpm;
+	audio.setBpm(bpm);
+	//shows up to three decimal places, without trailing zeros
+	bpmEditor.setText(String(bpm, 3).trimCharactersAtEnd("0").trimCharactersAtEnd("."), false);
+	ticksPerRow = newTicksPerRow;
+	audio.setTicksPerRow(ticksPerRow);
+	ticksEditor.setText(String(ticksPerRow), false);
+	swing = newSwing;
+	audio.setGroove(Sequencer::Groove::fromSwing(swing));
+	swingEditor.setText(String(swing), false);
+
+	//the order list is shown as the pattern numbers separated by spaces
+	StringArray order;
+	for (int position = 0; position < song->getOrderLength(); position++)
+	{
+		order.add(String(song->getPatternAtOrder(position)));
+	}
+	orderEditor.setText(order.joinIntoString(" "), false);
+	channelsEditor.setText(String(song->getNumChannels()), false);
+	rowsEditor.setText(String(song->getNumRows()), false);
+
+	shownPattern = 0;
+	updatePatternSelector();
+	showPattern(0);
+	resized();
+	repaint();
+	publishSong();
+}
+
+double TrackerComponent::getBpm() const
+{
+	return bpm;
+}
+
+int TrackerComponent::getTicksPerRow() const
+{
+	return ticksPerRow;
+}
+
+int TrackerComponent::getSwing() const
+{
+	return swing;
+}
+
+void TrackerComponent::publishSong()
+{
+	//the audio thread only ever reads a copy - never the song being edited, and never the grid showing it
+	audio.setSong(new Song(*song));
+}
+
+void TrackerComponent::showPattern(int pattern)
+{
+	if (!isPositiveAndBelow(pattern, song->getNumPatterns()))
+	{
+		return;
+	}
+
+	shownPattern = pattern;
+	trackerGridComponent.setPattern(song, pattern);
+	//the playing row is only highlighted if it belongs to the pattern now shown
+	timerCallback();
+}
+
+void TrackerComponent::updatePatternSelector()
+{
+	patternSelector.clear(dontSendNotification);
+	for (int pattern = 0; pattern < song->getNumPatterns(); pattern++)
+	{
+		patternSelector.addItem("Pattern " + String(pattern), pattern + 1);
+	}
+	patternSelector.setSelectedItemIndex(shownPattern, dontSendNotification);
+}
+
+void TrackerComponent::applyPatternSize()
+{
+	const int numChannels = jlimit(1, (int) Pattern::MaximumNumberOfChannels, channelsEditor.getText().getIntValue());
+	const int numRows = jlimit(1, (int) Pattern::MaximumNumberOfRows, rowsEditor.getText().getIntValue());
+
+	if (numChannels != song->getNumChannels() || numRows != song->getNumRows())
+	{
+		song->setNumChannels(numChannels);
+		song->setNumRows(numRows);
+		showPattern(shownPattern);
+		resized();
+		repaint();
+		publishSong();
+	}
+
+	//puts back the size in use if what was entered was out of range
+	channelsEditor.setText(String(numChannels), false);
+	rowsEditor.setText(String(numRows), false);
+}
+
+void TrackerComponent::writeRecordedNotes()
+{
+	bool songChanged = false;
+	LiveInput::RecordedNote note;
+	while (audio.getLiveInput().takeRecordedNote(note))
+	{
+		//the song may have been resized since the note was played
+		if (!isPositiveAndBelow(note.pattern, song->getNumPatterns()) || !isPositiveAndBelow(note.row, song->getNumRows()))
+		{
+			continue;
+		}
+
+		//notes played together fill the channels to the right of the one being edited
+		const int firstChannel = jmax(0, trackerGridComponent.getEditedChannel());
+		int channel = firstChannel;
+		while (channel < song->getNumChannels() && !song->getEvent(note.pattern, note.row, channel).isEmpty())
+		{
+			channel++;
+		}
+		if (channel >= song->getNumChannels())
+		{
+			channel = jmin(firstChannel, song->getNumChannels() - 1);
+		}
+
+		TrackerEvent event;
+		event.note = note.note;
+		event.sample = note.slot;
+		event.gain = note.gain;
+		event.pitchRatio = std::pow(2.0, (event.note - 60) / 12.0);
+		song->setEvent(note.pattern, note.row, channel, event);
+		trackerGridComponent.eventChanged(note.pattern, note.row, channel);
+		songChanged = true;
+	}
+
+	if (songChanged)
+	{
+		publishSong();
+	}
+}
+
 //Button listener
 void TrackerComponent::buttonClicked(Button* button)
 {
-	//flips the run state of the counter and changes playButton text / trackerRowLabelArray colour accordingly
-	if (button == &playButton)
+	//adds an empty pattern to the end of the song and shows it
+	if (button == &newPatternButton)
 	{
-		if (counter.isRunning())
+		const int pattern = song->addPattern();
+		if (pattern >= 0)
+		{
+			updatePatternSelector();
+			patternSelector.setSelectedItemIndex(pattern, sendNotificationSync);
+			publishSong();
+		}
+	}
+	else if (button == &recordButton)
+	{
+		audio.getLiveInput().setRecording(recordButton.getToggleState());
+	}
+	//flips the run state of the tracker and changes playButton text / the highlighted row accordingly
+	else if (button == &playButton)
+	{
+		if (audio.getRunState())
 		{
 			button->setButtonText(">");
-			counter.setRunState(false, bpm);
 			audio.setRunState(false);
-			for (int row = 0; row < trackerRowLabelArray.size(); row++)
-			{
-				trackerRowLabelArray[row].setColour(juce::Label::textColourId, juce::Colours::white);
-			}
+			stopTimer();
+			//notes recorded in the last frame before stopping are still kept
+			writeRecordedNotes();
+			trackerGridComponent.setPlayingRow(-1);
 		}
 		else
 		{
 			button->setButtonText("||");
-			counter.setRunState(true, bpm);
 			audio.setRunState(true);
+			//polls the audio thread's playhead once a frame while playing
+			startTimerHz(PlayheadFramesPerSecond);
 		}
 	}
 }
@@ -165,32 +392,91 @@ void TrackerComponent::textEditorTextChanged(TextEditor& textEditor)
 	{
 		if (isBpmValid(textEditor.getText()))
 		{
-			bpm = textEditor.getText().getIntValue();
+			bpm = jmin(999.0, textEditor.getText().getDoubleValue());
 			audio.setBpm(bpm);
 		}
 	}
-}
-
-//Counter listener
-void TrackerComponent::counterChanged(int counterValue)
-{
-	//when the counter object broadcasts a change in count, reflect this in the GUI
-
-	//callAsync posts this lambda function from the Counter thread to the message queue to
-	//be completed when possible
-	MessageManager::callAsync([=]()
+	//sets the ticks per row if the number entered is in range
+	else if (&textEditor == &ticksEditor)
 	{
-		//changes the colour of the currently playing row's label to red
-		//and the previously playing row's label back to white
-		if (counterValue == 0)
+		const int ticks = textEditor.getText().getIntValue();
+		if (ticks >= 1 && ticks <= Sequencer::MaximumTicksPerRow)
 		{
-			trackerRowLabelArray[counterValue].setColour(juce::Label::textColourId, juce::Colours::red);
-			trackerRowLabelArray.back().setColour(juce::Label::textColourId, juce::Colours::white);
+			ticksPerRow = ticks;
+			audio.setTicksPerRow(ticksPerRow);
 		}
-		else
+	}
+	//sets the slot played live if the number entered is a slot
+	else if (&textEditor == &liveSlotEditor)
+	{
+		const int slot = textEditor.getText().getIntValue();
+		if (isPositiveAndBelow(slot, (int) Audio::NumberOfFilePlayers))
+		{
+			audio.getLiveInput().setSlot(slot);
+		}
+	}
+	//sets the swing if the percentage entered is in range
+	else if (&textEditor == &swingEditor)
+	{
+		const int percent = textEditor.getText().getIntValue();
+		if (percent >= Sequencer::StraightSwing && percent <= Sequencer::MaximumSwing)
+		{
+			swing = percent;
+			audio.setGroove(Sequencer::Groove::fromSwing(swing));
+		}
+	}
+	//replaces the order list with the pattern numbers entered - numbers that are not a pattern are ignored
+	else if (&textEditor == &orderEditor)
+	{
+		StringArray entries;
+		entries.addTokens(textEditor.getText(), " ,", "");
+		entries.removeEmptyStrings();
+
+		Array<int> order;
+		for (auto& entry : entries)
 		{
-			trackerRowLabelArray[counterValue].setColour(juce::Label::textColourId, juce::Colours::red);
-			trackerRowLabelArray[counterValue - 1].setColour(juce::Label::textColourId, juce::Colours::white);
+			order.add(entry.getIntValue());
 		}
-	});
-}
\ No newline at end of file
+		song->setOrderList(order);
+		publishSong();
+	}
+}
+
+void TrackerComponent::textEditorReturnKeyPressed(TextEditor& textEditor)
+{
+	if (&textEditor == &channelsEditor || &textEditor == &rowsEditor)
+	{
+		applyPatternSize();
+	}
+}
+
+void TrackerComponent::textEditorFocusLost(TextEditor& textEditor)
+{
+	if (&textEditor == &channelsEditor || &textEditor == &rowsEditor)
+	{
+		applyPatternSize();
+	}
+}
+
+//ScrollBar listener
+void TrackerComponent::scrollBarMoved(ScrollBar* scrollBar, double newRangeStart)
+{
+	repaint(channelHeaderBounds);
+}
+
+//Timer
+void TrackerComponent::timerCallback()
+{
+	writeRecordedNotes();
+
+	//nothing is drawn while another tab is shown - the playhead is picked up again on the first frame back
+	if (!isShowing())
+	{
+		return;
+	}
+
+	//the audio thread publishes the row it has just triggered - the grid only repaints the previously highlighted
+	//row and the new row, however many rows have passed since the last frame
+	const auto playhead = audio.getPlayhead();
+	trackerGridComponent.setPlayingRow(playhead.pattern == shownPattern ? playhead.row : -1);
+}
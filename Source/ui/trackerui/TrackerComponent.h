@@ -8,15 +8,17 @@
 
 #include <JuceHeader.h>
 #include "../Source/audio/Audio.h"
-#include "../Source/audio/Counter.h"
-#include "TrackerCellGui.h"
+#include "TrackerGridComponent.h"
 
-/** This class is a component used to contain, manage and display an array of TrackerCellGui objects. */
+/** This class is a component used to edit and play the song - it holds the song being edited, shows one of its
+	patterns in a scrolling TrackerGridComponent and holds the controls for playback and the song's layout, along with
+	a keyboard to play samples live and record them into the song. */
 
 class TrackerComponent		:	public Component,
 								public Button::Listener,
 								public TextEditor::Listener,
-								public Counter::Listener
+								private ScrollBar::Listener,
+								private Timer
 {
 public:
 	/** Constructor.
@@ -27,10 +29,10 @@ public:
 	/** Destructor. */
 	~TrackerComponent();
 
-	/** Holds number of rows of TrackerCellGui objects to be shown in tracker. */
+	/** Holds the rate the playhead is redrawn at while playing, in frames per second. */
 	enum
 	{
-		NumberOfRowsPerPattern = 64
+		PlayheadFramesPerSecond = 60
 	};
 
 	/** Returns true if the bpm value passed to this method is a valid bpm.
@@ -38,48 +40,113 @@ public:
 		@return	bool validity of the bpm String bpmString */
 	bool isBpmValid(String bpmString);
 
+	/** Returns the song being edited. Should not be modified - pass a new song to setSong instead. */
+	Song::Ptr getSong() const;
+
+	/** Replaces the song being edited and the tempo, showing the song's first pattern and passing a copy to the Audio object.
+		@param	Song::Ptr to the new song
+		@param	double new tempo in beats per minute
+		@param	int number of ticks each row is split into for the song's effects
+		@param	int share of each pair of rows the first lasts for, in percent - see Sequencer::Groove::fromSwing */
+	void setSong(Song::Ptr newSong, double newBpm, int newTicksPerRow, int newSwing);
+
+	/** Returns the tempo in beats per minute. */
+	double getBpm() const;
+
+	/** Returns the number of ticks each row is split into. */
+	int getTicksPerRow() const;
+
+	/** Returns the share of each pair of rows the first lasts for, in percent. */
+	int getSwing() const;
+
+	/** Passes a copy of the song being edited to the Audio object. Called whenever the user edits a cell,
+		adds a pattern or changes the order list. */
+	void publishSong();
+
+	/** Shows the given pattern of the song in the grid, so it can be edited.
+		@param	int pattern in the range of the song's patterns */
+	void showPattern(int pattern);
+
 	//Button::Listener
 	/** Overridden function inherited from Button::Listener. Flips the
-		play state of the Counter and Audio objects and provides GUI feedback of this change.
+		play state of the Audio object and provides GUI feedback of this change, or turns recording on or off.
 		@param pointer to the Button that was clicked */
 	void buttonClicked(Button* button) override;
 
 	//TextEditor::Listener
 	/** Overridden function inherited from TextEditor::Listener. Performs input validity checks, then
-		sets the bpm variable in this object and in the Audio object to value entered by the user in the TextEditor.
+		sets the bpm, ticks per row, swing or live slot in this object and in the Audio object to value entered by the user in the TextEditor.
 		@param pointer to the TextEditor that was changed */
 	void textEditorTextChanged(TextEditor& textEditor) override;
 
-	//Counter::Listener
-	/** Overridden function inherited from Counter::Listener. Passes this object the current counter value when
-		the count has changed.
-		@param current counter value */
-	void counterChanged(int counterValue) override;
+	/** Overridden function inherited from TextEditor::Listener. Applies the number of channels or rows entered.
+		@param pointer to the TextEditor that Return was pressed in */
+	void textEditorReturnKeyPressed(TextEditor& textEditor) override;
+
+	/** Overridden function inherited from TextEditor::Listener. Applies the number of channels or rows entered.
+		@param pointer to the TextEditor that lost focus */
+	void textEditorFocusLost(TextEditor& textEditor) override;
 
 	//Comoponent
 	void resized() override;
 	void paint(Graphics&) override;
 
 private:
+	/** Refills the pattern selector with one item for each pattern of the song. */
+	void updatePatternSelector();
+
+	/** Sets the number of channels and rows of the song to the values in channelsEditor and rowsEditor,
+		resizing the grid and republishing the song if either has changed. */
+	void applyPatternSize();
+
+	/** Writes the notes recorded by the audio thread into the song, each in the rows it was played in. A note goes
+		into the channel being edited, or the first channel after it that is empty in that row, and republishes the
+		song if any were written. */
+	void writeRecordedNotes();
+
+	//ScrollBar::Listener
+	/** Overridden function inherited from ScrollBar::Listener. Repaints the channel labels to move them along with the grid.
+		@param	pointer to the ScrollBar that moved
+		@param	double new position of the ScrollBar */
+	void scrollBarMoved(ScrollBar* scrollBar, double newRangeStart) override;
+
+	//Timer
+	/** Overridden function inherited from Timer. Reads the row currently playing from the Audio object once a frame and
+		highlights it if it belongs to the pattern being shown, so the display follows the audio clock rather than a clock of its own.
+		The work done each frame is the same at any tempo - rows that started and ended between frames are never drawn.
+		Any notes recorded since the last frame are written into the song first. */
+	void timerCallback() override;
+
 	std::array<FilePlayer, Audio::NumberOfFilePlayers>& filePlayerArray;
-	std::array<std::array<TrackerCellGui, 4>, 64> trackerCellGuiArray;
 	Audio& audio;
+	Song::Ptr song;
+	int shownPattern;
 
+	TrackerGridComponent trackerGridComponent;
 	Viewport trackerViewport;
-	Component trackerGridComponent;
-
-	std::array<Label, NumberOfRowsPerPattern> trackerRowLabelArray;
-	std::array<std::array<Rectangle<int>, 4>, TrackerComponent::NumberOfRowsPerPattern> seperatorArray;
+	Rectangle<int> channelHeaderBounds;
 
 	TextButton playButton		{	">"		};
 	TextEditor bpmEditor;
-	int bpm;
-
-	Label channelNumberLabel1;
-	Label channelNumberLabel2;
-	Label channelNumberLabel3;
-	Label channelNumberLabel4;
-	Label trackerRowLabelCorner;
-
-	Counter counter;
+	double bpm;
+
+	ComboBox patternSelector;
+	TextButton newPatternButton		{	"New Pattern"	};
+	Label orderLabel;
+	TextEditor orderEditor;
+	Label channelsLabel;
+	TextEditor channelsEditor;
+	Label rowsLabel;
+	TextEditor rowsEditor;
+	Label ticksLabel;
+	TextEditor ticksEditor;
+	int ticksPerRow;
+	Label swingLabel;
+	TextEditor swingEditor;
+	int swing;
+
+	MidiKeyboardComponent keyboard;
+	Label liveSlotLabel;
+	TextEditor liveSlotEditor;
+	TextButton recordButton		{	"Rec"	};
 };
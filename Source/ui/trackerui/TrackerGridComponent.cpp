@@ -0,0 +1,217 @@
+/*
+  ==============================================================================
+	TrackerGridComponent.cpp
+  ==============================================================================
+*/
+
+#include "TrackerGridComponent.h"
+
+TrackerGridComponent::TrackerGridComponent()		:	shownPattern(0),
+														channelWidth(MinimumChannelWidth),
+														playingRow(-1),
+														editedRow(-1),
+														editedChannel(-1)
+{
+	//the editor stays hidden until a cell is clicked
+	cellEditor.onEventChanged = [this]
+	{
+		if (onEventChanged != nullptr)
+		{
+			onEventChanged(editedRow, editedChannel, cellEditor.getEvent());
+		}
+	};
+	addChildComponent(cellEditor);
+
+	setOpaque(true);
+}
+
+TrackerGridComponent::~TrackerGridComponent()
+{
+
+}
+
+void TrackerGridComponent::setPattern(Song::Ptr songToShow, int pattern)
+{
+	song = songToShow;
+	shownPattern = pattern;
+	setChannelWidth(channelWidth);
+
+	//the editor moves back onto its cell, now showing what it holds in this pattern - or is hidden if the cell has gone
+	showEditor(editedRow, editedChannel);
+	repaint();
+}
+
+void TrackerGridComponent::setChannelWidth(int width)
+{
+	channelWidth = width;
+	if (song != nullptr)
+	{
+		setSize(RowLabelWidth + channelWidth * song->getNumChannels(), RowHeight * song->getNumRows());
+	}
+	cellEditor.setBounds(getCellBounds(editedRow, editedChannel));
+}
+
+int TrackerGridComponent::getChannelWidth() const noexcept
+{
+	return channelWidth;
+}
+
+void TrackerGridComponent::eventChanged(int pattern, int row, int channel)
+{
+	if (song == nullptr || pattern != shownPattern)
+	{
+		return;
+	}
+
+	repaint(getCellBounds(row, channel));
+	if (row == editedRow && channel == editedChannel)
+	{
+		cellEditor.setEvent(song->getEvent(shownPattern, row, channel));
+	}
+}
+
+int TrackerGridComponent::getEditedChannel() const noexcept
+{
+	return editedChannel;
+}
+
+void TrackerGridComponent::setPlayingRow(int row)
+{
+	if (row == playingRow)
+	{
+		return;
+	}
+
+	//only the previously highlighted row and the new row need repainting - the viewport clips both to what is visible,
+	//and repaints made before the next frame are drawn together
+	if (playingRow >= 0)
+	{
+		repaint(0, playingRow * RowHeight, getWidth(), RowHeight);
+	}
+	if (row >= 0)
+	{
+		repaint(0, row * RowHeight, getWidth(), RowHeight);
+	}
+	playingRow = row;
+}
+
+void TrackerGridComponent::paint(Graphics& g)
+{
+	g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
+	if (song == nullptr || !isPositiveAndBelow(shownPattern, song->getNumPatterns()))
+	{
+		return;
+	}
+
+	//only the rows and channels inside the area being redrawn are painted
+	const auto clip = g.getClipBounds();
+	const int numChannels = song->getNumChannels();
+	const int firstRow = jmax(0, clip.getY() / RowHeight);
+	const int lastRow = jmin(song->getNumRows() - 1, (clip.getBottom() - 1) / RowHeight);
+	const int firstChannel = jmax(0, (clip.getX() - RowLabelWidth) / channelWidth);
+	const int lastChannel = jmin(numChannels - 1, (clip.getRight() - 1 - RowLabelWidth) / channelWidth);
+
+	const Pattern pattern = song->getPattern(shownPattern);
+	for (int row = firstRow; row <= lastRow; row++)
+	{
+		//row labels are bold every beat, and red while their row is playing
+		if (clip.getX() < RowLabelWidth)
+		{
+			g.setFont(row % 4 == 0 ? Font(16.0f, Font::bold) : Font(15.0f));
+			g.setColour(row == playingRow ? Colours::red : Colours::white);
+			g.drawText(String(row), 0, row * RowHeight, RowLabelWidth, RowHeight, Justification::centred, false);
+		}
+
+		//every visible cell is painted empty, then the events the row holds are painted over them
+		for (int channel = firstChannel; channel <= lastChannel; channel++)
+		{
+			paintCell(g, getCellBounds(row, channel), nullptr);
+		}
+		for (auto& channelEvent : pattern.getRow(row))
+		{
+			if (channelEvent.channel >= firstChannel && channelEvent.channel <= lastChannel)
+			{
+				paintCell(g, getCellBounds(row, channelEvent.channel), &channelEvent.event);
+			}
+		}
+
+		//the playing row is tinted across its whole width
+		if (row == playingRow)
+		{
+			g.setColour(Colours::red.withAlpha(0.15f));
+			g.fillRect(Rectangle<int>(0, row * RowHeight, getWidth(), RowHeight).getIntersection(clip));
+		}
+	}
+}
+
+void TrackerGridComponent::mouseDown(const MouseEvent& event)
+{
+	if (event.x < RowLabelWidth)
+	{
+		return;
+	}
+	showEditor(event.y / RowHeight, (event.x - RowLabelWidth) / channelWidth);
+	if (cellEditor.isVisible())
+	{
+		cellEditor.grabKeyboardFocus();
+	}
+}
+
+void TrackerGridComponent::showEditor(int row, int channel)
+{
+	//the cell the editor leaves is painted with whatever was entered in it
+	repaint(getCellBounds(editedRow, editedChannel));
+
+	if (song == nullptr || !isPositiveAndBelow(row, song->getNumRows()) || !isPositiveAndBelow(channel, song->getNumChannels()))
+	{
+		editedRow = -1;
+		editedChannel = -1;
+		cellEditor.setVisible(false);
+		return;
+	}
+
+	editedRow = row;
+	editedChannel = channel;
+	cellEditor.setEvent(song->getEvent(shownPattern, row, channel));
+	cellEditor.setBounds(getCellBounds(row, channel));
+	cellEditor.setVisible(true);
+}
+
+Rectangle<int> TrackerGridComponent::getCellBounds(int row, int channel) const noexcept
+{
+	if (row < 0 || channel < 0)
+	{
+		return {};
+	}
+	return { RowLabelWidth + channel * channelWidth, row * RowHeight, channelWidth, RowHeight };
+}
+
+void TrackerGridComponent::paintCell(Graphics& g, Rectangle<int> bounds, const TrackerEvent* event) const
+{
+	auto& lookAndFeel = getLookAndFeel();
+	g.setFont(Font(15.0f));
+
+	//fields are drawn to look like the editor's TextEditors, so the editor can be moved between cells seamlessly
+	for (int i = 0; i < TrackerCellGui::NumberOfFields; i++)
+	{
+		const auto field = (TrackerCellGui::Field) i;
+		const auto fieldBounds = TrackerCellGui::getFieldBounds(bounds, field);
+		const String text = event != nullptr ? TrackerCellGui::getFieldText(*event, field) : String();
+
+		g.setColour(lookAndFeel.findColour(TextEditor::backgroundColourId));
+		g.fillRect(fieldBounds);
+		g.setColour(lookAndFeel.findColour(TextEditor::outlineColourId));
+		g.drawRect(fieldBounds);
+
+		if (text.isEmpty())
+		{
+			g.setColour(lookAndFeel.findColour(TextEditor::textColourId).withMultipliedAlpha(0.5f));
+			g.drawText(TrackerCellGui::getFieldPlaceholder(field), fieldBounds, Justification::centred, false);
+		}
+		else
+		{
+			g.setColour(lookAndFeel.findColour(TextEditor::textColourId));
+			g.drawText(text, fieldBounds, Justification::centred, false);
+		}
+	}
+}
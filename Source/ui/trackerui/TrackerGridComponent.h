@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+	TrackerGridComponent.h
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../Source/audio/trackeraudio/Song.h"
+#include "TrackerCellGui.h"
+
+/** Shows one pattern of a song as a grid of rows and channels. Only the rows and channels inside the area being
+	redrawn are painted, straight from the song's events, so the cost of the grid follows what is on screen rather
+	than the size of the pattern. A single TrackerCellGui floats over the cell that was last clicked to edit it. */
+
+class TrackerGridComponent		:	public Component
+{
+public:
+	/** Constructor. */
+	TrackerGridComponent();
+
+	/** Destructor. */
+	~TrackerGridComponent();
+
+	/** Holds the size of each row of the grid, and the narrowest a channel is shown. */
+	enum
+	{
+		RowHeight = 40,
+		RowLabelWidth = 40,
+		MinimumChannelWidth = 190
+	};
+
+	/** Sets the song to show and the pattern of it to show, then resizes the grid to fit. The song is read
+		whenever the grid is painted, so call this again or repaint after editing it.
+		@param	Song::Ptr to the song being edited
+		@param	int pattern in the range of the song's patterns */
+	void setPattern(Song::Ptr songToShow, int pattern);
+
+	/** Sets the width of each channel and resizes the grid to fit.
+		@param	int width of each channel in pixels */
+	void setChannelWidth(int width);
+
+	/** Returns the width of each channel in pixels. */
+	int getChannelWidth() const noexcept;
+
+	/** Repaints a cell whose event has been changed outside the grid, if its pattern is shown. The editor is only
+		refilled if it is over that cell, so anything being typed into another cell is kept.
+		@param	int pattern of the cell
+		@param	int row of the cell
+		@param	int channel of the cell */
+	void eventChanged(int pattern, int row, int channel);
+
+	/** Returns the channel of the cell being edited, or -1 if no cell is. */
+	int getEditedChannel() const noexcept;
+
+	/** Highlights the given row, repainting only the rows whose highlight has changed - and of those, only the part
+		scrolled into view. However many rows have passed since the last call, at most two rows are repainted.
+		@param	int row to highlight, or -1 to highlight none */
+	void setPlayingRow(int row);
+
+	/** Called when the user edits the cell under the editor, with the cell's row, channel and new event. */
+	std::function<void(int, int, const TrackerEvent&)> onEventChanged;
+
+	//Component
+	void paint(Graphics&) override;
+	void mouseDown(const MouseEvent& event) override;
+
+private:
+	/** Moves the editor onto the given cell and fills it with the cell's event, or hides it if the cell is not in the grid.
+		@param	int row of the cell
+		@param	int channel of the cell */
+	void showEditor(int row, int channel);
+
+	/** Returns the area of the given cell.
+		@param	int row of the cell
+		@param	int channel of the cell */
+	Rectangle<int> getCellBounds(int row, int channel) const noexcept;
+
+	/** Paints the event held in a cell, or the empty field placeholders if it holds none.
+		@param	Graphics context to paint with
+		@param	Rectangle area of the cell
+		@param	pointer to the event to paint, or nullptr for an empty cell */
+	void paintCell(Graphics& g, Rectangle<int> bounds, const TrackerEvent* event) const;
+
+	Song::Ptr song;
+	int shownPattern;
+	int channelWidth;
+	int playingRow;
+
+	TrackerCellGui cellEditor;
+	int editedRow;
+	int editedChannel;
+};